@@ -0,0 +1,236 @@
+#include "corpus.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define BYTE_ORDER_MARK 0x01020304u
+#define PAGE 4096
+
+static uint64_t alignUp(uint64_t x, uint64_t a) {
+    return (x + a - 1) & ~(a - 1);
+}
+
+// Section positions follow from the parameters alone; the blob size
+// needs the lengths, which the writer knows and the reader checks.
+static void layout(struct CorpusHeader *h) {
+    uint64_t count = h->params.count;
+    h->offsetsAt = alignUp(sizeof(*h), 64);
+    h->lengthsAt = alignUp(h->offsetsAt + count * sizeof(uint64_t), 64);
+    h->blobAt = alignUp(h->lengthsAt + count * sizeof(uint32_t), PAGE);
+    h->fileSize = h->blobAt + h->blobSize;
+}
+
+static int sameParams(const struct CorpusParams *a, const struct CorpusParams *b) {
+    return a->seed == b->seed && a->dist == b->dist && a->minLen == b->minLen &&
+           a->maxLen == b->maxLen && a->align == b->align && a->count == b->count;
+}
+
+// === Generation ===
+// xorshift64: the seed alone fixes the content on every platform, unlike
+// rand().
+static uint64_t nextRand(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static uint32_t lengthOf(const struct CorpusParams *p, uint64_t *state) {
+    uint32_t span = p->maxLen - p->minLen + 1;
+    return p->minLen + (span > 1 ? (uint32_t)(nextRand(state) % span) : 0);
+}
+
+static void fillString(char *s, uint32_t len, uint64_t *state) {
+    for (uint32_t i = 0; i < len; ++i) {
+        uint64_t r = nextRand(state);
+        s[i] = (char)((r & 1 ? 'A' : 'a') + (r >> 1) % 26);
+    }
+    s[len] = '\0';
+}
+
+#ifndef _WIN32
+static int writeAt(FILE *f, uint64_t pos, const void *data, size_t size) {
+    return fseeko(f, (off_t)pos, SEEK_SET) == 0 && fwrite(data, 1, size, f) == size;
+}
+
+int corpusWrite(const char *path, const struct CorpusParams *params) {
+    const struct CorpusParams *p = params;
+    if (p->dist != CORPUS_MIXED_CASE || p->minLen > p->maxLen ||
+        p->align == 0 || (p->align & (p->align - 1)) != 0 ||
+        p->count > SIZE_MAX / sizeof(uint64_t) - 1) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct CorpusHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, CORPUS_MAGIC, sizeof(h.magic));
+    h.version = CORPUS_VERSION;
+    h.byteOrder = BYTE_ORDER_MARK;
+    h.params = *p;
+
+    // First pass: lengths only, for the offsets and the blob size.
+    uint64_t *offsets = malloc(p->count * sizeof(uint64_t) + 1);
+    uint32_t *lengths = malloc(p->count * sizeof(uint32_t) + 1);
+    char *buf = malloc((size_t)p->maxLen + p->align + 1);
+    if (!offsets || !lengths || !buf) {
+        free(offsets);
+        free(lengths);
+        free(buf);
+        errno = ENOMEM;
+        return -1;
+    }
+    uint64_t state = p->seed ? p->seed : 1, pos = 0;
+    for (uint64_t i = 0; i < p->count; ++i) {
+        lengths[i] = lengthOf(p, &state);
+        for (uint32_t k = 0; k < lengths[i]; ++k) nextRand(&state);
+        offsets[i] = pos;
+        pos = alignUp(pos + lengths[i] + 1, p->align);
+    }
+    h.blobSize = pos;
+    layout(&h);
+
+    char tmp[4096];
+    snprintf(tmp, sizeof(tmp), "%s.tmp.%ld", path, (long)getpid());
+    FILE *f = fopen(tmp, "wb");
+    int ok = f != NULL;
+    ok = ok && writeAt(f, 0, &h, sizeof(h));
+    ok = ok && writeAt(f, h.offsetsAt, offsets, p->count * sizeof(uint64_t));
+    ok = ok && writeAt(f, h.lengthsAt, lengths, p->count * sizeof(uint32_t));
+
+    // Second pass: the text, replaying the same generator. Padding
+    // between strings is zero.
+    state = p->seed ? p->seed : 1;
+    ok = ok && fseeko(f, (off_t)h.blobAt, SEEK_SET) == 0;
+    for (uint64_t i = 0; ok && i < p->count; ++i) {
+        uint32_t len = lengthOf(p, &state);
+        uint64_t next = i + 1 < p->count ? offsets[i + 1] : h.blobSize;
+        memset(buf, 0, (size_t)(next - offsets[i]));
+        fillString(buf, len, &state);
+        ok = fwrite(buf, 1, (size_t)(next - offsets[i]), f) == next - offsets[i];
+    }
+    int saved = errno;
+    if (f && fclose(f) != 0) ok = 0;
+    free(offsets);
+    free(lengths);
+    free(buf);
+    if (ok && rename(tmp, path) == 0) return 0;
+    saved = errno ? errno : saved;
+    remove(tmp);
+    errno = saved;
+    return -1;
+}
+
+// === Mapping ===
+// Every record must lie inside the blob with room for its NUL, and the
+// blob must end in a NUL, so that neither the length-taking kernels nor
+// the NUL-terminated ones can leave the mapping, whatever the file holds.
+// Only the index sections and the blob's last byte are read.
+static int recordsOk(const struct CorpusHeader *h, const uint64_t *offsets, const uint32_t *lengths,
+                     const char *blob) {
+    uint64_t blobSize = h->blobSize;
+    if (h->params.count && (blobSize == 0 || blob[blobSize - 1] != '\0')) return 0;
+    for (uint64_t i = 0; i < h->params.count; ++i)
+        if (offsets[i] >= blobSize || lengths[i] >= blobSize - offsets[i] ||
+            lengths[i] < h->params.minLen || lengths[i] > h->params.maxLen)
+            return 0;
+    return 1;
+}
+
+int corpusOpen(struct Corpus *c, const char *path) {
+    memset(c, 0, sizeof(*c));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(struct CorpusHeader)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    // count and blobSize are bounded by the file size first, so that
+    // layout cannot overflow.
+    const struct CorpusHeader *h = map;
+    struct CorpusHeader expect = *h;
+    uint64_t fileSize = (uint64_t)st.st_size;
+    int ok = memcmp(h->magic, CORPUS_MAGIC, sizeof(h->magic)) == 0 && h->version == CORPUS_VERSION &&
+             h->byteOrder == BYTE_ORDER_MARK && h->fileSize == fileSize &&
+             h->params.count <= fileSize / (sizeof(uint64_t) + sizeof(uint32_t)) &&
+             h->blobSize <= fileSize;
+    if (ok) {
+        layout(&expect);
+        ok = expect.offsetsAt == h->offsetsAt && expect.lengthsAt == h->lengthsAt &&
+             expect.blobAt == h->blobAt && expect.fileSize == fileSize;
+    }
+    ok = ok && recordsOk(h, (const uint64_t *)((const char *)map + h->offsetsAt),
+                         (const uint32_t *)((const char *)map + h->lengthsAt),
+                         (const char *)map + h->blobAt);
+    if (!ok) {
+        munmap(map, (size_t)st.st_size);
+        errno = EINVAL;
+        return -1;
+    }
+    c->map = map;
+    c->mapSize = (size_t)st.st_size;
+    c->header = h;
+    c->offsets = (const uint64_t *)((const char *)map + h->offsetsAt);
+    c->lengths = (const uint32_t *)((const char *)map + h->lengthsAt);
+    c->blob = (char *)map + h->blobAt;
+    return 0;
+}
+
+int corpusReset(struct Corpus *c) {
+    return madvise(c->blob, (size_t)c->header->blobSize, MADV_DONTNEED);
+}
+
+void corpusClose(struct Corpus *c) {
+    if (c->map) munmap(c->map, c->mapSize);
+    memset(c, 0, sizeof(*c));
+}
+#else
+int corpusWrite(const char *path, const struct CorpusParams *params) {
+    (void)path; (void)params;
+    errno = ENOSYS;
+    return -1;
+}
+
+int corpusOpen(struct Corpus *c, const char *path) {
+    (void)path;
+    memset(c, 0, sizeof(*c));
+    errno = ENOSYS;
+    return -1;
+}
+
+int corpusReset(struct Corpus *c) {
+    (void)c;
+    return -1;
+}
+
+void corpusClose(struct Corpus *c) {
+    memset(c, 0, sizeof(*c));
+}
+#endif
+
+int corpusOpenOrCreate(struct Corpus *c, const char *path, const struct CorpusParams *params,
+                       int *generated) {
+    if (generated) *generated = 0;
+    if (corpusOpen(c, path) == 0) {
+        if (sameParams(&c->header->params, params)) return 0;
+        corpusClose(c);
+    }
+    if (corpusWrite(path, params) != 0) return -1;
+    if (generated) *generated = 1;
+    return corpusOpen(c, path);
+}
@@ -0,0 +1,87 @@
+#ifndef BENCH_CORPUS_H
+#define BENCH_CORPUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary corpus files: generate a benchmark corpus once, then map it on
+// every run instead of calling randStr per string. Opening reads only
+// the header and the offsets and lengths, 12 bytes per string, to check
+// every record against the file; the text itself is not read until the
+// kernels touch it.
+//
+// Layout (native little-endian, every section 64-byte aligned, the blob
+// page-aligned):
+//
+//   struct CorpusHeader
+//   uint64_t offsets[count]     file offset of string i within the blob
+//   uint32_t lengths[count]     its length; a NUL follows it
+//   char     blob[blobSize]     strings, each starting on `align` bytes
+//
+// The mapping is MAP_PRIVATE, so the in-place kernels write to private
+// copy-on-write pages; the file never changes, and corpusReset throws
+// the written pages away to get the generated content back.
+
+#define CORPUS_MAGIC   "BLCORPUS"
+#define CORPUS_VERSION 1
+
+// Distributions of the generated text.
+enum {
+    CORPUS_MIXED_CASE = 1    // randStr: each letter upper or lower with p = 1/2
+};
+
+struct CorpusParams {
+    uint64_t seed;
+    uint32_t dist;
+    uint32_t minLen, maxLen; // string lengths, uniform in [minLen, maxLen]
+    uint32_t align;          // string start alignment, a power of two
+    uint64_t count;
+};
+
+struct CorpusHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;      // 0x01020304 as written
+    struct CorpusParams params;
+    uint64_t offsetsAt, lengthsAt, blobAt, blobSize, fileSize;
+};
+
+struct Corpus {
+    void *map;
+    size_t mapSize;
+    const struct CorpusHeader *header;
+    const uint64_t *offsets;
+    const uint32_t *lengths;
+    char *blob;
+};
+
+// Generates the corpus described by `params` into `path` (through a
+// temporary file and a rename, so readers never see half of it).
+// Returns 0, or -1 with errno set.
+int corpusWrite(const char *path, const struct CorpusParams *params);
+
+// Maps `path` copy-on-write. Returns 0, or -1 when the file is missing,
+// truncated, not a corpus of this version and byte order, or has a
+// record that does not fit in the blob.
+int corpusOpen(struct Corpus *c, const char *path);
+
+// Opens `path` if it holds exactly `params`, otherwise regenerates it
+// first. *generated (if not NULL) says which happened.
+int corpusOpenOrCreate(struct Corpus *c, const char *path, const struct CorpusParams *params,
+                       int *generated);
+
+// Drops every page written since the mapping was made (or last reset),
+// so the next access sees the file content again.
+int corpusReset(struct Corpus *c);
+
+void corpusClose(struct Corpus *c);
+
+static inline char *corpusString(const struct Corpus *c, size_t i) {
+    return c->blob + c->offsets[i];
+}
+
+static inline size_t corpusLength(const struct Corpus *c, size_t i) {
+    return c->lengths[i];
+}
+
+#endif // BENCH_CORPUS_H
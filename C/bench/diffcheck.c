@@ -0,0 +1,383 @@
+#include "diffcheck.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "branchless.h"
+
+#define CANARY      0xA5
+#define CANARY_SIZE 16
+#define MAX_KERNELS 48
+
+// === Kernel table ===
+enum { K_MAP, K_FLAGS, K_FUSED, K_NUL };
+enum { R_UPPER, R_LOWER, R_UTF8 };
+
+struct Kernel {
+    const char *name;
+    int kind, ref;
+    upper_func_t map;
+    int (*flags)(const char *, size_t);
+    int (*fused)(char *, size_t);
+    void (*nul)(char *);
+};
+
+static struct Kernel kernels[MAX_KERNELS];
+static int numKernels;
+
+static void addMap(const char *name, int cpu, int ref, upper_func_t f) {
+    if (numKernels < MAX_KERNELS && cpuSupports(cpu))
+        kernels[numKernels++] = (struct Kernel){name, K_MAP, ref, f, NULL, NULL, NULL};
+}
+
+static void addFlags(const char *name, int cpu, int (*f)(const char *, size_t)) {
+    if (numKernels < MAX_KERNELS && cpuSupports(cpu))
+        kernels[numKernels++] = (struct Kernel){name, K_FLAGS, R_UPPER, NULL, f, NULL, NULL};
+}
+
+static void addFused(const char *name, int cpu, int (*f)(char *, size_t)) {
+    if (numKernels < MAX_KERNELS && cpuSupports(cpu))
+        kernels[numKernels++] = (struct Kernel){name, K_FUSED, R_UPPER, NULL, NULL, f, NULL};
+}
+
+static void addNul(const char *name, void (*f)(char *)) {
+    if (numKernels < MAX_KERNELS)
+        kernels[numKernels++] = (struct Kernel){name, K_NUL, R_UPPER, NULL, NULL, NULL, f};
+}
+
+static void initKernels(void) {
+    if (numKernels) return;
+    int count;
+    const struct UpperKernel *registry = upperKernels(&count);
+    for (int i = 0; i < count; ++i)
+        if (registry[i].func != obviouseUpperCaseN)
+            addMap(registry[i].name, registry[i].cpu, R_UPPER, registry[i].func);
+    addMap("upperCase", CPU_ANY, R_UPPER, upperCase);
+    addMap("upper_auto", CPU_ANY, R_UPPER, upper_auto);
+    addFused("upperValidateScalar", CPU_ANY, upperValidateScalar);
+    addFused("upperValidateSwar", CPU_ANY, upperValidateSwar);
+    addFused("upperValidateAvx2", CPU_AVX2, upperValidateAvx2);
+    addFused("upperValidate", CPU_ANY, upperValidate);
+    addFlags("asciiCheckSwar", CPU_ANY, asciiCheckSwar);
+    addFlags("asciiCheckAvx2", CPU_AVX2, asciiCheckAvx2);
+    addNul("branchlessUpperCase1", branchlessUpperCase1);
+    addNul("branchlessUpperCase2", branchlessUpperCase2);
+    addMap("swarLowerCase", CPU_ANY, R_LOWER, swarLowerCase);
+    addMap("avx2LowerCase", CPU_AVX2, R_LOWER, avx2LowerCase);
+    addMap("lowerCase", CPU_ANY, R_LOWER, lowerCase);
+    addMap("tableUtf8UpperCase", CPU_ANY, R_UTF8, tableUtf8UpperCase);
+    addMap("swarUtf8UpperCase", CPU_ANY, R_UTF8, swarUtf8UpperCase);
+    addMap("avx2Utf8UpperCase", CPU_AVX2, R_UTF8, avx2Utf8UpperCase);
+    addMap("avx512Utf8UpperCase", CPU_AVX512BW, R_UTF8, avx512Utf8UpperCase);
+    addMap("utf8UpperCase", CPU_ANY, R_UTF8, utf8UpperCase);
+}
+
+// === Buffers ===
+static int reserve(char **buf, size_t *cap, size_t need) {
+    if (need <= *cap) return 0;
+    char *p = realloc(*buf, need);
+    if (!p) return -1;
+    *buf = p;
+    *cap = need;
+    return 0;
+}
+
+// References for the current input: [R_UPPER], [R_LOWER], [R_UTF8], and
+// the NUL-terminated prefix uppercased by obviouseUpperCase.
+static char *want[3], *wantNul;
+static size_t wantCap[3], wantNulCap;
+
+// Room for the input at any offset 0..63 past a 64-byte boundary, with
+// canaries on both sides.
+static char *plain;
+static size_t plainCap;
+
+static char *alignedAt(unsigned offset) {
+    uintptr_t p = (uintptr_t)plain + CANARY_SIZE + 63;
+    return (char *)(p & ~(uintptr_t)63) + offset;
+}
+
+#ifndef _WIN32
+// [guard page][usable pages][guard page]
+static char *guardMap, *guardLo, *guardHi;
+static size_t guardSize;
+
+static int guardReserve(size_t len) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t usable = (len + page) / page * page;
+    if (guardMap && (size_t)(guardHi - guardLo) >= len) return 0;
+    if (guardMap) munmap(guardMap, guardSize);
+    guardSize = usable + 2 * page;
+    guardMap = mmap(NULL, guardSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (guardMap == MAP_FAILED) {
+        guardMap = NULL;
+        return -1;
+    }
+    guardLo = guardMap + page;
+    guardHi = guardLo + usable;
+    return mprotect(guardLo, usable, PROT_READ | PROT_WRITE);
+}
+#endif
+
+// === Checks ===
+static void lowerRef(char *s, size_t len) {
+    for (size_t i = 0; i < len; ++i)
+        if (s[i] >= 'A' && s[i] <= 'Z') s[i] += 32;
+}
+
+static int fail1(struct DiffFailure *fail, const struct Kernel *k, const char *placement,
+                 size_t len, size_t at, int got, int wantValue) {
+    fail->kernel = k->name;
+    fail->flags = 0;
+    fail->placement = placement;
+    fail->len = len;
+    fail->at = at;
+    fail->got = got;
+    fail->want = wantValue;
+    return 1;
+}
+
+static int failFlags(struct DiffFailure *fail, const struct Kernel *k, const char *placement,
+                     size_t len, int got, int wantValue) {
+    fail1(fail, k, placement, len, 0, got, wantValue);
+    fail->flags = 1;
+    return 1;
+}
+
+// The check could not run at all. There is no kernel to blame, and a
+// caller that took 0 as agreement would time kernels nobody checked.
+static int failNoMemory(struct DiffFailure *fail, size_t len) {
+    memset(fail, 0, sizeof(*fail));
+    fail->placement = "out of memory";
+    fail->len = len;
+    return 1;
+}
+
+static int compare(const struct Kernel *k, const char *placement, const char *got, const char *ref,
+                   size_t len, struct DiffFailure *fail) {
+    if (memcmp(got, ref, len) == 0) return 0;
+    size_t at = 0;
+    while (got[at] == ref[at]) ++at;
+    return fail1(fail, k, placement, len, at, (unsigned char)got[at], (unsigned char)ref[at]);
+}
+
+// Runs kernel k on dst, which already holds the input, and compares.
+static int runOne(const struct Kernel *k, char *dst, size_t len, size_t nulLen, int wantFlags,
+                  const char *placement, struct DiffFailure *fail) {
+    switch (k->kind) {
+    case K_MAP:
+        k->map(dst, len);
+        return compare(k, placement, dst, want[k->ref], len, fail);
+    case K_FUSED: {
+        int flags = k->fused(dst, len);
+        if (flags != wantFlags) return failFlags(fail, k, placement, len, flags, wantFlags);
+        return compare(k, placement, dst, want[R_UPPER], len, fail);
+    }
+    case K_FLAGS: {
+        int flags = k->flags(dst, len);
+        return flags != wantFlags ? failFlags(fail, k, placement, len, flags, wantFlags) : 0;
+    }
+    default:
+        k->nul(dst);
+        return compare(k, placement, dst, wantNul, nulLen, fail);
+    }
+}
+
+static int checkCanaries(const struct Kernel *k, const char *dst, size_t len, struct DiffFailure *fail) {
+    for (int i = 1; i <= CANARY_SIZE; ++i)
+        if ((unsigned char)dst[-i] != CANARY)
+            return fail1(fail, k, "write before start", len, 0, (unsigned char)dst[-i], CANARY);
+    for (int i = 0; i < CANARY_SIZE; ++i)
+        if ((unsigned char)dst[len + i] != CANARY)
+            return fail1(fail, k, "write past end", len, len + i, (unsigned char)dst[len + i], CANARY);
+    return 0;
+}
+
+int diffCheck(const unsigned char *data, size_t size, unsigned offset, struct DiffFailure *fail) {
+    initKernels();
+    offset &= 63;
+    memset(fail, 0, sizeof(*fail));
+
+    // The NUL-terminated kernels see the input up to its first NUL, and
+    // the NUL itself.
+    const unsigned char *nul = memchr(data, 0, size);
+    size_t strLen = nul ? (size_t)(nul - data) : size;
+    size_t nulLen = strLen + 1;
+
+    for (int r = 0; r < 3; ++r)
+        if (reserve(&want[r], &wantCap[r], size + 1) != 0) return failNoMemory(fail, size);
+    if (reserve(&wantNul, &wantNulCap, nulLen) != 0 ||
+        reserve(&plain, &plainCap, size + 2 * CANARY_SIZE + 128 + 1) != 0)
+        return failNoMemory(fail, size);
+    for (int r = 0; r < 3; ++r) memcpy(want[r], data, size);
+    obviouseUpperCaseN(want[R_UPPER], size);
+    lowerRef(want[R_LOWER], size);
+    naiveUtf8UpperCase(want[R_UTF8], size);
+    memcpy(wantNul, data, strLen);
+    wantNul[strLen] = '\0';
+    obviouseUpperCase(wantNul);
+    int wantFlags = asciiCheckScalar((const char *)data, size);
+
+#ifndef _WIN32
+    int guarded = guardReserve(size + 1) == 0;   // nulLen <= size + 1
+#endif
+    for (int i = 0; i < numKernels; ++i) {
+        const struct Kernel *k = &kernels[i];
+        size_t len = k->kind == K_NUL ? nulLen : size;
+
+        char *dst = alignedAt(offset);
+        memset(dst - CANARY_SIZE, CANARY, len + 2 * CANARY_SIZE);
+        memcpy(dst, data, len - (k->kind == K_NUL));
+        if (k->kind == K_NUL) dst[strLen] = '\0';
+        if (runOne(k, dst, size, nulLen, wantFlags, "aligned + offset", fail) ||
+            checkCanaries(k, dst, len, fail))
+            return 1;
+
+#ifndef _WIN32
+        if (!guarded) continue;
+        dst = guardHi - len;
+        memcpy(dst, data, len - (k->kind == K_NUL));
+        if (k->kind == K_NUL) dst[strLen] = '\0';
+        if (runOne(k, dst, size, nulLen, wantFlags, "ends at guard page", fail)) return 1;
+
+        dst = guardLo;
+        memcpy(dst, data, len - (k->kind == K_NUL));
+        if (k->kind == K_NUL) dst[strLen] = '\0';
+        if (runOne(k, dst, size, nulLen, wantFlags, "starts after guard page", fail)) return 1;
+#endif
+    }
+    return 0;
+}
+
+int diffCheckFuzz(const uint8_t *data, size_t size, struct DiffFailure *fail) {
+    if (size == 0) return diffCheck(data, 0, 0, fail);
+    return diffCheck(data + 1, size - 1, data[0], fail);
+}
+
+// === Verification pass ===
+// Bytes on both sides of every range the kernels classify: the letters,
+// the printable range, and the UTF-8 lead and continuation bytes the
+// UTF-8 kernels map (Latin-1, Greek, Cyrillic).
+static const unsigned char edgeBytes[] = {
+    '@', 'A', 'M', 'Z', '[', '`', 'a', 'm', 'z', '{', 0x00, 0x1F, 0x20, 0x7E, 0x7F,
+    0x80, 0xA0, 0xBF, 0xC0, 0xC3, 0xC4, 0xC5, 0xCE, 0xCF, 0xD0, 0xD1, 0xDF, 0xE0, 0xFF
+};
+#define NUM_EDGE ((int)(sizeof(edgeBytes) / sizeof(edgeBytes[0])))
+
+static uint64_t nextRand(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Pattern 0: letters only; 1: edge bytes only; 2: any byte, with NULs
+// rare so the NUL-terminated kernels still see long strings.
+static void fillPattern(unsigned char *s, size_t len, int pattern, uint64_t *state) {
+    for (size_t i = 0; i < len; ++i) {
+        uint64_t r = nextRand(state);
+        if (pattern == 0) s[i] = (unsigned char)((r & 1 ? 'A' : 'a') + (r >> 1) % 26);
+        else if (pattern == 1) s[i] = edgeBytes[(r >> 8) % NUM_EDGE];
+        else s[i] = (unsigned char)(r >> 8) ? (unsigned char)(r >> 8) : 'x';
+    }
+    if (pattern == 2 && len > 0 && nextRand(state) % 4 == 0)
+        s[nextRand(state) % len] = 0;
+}
+
+// === Known answers ===
+static const struct {
+    const char *in, *out;
+} knownUtf8[] = {
+    {"\xC4\xB1", "\xC4\xB1"},   // U+0131 dotless i: uppercase is 'I', 1 byte
+    {"\xC5\xBF", "\xC5\xBF"},   // U+017F long s: uppercase is 'S'
+    {"\xC3\x9F", "\xC3\x9F"},   // U+00DF sharp s: uppercase is "SS"
+    {"\xC4\xB0", "\xC4\xB0"},   // U+0130 capital I with dot
+    {"\xC3\xBF", "\xC5\xB8"},   // U+00FF y diaeresis -> U+0178
+    {"\xC2\xB5", "\xCE\x9C"},   // U+00B5 micro sign -> U+039C capital mu
+    {"\xCF\x82", "\xCE\xA3"},   // U+03C2 final sigma -> U+03A3
+    {"\xC3\xA9", "\xC3\x89"},   // U+00E9 -> U+00C9
+    {"\xC3\xB7", "\xC3\xB7"},   // U+00F7 division sign
+    {"\xC4\xB3", "\xC4\xB2"},   // U+0133 ij -> U+0132
+    {"\xC4\xBA", "\xC4\xB9"},   // U+013A l acute -> U+0139
+    {"\xCE\xAC", "\xCE\x86"},   // U+03AC alpha tonos -> U+0386
+    {"\xCE\xB1", "\xCE\x91"},   // U+03B1 alpha -> U+0391
+    {"\xD1\x8F", "\xD0\xAF"},   // U+044F ya -> U+042F
+    {"\xD1\x91", "\xD0\x81"},   // U+0451 yo -> U+0401
+};
+#define NUM_KNOWN ((int)(sizeof(knownUtf8) / sizeof(knownUtf8[0])))
+#define KNOWN_LEN 96
+
+long diffKnownUtf8(struct DiffFailure *fail) {
+    char in[KNOWN_LEN], want[KNOWN_LEN], got[KNOWN_LEN];
+    static const struct Kernel naive = {"naiveUtf8UpperCase", K_MAP, R_UTF8, naiveUtf8UpperCase,
+                                        NULL, NULL, NULL};
+    long inputs = 0;
+    initKernels();
+    memset(fail, 0, sizeof(*fail));
+    for (int c = 0; c < NUM_KNOWN; ++c) {
+        size_t len = strlen(knownUtf8[c].in);
+        for (size_t pos = 0; pos + len <= KNOWN_LEN; ++pos) {
+            memset(in, 'x', KNOWN_LEN);
+            memset(want, 'X', KNOWN_LEN);
+            memcpy(in + pos, knownUtf8[c].in, len);
+            memcpy(want + pos, knownUtf8[c].out, len);
+            for (int i = -1; i < numKernels; ++i) {
+                const struct Kernel *k = i < 0 ? &naive : &kernels[i];
+                if (k->kind != K_MAP || k->ref != R_UTF8) continue;
+                memcpy(got, in, KNOWN_LEN);
+                k->map(got, KNOWN_LEN);
+                if (compare(k, "known answer", got, want, KNOWN_LEN, fail)) return -1;
+            }
+            ++inputs;
+        }
+    }
+    return inputs;
+}
+
+long diffVerify(uint64_t seed, struct DiffFailure *fail) {
+    static const size_t longLens[] = {1000, 1023, 4095, 4096, 4097, 65536 + 63};
+    unsigned char *buf = malloc(65536 + 64);
+    uint64_t state = seed ? seed : 0x9E3779B97F4A7C15ULL;
+    long inputs = diffKnownUtf8(fail);
+    if (inputs < 0) return -1;
+    if (!buf) {
+        failNoMemory(fail, 65536 + 64);
+        return -1;
+    }
+    for (size_t len = 0; len <= 300; ++len)
+        for (int pattern = 0; pattern < 3; ++pattern) {
+            fillPattern(buf, len, pattern, &state);
+            if (diffCheck(buf, len, (unsigned)(len * 7 + pattern) & 63, fail)) {
+                free(buf);
+                return -1;
+            }
+            ++inputs;
+        }
+    for (size_t i = 0; i < sizeof(longLens) / sizeof(longLens[0]); ++i)
+        for (int pattern = 0; pattern < 3; ++pattern) {
+            fillPattern(buf, longLens[i], pattern, &state);
+            if (diffCheck(buf, longLens[i], (unsigned)nextRand(&state) & 63, fail)) {
+                free(buf);
+                return -1;
+            }
+            ++inputs;
+        }
+    free(buf);
+    return inputs;
+}
+
+void diffPrintFailure(FILE *out, const struct DiffFailure *fail) {
+    if (!fail->kernel)
+        fprintf(out, "ERROR: %s, %zu bytes: nothing was checked\n", fail->placement, fail->len);
+    else if (fail->flags)
+        fprintf(out, "MISMATCH: %s, %zu bytes, %s: flags %d, expected %d\n",
+                fail->kernel, fail->len, fail->placement, fail->got, fail->want);
+    else
+        fprintf(out, "MISMATCH: %s, %zu bytes, %s: byte %zu is 0x%02X, expected 0x%02X\n",
+                fail->kernel, fail->len, fail->placement, fail->at, fail->got, fail->want);
+}
@@ -0,0 +1,62 @@
+#ifndef BENCH_DIFFCHECK_H
+#define BENCH_DIFFCHECK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Differential check of the case-mapping kernels. Every kernel this CPU
+// supports runs on the same bytes and must produce what its reference
+// does:
+//
+//   upperKernels(), upperCase, upper_auto      obviouseUpperCaseN
+//   upperValidate*                             obviouseUpperCaseN, and
+//                                              asciiCheckScalar's flags
+//   asciiCheckSwar / Avx2                      asciiCheckScalar
+//   branchlessUpperCase1 / 2 (NUL-terminated)  obviouseUpperCase
+//   swarLowerCase, avx2LowerCase, lowerCase    a plain 'A'..'Z' loop
+//   *Utf8UpperCase                             naiveUtf8UpperCase
+//
+// Each input is placed three ways: at a chosen offset from a 64-byte
+// boundary with canary bytes on both sides (a write past either end is a
+// failure), ending on the last byte before a PROT_NONE guard page, and
+// starting on the first byte after one (a read past either end faults).
+// The buffers are static, so none of this is thread-safe.
+
+// kernel is NULL when the check could not run at all; placement then
+// says why ("out of memory"). Either way nothing may be timed.
+struct DiffFailure {
+    const char *kernel;
+    const char *placement;
+    size_t len;
+    size_t at;               // first differing byte
+    int flags;               // got/want are validation flags, not bytes
+    int got, want;
+};
+
+// Checks data[0..size) placed at `offset` (0..63) and against both guard
+// pages. Returns 0 when every kernel agrees, otherwise 1 with the first
+// disagreement, or the allocation that failed, in *fail.
+int diffCheck(const unsigned char *data, size_t size, unsigned offset, struct DiffFailure *fail);
+
+// Fuzzer entry: the first byte picks the offset, the rest is the input.
+int diffCheckFuzz(const uint8_t *data, size_t size, struct DiffFailure *fail);
+
+// The fast pass run before timing: every length from 0 to 300 in several
+// patterns biased towards the bytes next to the letter ranges, plus a few
+// long random inputs. Returns the number of inputs checked, or -1 with
+// the first disagreement (or out of memory) in *fail.
+long diffVerify(uint64_t seed, struct DiffFailure *fail);
+
+// Spelled-out UTF-8 answers (dotless i, long s, sharp s, y with
+// diaeresis, micro sign, final sigma, ...) that do not go through the
+// library's own mapping, which naiveUtf8UpperCase shares with the other
+// UTF-8 kernels. Each is embedded at every position of a 96-byte ASCII
+// string, so the vector paths see it in every lane. Checks the UTF-8
+// kernels and naiveUtf8UpperCase itself; diffVerify includes it. Returns
+// the number of inputs checked, or -1 with the first mismatch in *fail.
+long diffKnownUtf8(struct DiffFailure *fail);
+
+void diffPrintFailure(FILE *out, const struct DiffFailure *fail);
+
+#endif // BENCH_DIFFCHECK_H
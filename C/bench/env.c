@@ -0,0 +1,204 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "env.h"
+#include "tsc.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <cpuid.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+// Thresholds for the warnings. The loop spread is what a steady clock
+// stays well inside; sibling load above 5% means it shares the core's
+// execution units with us for a measurable part of the run.
+#define CLOCK_SPREAD_LIMIT 0.03
+#define SIBLING_BUSY_LIMIT 0.05
+#define CLOCK_SAMPLES 10
+
+static void warn(struct BenchEnv *env, const char *msg) {
+    if (env->numWarnings < ENV_MAX_WARNINGS)
+        env->warnings[env->numWarnings++] = msg;
+}
+
+// === sysfs / procfs helpers ===
+static int readLine(const char *path, char *out, size_t size) {
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    int ok = fgets(out, (int)size, f) != NULL;
+    fclose(f);
+    if (ok) out[strcspn(out, "\n")] = '\0';
+    return ok;
+}
+
+static void readGovernor(struct BenchEnv *env) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor",
+             env->cpu < 0 ? 0 : env->cpu);
+    if (!readLine(path, env->governor, sizeof(env->governor)))
+        snprintf(env->governor, sizeof(env->governor), "unknown");
+}
+
+// intel_pstate exposes no_turbo; acpi-cpufreq and amd-pstate expose boost.
+static void readTurbo(struct BenchEnv *env) {
+    char line[16];
+    env->turbo = -1;
+    if (readLine("/sys/devices/system/cpu/intel_pstate/no_turbo", line, sizeof(line)))
+        env->turbo = atoi(line) == 0;
+    else if (readLine("/sys/devices/system/cpu/cpufreq/boost", line, sizeof(line)))
+        env->turbo = atoi(line) != 0;
+}
+
+// Busy and total jiffies of one CPU from /proc/stat.
+static int cpuTimes(int cpu, unsigned long long *busy, unsigned long long *total) {
+    FILE *f = fopen("/proc/stat", "r");
+    if (!f) return 0;
+    char line[512], tag[16];
+    snprintf(tag, sizeof(tag), "cpu%d ", cpu);
+    int found = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, tag, strlen(tag)) != 0) continue;
+        unsigned long long v[8] = {0};
+        sscanf(line + strlen(tag), "%llu %llu %llu %llu %llu %llu %llu %llu",
+               &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]);
+        *total = v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7];
+        *busy = *total - v[3] - v[4];   // minus idle and iowait
+        found = 1;
+        break;
+    }
+    fclose(f);
+    return found;
+}
+
+// Siblings come from thread_siblings_list ("0,4" or "0-1"); each one's
+// load is sampled over 200 ms while we sleep.
+static void checkSiblings(struct BenchEnv *env) {
+    char path[128], list[64];
+    int siblings[16], n = 0;
+    env->smtSiblings = 0;
+    env->siblingBusy = 0.0;
+    if (env->cpu < 0) return;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", env->cpu);
+    if (!readLine(path, list, sizeof(list))) return;
+
+    for (char *p = list; *p && n < 16;) {
+        int lo = (int)strtol(p, &p, 10), hi = lo;
+        if (*p == '-') hi = (int)strtol(p + 1, &p, 10);
+        for (int c = lo; c <= hi && n < 16; ++c)
+            if (c != env->cpu) siblings[n++] = c;
+        if (*p == ',') ++p;
+        else break;
+    }
+    env->smtSiblings = n;
+
+    unsigned long long busy0[16], total0[16];
+    for (int i = 0; i < n; ++i)
+        if (!cpuTimes(siblings[i], &busy0[i], &total0[i])) total0[i] = 0;
+#ifdef __linux__
+    usleep(200000);
+#endif
+    for (int i = 0; i < n; ++i) {
+        unsigned long long busy1, total1;
+        if (!total0[i] || !cpuTimes(siblings[i], &busy1, &total1) || total1 == total0[i]) continue;
+        double load = (double)(busy1 - busy0[i]) / (double)(total1 - total0[i]);
+        if (load > env->siblingBusy) env->siblingBusy = load;
+    }
+}
+
+// === Clock stability ===
+// A chain of dependent 64-bit multiplies: imul r64, r64 has a 3-cycle
+// latency on every x86 core of the last decade and, unlike add-immediate,
+// no core folds it away at rename. Multiplies per TSC tick therefore give
+// the core clock relative to the constant-rate TSC.
+#define IMUL_LATENCY 3
+
+static double coreGhzSample(double tscGhz) {
+    const unsigned long long ITER = 400000ULL;
+    unsigned long long n = ITER, x = 1, one = 1;
+    uint64_t t0 = tscBegin();
+    __asm__ volatile(
+        "1:\n\t"
+        "imul %2, %1\n\timul %2, %1\n\timul %2, %1\n\timul %2, %1\n\t"
+        "imul %2, %1\n\timul %2, %1\n\timul %2, %1\n\timul %2, %1\n\t"
+        "dec %0\n\t"
+        "jnz 1b"
+        : "+r"(n), "+r"(x)
+        : "r"(one));
+    uint64_t t1 = tscEnd();
+    return (double)(ITER * 8 * IMUL_LATENCY) / (double)(t1 - t0) * tscGhz;
+}
+
+static void checkClock(struct BenchEnv *env) {
+    env->tscGhz = tscTicksPerNs();
+    env->coreGhzMin = env->coreGhzMax = coreGhzSample(env->tscGhz);
+    for (int i = 1; i < CLOCK_SAMPLES; ++i) {
+        double ghz = coreGhzSample(env->tscGhz);
+        if (ghz < env->coreGhzMin) env->coreGhzMin = ghz;
+        if (ghz > env->coreGhzMax) env->coreGhzMax = ghz;
+    }
+}
+
+// === Public API ===
+void envStabilize(struct BenchEnv *env, int cpu) {
+    memset(env, 0, sizeof(*env));
+    env->cpu = -1;
+
+#ifdef __linux__
+    if (cpu < 0) cpu = sched_getcpu();
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (cpu >= 0 && sched_setaffinity(0, sizeof(set), &set) == 0)
+        env->cpu = cpu;
+#else
+    (void)cpu;
+#endif
+    if (env->cpu < 0)
+        warn(env, "could not pin the benchmark thread; it may migrate between CPUs");
+
+    unsigned a, b, c, d;
+    env->hypervisor = __get_cpuid(1, &a, &b, &c, &d) && (c & (1u << 31));
+    if (env->hypervisor)
+        warn(env, "running under a hypervisor: steal time and virtualized TSC can skew timings");
+
+    env->tscInvariant = __get_cpuid(0x80000007, &a, &b, &c, &d) && (d & (1u << 8));
+    if (!env->tscInvariant)
+        warn(env, "TSC is not invariant; rdtscp ticks do not track wall time");
+
+    readGovernor(env);
+    if (strcmp(env->governor, "unknown") != 0 && strcmp(env->governor, "performance") != 0)
+        warn(env, "cpufreq governor is not 'performance'; the clock ramps during the run");
+
+    readTurbo(env);
+    if (env->turbo == 1)
+        warn(env, "turbo/boost is enabled; the clock depends on temperature and load");
+
+    checkSiblings(env);
+    if (env->siblingBusy > SIBLING_BUSY_LIMIT)
+        warn(env, "an SMT sibling of the pinned CPU is busy; it shares this core's execution units");
+
+    checkClock(env);
+    if (env->coreGhzMax > env->coreGhzMin * (1.0 + CLOCK_SPREAD_LIMIT))
+        warn(env, "core clock varied by more than 3% between calibration loops");
+}
+
+void envPrintHeader(FILE *out, const struct BenchEnv *env) {
+    fprintf(out, "\n=== ENVIRONMENT ===\n");
+    if (env->cpu >= 0) fprintf(out, "Pinned to CPU      %d\n", env->cpu);
+    else               fprintf(out, "Pinned to CPU      no\n");
+    fprintf(out, "Governor           %s\n", env->governor);
+    fprintf(out, "Turbo/boost        %s\n", env->turbo < 0 ? "unknown" : env->turbo ? "on" : "off");
+    fprintf(out, "SMT siblings       %d (busiest %.0f%%)\n", env->smtSiblings, env->siblingBusy * 100.0);
+    fprintf(out, "Hypervisor         %s\n", env->hypervisor ? "yes" : "no");
+    fprintf(out, "TSC                %.3f GHz%s\n", env->tscGhz, env->tscInvariant ? " (invariant)" : "");
+    fprintf(out, "Core clock (loop)  %.3f .. %.3f GHz\n", env->coreGhzMin, env->coreGhzMax);
+    for (int i = 0; i < env->numWarnings; ++i)
+        fprintf(out, "WARNING: %s\n", env->warnings[i]);
+    if (env->numWarnings == 0)
+        fprintf(out, "No environment warnings.\n");
+}
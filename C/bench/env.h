@@ -0,0 +1,42 @@
+#ifndef BENCH_ENV_H
+#define BENCH_ENV_H
+
+#include <stdio.h>
+
+// Benchmark environment: pin the thread, then look for the usual reasons
+// numbers drift between runs (frequency scaling, turbo, a busy SMT
+// sibling, a hypervisor) and print them as a report header.
+//
+//   struct BenchEnv env;
+//   envStabilize(&env, -1);
+//   envPrintHeader(stdout, &env);
+//
+// Everything is best effort: what cannot be read is reported as
+// "unknown" rather than treated as an error.
+
+#define ENV_MAX_WARNINGS 8
+
+struct BenchEnv {
+    int cpu;                 // CPU the thread is pinned to, -1 if pinning failed
+    char governor[32];       // cpufreq scaling governor or "unknown"
+    int turbo;               // 1 on, 0 off, -1 unknown
+    int smtSiblings;         // other hardware threads on the same core
+    double siblingBusy;      // busiest sibling's load over the sample, 0..1
+    int hypervisor;          // CPUID hypervisor bit
+    int tscInvariant;        // TSC ticks at a constant rate in all P/C-states
+    double tscGhz;           // TSC rate
+    double coreGhzMin;       // core clock from the calibrated loop, slowest
+    double coreGhzMax;       // and fastest of the samples
+    int numWarnings;
+    const char *warnings[ENV_MAX_WARNINGS];
+};
+
+// Pins the calling thread to `cpu` (or, for -1, to the CPU it is running
+// on now) and fills `env`. Takes about a quarter of a second, most of it
+// sampling sibling load and the clock.
+void envStabilize(struct BenchEnv *env, int cpu);
+
+// Environment summary plus one "WARNING:" line per problem found.
+void envPrintHeader(FILE *out, const struct BenchEnv *env);
+
+#endif // BENCH_ENV_H
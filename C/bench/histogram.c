@@ -0,0 +1,62 @@
+#include "histogram.h"
+
+#include <string.h>
+
+// Bucket index: values < HIST_SUB_COUNT map to themselves. Above that,
+// `shift` drops all but the top HIST_SUB_BITS bits, leaving a sub-bucket
+// in [HIST_HALF_COUNT, HIST_SUB_COUNT) inside power-of-two range `shift`.
+static int bucketOf(uint64_t v) {
+    if (v < HIST_SUB_COUNT) return (int)v;
+    int shift = 63 - __builtin_clzll(v) - (HIST_SUB_BITS - 1);
+    int sub = (int)(v >> shift);
+    return HIST_SUB_COUNT + (shift - 1) * HIST_HALF_COUNT + (sub - HIST_HALF_COUNT);
+}
+
+// Largest value that lands in bucket `i`.
+static uint64_t bucketTop(int i) {
+    if (i < HIST_SUB_COUNT) return (uint64_t)i;
+    int shift = (i - HIST_SUB_COUNT) / HIST_HALF_COUNT + 1;
+    uint64_t sub = (uint64_t)((i - HIST_SUB_COUNT) % HIST_HALF_COUNT + HIST_HALF_COUNT);
+    return ((sub + 1) << shift) - 1;
+}
+
+void histInit(struct Histogram *h) {
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+void histRecord(struct Histogram *h, uint64_t value) {
+    h->counts[bucketOf(value)]++;
+    h->total++;
+    h->sum += (double)value;
+    if (value < h->min) h->min = value;
+    if (value > h->max) h->max = value;
+}
+
+void histMerge(struct Histogram *into, const struct Histogram *from) {
+    for (int i = 0; i < HIST_BUCKETS; ++i)
+        into->counts[i] += from->counts[i];
+    into->total += from->total;
+    into->sum += from->sum;
+    if (from->min < into->min) into->min = from->min;
+    if (from->max > into->max) into->max = from->max;
+}
+
+uint64_t histPercentile(const struct Histogram *h, double pct) {
+    if (h->total == 0) return 0;
+    uint64_t rank = (uint64_t)(pct / 100.0 * (double)h->total + 0.999999);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; ++i) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            uint64_t top = bucketTop(i);
+            return top < h->max ? top : h->max;
+        }
+    }
+    return h->max;
+}
+
+double histMean(const struct Histogram *h) {
+    return h->total ? h->sum / (double)h->total : 0.0;
+}
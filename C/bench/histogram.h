@@ -0,0 +1,33 @@
+#ifndef BENCH_HISTOGRAM_H
+#define BENCH_HISTOGRAM_H
+
+#include <stdint.h>
+
+// HDR-style log-linear histogram of non-negative integer samples (TSC
+// ticks here). Values below 2^HIST_SUB_BITS are counted exactly; above
+// that every power-of-two range is split into 2^(HIST_SUB_BITS - 1)
+// equal buckets, so any recorded value is reported within 1/16 (~6%)
+// of its true value, over the whole 64-bit range, in a fixed 8 KB.
+#define HIST_SUB_BITS 5
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+#define HIST_HALF_COUNT (HIST_SUB_COUNT / 2)
+#define HIST_BUCKETS (HIST_SUB_COUNT + (64 - HIST_SUB_BITS) * HIST_HALF_COUNT)
+
+struct Histogram {
+    uint64_t counts[HIST_BUCKETS];
+    uint64_t total;
+    uint64_t min, max;
+    double sum;
+};
+
+void histInit(struct Histogram *h);
+void histRecord(struct Histogram *h, uint64_t value);
+void histMerge(struct Histogram *into, const struct Histogram *from);
+
+// Smallest recorded value v such that at least `pct` percent of the
+// samples are <= v, reported as the upper edge of its bucket (and never
+// above the exact maximum). 0 when the histogram is empty.
+uint64_t histPercentile(const struct Histogram *h, double pct);
+double histMean(const struct Histogram *h);
+
+#endif // BENCH_HISTOGRAM_H
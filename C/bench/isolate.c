@@ -0,0 +1,77 @@
+#include "isolate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+static int readAll(int fd, char *buf, size_t size) {
+    size_t got = 0;
+    while (got < size) {
+        ssize_t n = read(fd, buf + got, size - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        got += (size_t)n;
+    }
+    return 1;
+}
+
+static int writeAll(int fd, const char *buf, size_t size) {
+    size_t put = 0;
+    while (put < size) {
+        ssize_t n = write(fd, buf + put, size - put);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        put += (size_t)n;
+    }
+    return 1;
+}
+#endif
+
+int runIsolated(isolated_body_t body, void *ctx, void *out, size_t outSize) {
+#ifdef _WIN32
+    body(ctx, out);
+    return 1;
+#else
+    int fds[2];
+    if (pipe(fds) != 0) return 0;
+    fflush(NULL);   // don't let the child flush the parent's buffered output
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return 0;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        body(ctx, out);
+        int ok = writeAll(fds[1], (const char *)out, outSize);
+        fflush(NULL);
+        _exit(ok ? 0 : 1);
+    }
+
+    close(fds[1]);
+    int ok = readAll(fds[0], (char *)out, outSize);
+    close(fds[0]);
+    int status;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+void shuffleOrder(int *order, int n) {
+    for (int i = 0; i < n; ++i) order[i] = i;
+    for (int i = n - 1; i > 0; --i) {
+        int j = rand() % (i + 1);
+        int t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+}
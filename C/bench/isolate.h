@@ -0,0 +1,21 @@
+#ifndef BENCH_ISOLATE_H
+#define BENCH_ISOLATE_H
+
+#include <stddef.h>
+
+// Run-order isolation: each measurement runs in a freshly forked child,
+// so it starts from the same heap, page-cache and allocator state as
+// every other one, and whatever it warms up dies with it.
+//
+// `body(ctx, out)` runs in the child and fills `out` (outSize bytes); the
+// bytes come back to the parent over a pipe. Returns 1 when the child
+// exited cleanly and delivered the whole result, 0 otherwise. Without
+// fork() (Windows) the body runs in-process instead.
+typedef void (*isolated_body_t)(void *ctx, void *out);
+
+int runIsolated(isolated_body_t body, void *ctx, void *out, size_t outSize);
+
+// Fisher-Yates shuffle of 0..n-1 into `order`, using rand().
+void shuffleOrder(int *order, int n);
+
+#endif // BENCH_ISOLATE_H
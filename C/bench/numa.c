@@ -0,0 +1,111 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "numa.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// From <numaif.h>, which is only there with the libnuma headers.
+#define POLICY_BIND  2
+#define MF_MOVE      (1 << 1)
+
+// === sysfs ===
+// A Linux cpulist/nodelist: "0-3,8,10-11".
+static int parseList(const char *s, int *out, int max) {
+    int n = 0;
+    while (*s && *s != '\n') {
+        char *end;
+        long lo = strtol(s, &end, 10), hi = lo;
+        if (end == s) break;
+        if (*end == '-') {
+            s = end + 1;
+            hi = strtol(s, &end, 10);
+        }
+        for (long v = lo; v <= hi; ++v)
+            if (n < max) out[n++] = (int)v;
+        s = *end == ',' ? end + 1 : end;
+    }
+    return n;
+}
+
+static int readList(const char *path, int *out, int max) {
+    char line[1024];
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    int ok = fgets(line, sizeof(line), f) != NULL;
+    fclose(f);
+    return ok ? parseList(line, out, max) : 0;
+}
+
+int numaNodeCount(void) {
+    int nodes[NUMA_MAX_NODES];
+    int n = readList("/sys/devices/system/node/online", nodes, NUMA_MAX_NODES);
+    return n > 0 ? n : 1;
+}
+
+int numaNodeCpus(int node, int *cpus, int max) {
+    char path[96];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    int n = readList(path, cpus, max);
+    if (n > 0 || node != 0) return n;
+#ifdef __linux__
+    // No sysfs: node 0 gets every online CPU.
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    for (n = 0; n < online && n < max; ++n) cpus[n] = n;
+    return n;
+#else
+    if (max > 0) cpus[0] = 0;
+    return max > 0;
+#endif
+}
+
+int numaNodeOfCpu(int cpu) {
+    int count = numaNodeCount();
+    for (int node = 0; node < NUMA_MAX_NODES && count > 0; ++node) {
+        int cpus[1024];
+        char path[96];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        int n = readList(path, cpus, 1024);
+        if (n == 0) continue;
+        --count;
+        for (int i = 0; i < n; ++i)
+            if (cpus[i] == cpu) return node;
+    }
+    return 0;
+}
+
+// === Placement ===
+int numaBind(void *addr, size_t len, int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+    unsigned long mask[NUMA_MAX_NODES / (8 * sizeof(unsigned long))] = {0};
+    if (node < 0 || node >= NUMA_MAX_NODES) return -1;
+    mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    return (int)syscall(SYS_mbind, addr, len, POLICY_BIND, mask,
+                        (unsigned long)NUMA_MAX_NODES + 1, MF_MOVE);
+#else
+    (void)addr; (void)len; (void)node;
+    return -1;
+#endif
+}
+
+// move_pages with a NULL node list only reports where each page is.
+int numaNodeOfAddr(const void *addr) {
+#if defined(__linux__) && defined(SYS_move_pages)
+    long page = sysconf(_SC_PAGESIZE);
+    void *pages[1] = {(void *)((unsigned long)addr & ~(unsigned long)(page - 1))};
+    int status[1] = {-1};
+    if (syscall(SYS_move_pages, 0, 1UL, pages, NULL, status, 0) != 0) return -1;
+    return status[0] >= 0 ? status[0] : -1;
+#else
+    (void)addr;
+    return -1;
+#endif
+}
@@ -0,0 +1,35 @@
+#ifndef BENCH_NUMA_H
+#define BENCH_NUMA_H
+
+#include <stddef.h>
+
+// NUMA topology and page placement without libnuma: the node list comes
+// from /sys/devices/system/node, placement goes through the mbind and
+// move_pages system calls directly.
+//
+// Everything degrades to a single node 0 holding every CPU when the
+// topology cannot be read (non-Linux, no sysfs), and the placement calls
+// then fail with -1 instead of aborting.
+
+#define NUMA_MAX_NODES 64
+
+// Online nodes (at least 1).
+int numaNodeCount(void);
+
+// CPUs of `node` from its cpulist, up to `max` of them; returns how many
+// were stored.
+int numaNodeCpus(int node, int *cpus, int max);
+
+// Node of `cpu`, 0 when unknown.
+int numaNodeOfCpu(int cpu);
+
+// Binds [addr, addr + len) to `node` (MPOL_BIND). Pages already touched
+// are moved as well (MPOL_MF_MOVE). Returns 0 or -1 with errno set.
+// `addr` must be page-aligned.
+int numaBind(void *addr, size_t len, int node);
+
+// Node the page holding `addr` currently lives on, -1 when it is not
+// resident or the kernel will not say.
+int numaNodeOfAddr(const void *addr);
+
+#endif // BENCH_NUMA_H
@@ -0,0 +1,124 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "pagealloc.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#define MB2 ((size_t)2 << 20)
+#define GB1 ((size_t)1 << 30)
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+static const char *names[PAGE_MODES] = {"4K", "THP (madvise)", "hugetlb 2M", "hugetlb 1G"};
+
+const char *pageModeName(int mode) {
+    return mode >= 0 && mode < PAGE_MODES ? names[mode] : "?";
+}
+
+static size_t roundUp(size_t x, size_t a) {
+    return (x + a - 1) & ~(a - 1);
+}
+
+#ifdef __linux__
+int pageAlloc(struct PageBuffer *b, size_t size, int mode) {
+    memset(b, 0, sizeof(*b));
+    b->size = size;
+    b->mode = mode;
+    int prot = PROT_READ | PROT_WRITE, flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    void *p;
+
+    switch (mode) {
+    case PAGES_4K:
+        b->mapped = roundUp(size, 4096);
+        p = mmap(NULL, b->mapped, prot, flags, -1, 0);
+        if (p == MAP_FAILED) return -1;
+        madvise(p, b->mapped, MADV_NOHUGEPAGE);
+        b->map = b->base = p;
+        return 0;
+
+    case PAGES_THP: {
+        // Over-map by 2 MB and start on a 2 MB boundary, so every huge
+        // page the kernel can use lies fully inside the buffer.
+        b->mapped = roundUp(size, MB2) + MB2;
+        p = mmap(NULL, b->mapped, prot, flags, -1, 0);
+        if (p == MAP_FAILED) return -1;
+        b->map = p;
+        b->base = (void *)roundUp((size_t)(uintptr_t)p, MB2);
+        if (madvise(b->base, roundUp(size, MB2), MADV_HUGEPAGE) != 0) {
+            pageFree(b);
+            return -1;
+        }
+        return 0;
+    }
+
+    case PAGES_HUGETLB_2M:
+    case PAGES_HUGETLB_1G: {
+        size_t page = mode == PAGES_HUGETLB_2M ? MB2 : GB1;
+        b->mapped = roundUp(size, page);
+        flags |= MAP_HUGETLB | (mode == PAGES_HUGETLB_2M ? MAP_HUGE_2MB : MAP_HUGE_1GB);
+        p = mmap(NULL, b->mapped, prot, flags, -1, 0);
+        if (p == MAP_FAILED) return -1;
+        b->map = b->base = p;
+        return 0;
+    }
+    }
+    return -1;
+}
+
+void pageFree(struct PageBuffer *b) {
+    if (b->map) munmap(b->map, b->mapped);
+    memset(b, 0, sizeof(*b));
+}
+
+// Sums AnonHugePages over the smaps entries that overlap the buffer.
+long long pageThpBytes(const struct PageBuffer *b) {
+    FILE *f = fopen("/proc/self/smaps", "r");
+    if (!f) return -1;
+    uintptr_t lo = (uintptr_t)b->base, hi = lo + b->size;
+    char line[256];
+    int inside = 0;
+    long long total = 0;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long start, end;
+        long long kb;
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2)
+            inside = start < hi && end > lo;
+        else if (inside && sscanf(line, "AnonHugePages: %lld kB", &kb) == 1)
+            total += kb * 1024;
+    }
+    fclose(f);
+    return total;
+}
+#else
+int pageAlloc(struct PageBuffer *b, size_t size, int mode) {
+    (void)size;
+    memset(b, 0, sizeof(*b));
+    b->mode = mode;
+    return -1;
+}
+
+void pageFree(struct PageBuffer *b) {
+    memset(b, 0, sizeof(*b));
+}
+
+long long pageThpBytes(const struct PageBuffer *b) {
+    (void)b;
+    return -1;
+}
+#endif
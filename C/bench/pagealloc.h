@@ -0,0 +1,44 @@
+#ifndef BENCH_PAGEALLOC_H
+#define BENCH_PAGEALLOC_H
+
+#include <stddef.h>
+
+// Corpus buffers with a chosen page size:
+//
+//   PAGES_4K           anonymous mmap with MADV_NOHUGEPAGE, so it stays on
+//                      4 KB pages even when THP is set to "always";
+//   PAGES_THP          2 MB-aligned anonymous mmap with MADV_HUGEPAGE; the
+//                      kernel backs it with 2 MB pages when it can;
+//   PAGES_HUGETLB_2M   MAP_HUGETLB from the reserved 2 MB pool
+//   PAGES_HUGETLB_1G   and the 1 GB pool (vm.nr_hugepages and
+//                      /sys/kernel/mm/hugepages/*/nr_hugepages).
+//
+// pageAlloc returns -1 when the mode is not available here (no reserved
+// hugetlb pages, THP disabled, not Linux); the buffer is then unusable.
+
+enum {
+    PAGES_4K,
+    PAGES_THP,
+    PAGES_HUGETLB_2M,
+    PAGES_HUGETLB_1G,
+    PAGE_MODES
+};
+
+struct PageBuffer {
+    void *base;
+    size_t size;             // requested size
+    size_t mapped;           // mapping length (rounded up to the page size)
+    void *map;               // start of the mapping, <= base
+    int mode;
+};
+
+int pageAlloc(struct PageBuffer *b, size_t size, int mode);
+void pageFree(struct PageBuffer *b);
+
+const char *pageModeName(int mode);
+
+// Bytes of `b` backed by transparent huge pages right now, from
+// /proc/self/smaps; -1 when that cannot be read.
+long long pageThpBytes(const struct PageBuffer *b);
+
+#endif // BENCH_PAGEALLOC_H
@@ -0,0 +1,72 @@
+#include "pattern.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Exactly `ones` ones among mask[0..n), at random positions (partial
+// Fisher-Yates over the positions). Returns 0, or -1 when out of memory.
+static int scatterOnes(unsigned char *mask, size_t n, size_t ones) {
+    memset(mask, 0, n);
+    if (ones >= n) {
+        memset(mask, 1, n);
+        return 0;
+    }
+    size_t *pos = malloc(n * sizeof(size_t));
+    if (!pos) return -1;
+    for (size_t i = 0; i < n; ++i) pos[i] = i;
+    for (size_t i = 0; i < ones; ++i) {
+        size_t j = i + (size_t)rand() % (n - i);
+        size_t t = pos[i];
+        pos[i] = pos[j];
+        pos[j] = t;
+        mask[pos[i]] = 1;
+    }
+    free(pos);
+    return 0;
+}
+
+int makePattern(unsigned char *mask, size_t n, double p, int kind, size_t period) {
+    if (period < 1) period = 1;
+    if (kind == PATTERN_RANDOM)
+        return scatterOnes(mask, n, (size_t)llround(p * (double)n));
+    size_t ones = (size_t)llround(p * (double)period);
+    unsigned char *cycle = malloc(period);
+    if (!cycle) return -1;
+    if (kind == PATTERN_PERIODIC) {
+        if (scatterOnes(cycle, period, ones) != 0) {
+            free(cycle);
+            return -1;
+        }
+    } else {
+        memset(cycle, 1, ones);
+        memset(cycle + ones, 0, period - ones);
+    }
+    for (size_t i = 0; i < n; ++i)
+        mask[i] = cycle[i % period];
+    free(cycle);
+    return 0;
+}
+
+const char *patternName(int kind) {
+    switch (kind) {
+    case PATTERN_RANDOM:   return "random";
+    case PATTERN_PERIODIC: return "periodic";
+    case PATTERN_BLOCKS:   return "blocks";
+    default:               return "?";
+    }
+}
+
+double patternModelMissRate(double p, int kind, size_t period) {
+    double q = p < 1.0 - p ? p : 1.0 - p;
+    switch (kind) {
+    case PATTERN_RANDOM:
+        return q;
+    case PATTERN_BLOCKS: {
+        size_t ones = (size_t)llround(p * (double)period);
+        return ones == 0 || ones >= period ? 0.0 : 2.0 / (double)period;
+    }
+    default:
+        return 0.0;
+    }
+}
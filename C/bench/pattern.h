@@ -0,0 +1,29 @@
+#ifndef BENCH_PATTERN_H
+#define BENCH_PATTERN_H
+
+#include <stddef.h>
+
+// Branch-outcome patterns with an exact taken probability. makePattern
+// fills mask[0..n) with 1 (branch taken) and 0, with exactly
+// round(p * n) ones for PATTERN_RANDOM and exactly round(p * period)
+// ones in every full period for the other two:
+//
+//   PATTERN_RANDOM    ones at uniformly random positions: a predictor
+//                     can do no better than min(p, 1 - p) misses
+//   PATTERN_PERIODIC  one fixed random arrangement of `period` outcomes,
+//                     repeated: learnable once the history covers it
+//   PATTERN_BLOCKS    each period is a run of ones then a run of zeros:
+//                     about two misses per period
+enum { PATTERN_RANDOM, PATTERN_PERIODIC, PATTERN_BLOCKS, PATTERN_KINDS };
+
+//
+// Returns 0, or -1 when out of memory; the mask is then not a valid
+// pattern and must not be measured.
+int makePattern(unsigned char *mask, size_t n, double p, int kind, size_t period);
+const char *patternName(int kind);
+
+// Misprediction rate an ideal predictor would reach on the pattern; the
+// x axis to use when hardware counters are unavailable.
+double patternModelMissRate(double p, int kind, size_t period);
+
+#endif // BENCH_PATTERN_H
@@ -0,0 +1,112 @@
+#include "perfcount.h"
+
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+struct Event {
+    uint32_t type;
+    uint64_t config;
+};
+
+#define DTLB_MISS(op) \
+    (PERF_COUNT_HW_CACHE_DTLB | ((op) << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct Event events[PERF_COUNTERS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}
+};
+
+static const struct Event tlbEvents[PERF_TLB_COUNTERS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HW_CACHE, DTLB_MISS(PERF_COUNT_HW_CACHE_OP_READ)},
+    {PERF_TYPE_HW_CACHE, DTLB_MISS(PERF_COUNT_HW_CACHE_OP_WRITE)}
+};
+
+// All events in one group led by cycles, so they are scheduled onto the
+// PMU together and cover exactly the same instructions.
+static int openGroup(struct PerfCounters *pc, const struct Event *ev, int count) {
+    memset(pc, 0, sizeof(*pc));
+    for (int i = 0; i < PERF_COUNTERS; ++i) pc->fd[i] = -1;
+    pc->count = count;
+    for (int i = 0; i < count; ++i) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = ev[i].type;
+        attr.config = ev[i].config;
+        attr.disabled = i == 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        pc->fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : pc->fd[0], 0);
+        if (pc->fd[i] < 0) {
+            perfClose(pc);
+            return 0;
+        }
+    }
+    return pc->available = 1;
+}
+
+int perfOpen(struct PerfCounters *pc) {
+    return openGroup(pc, events, PERF_COUNTERS);
+}
+
+int perfOpenTlb(struct PerfCounters *pc) {
+    return openGroup(pc, tlbEvents, PERF_TLB_COUNTERS);
+}
+
+void perfStart(struct PerfCounters *pc) {
+    if (!pc->available) return;
+    ioctl(pc->fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(pc->fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void perfStop(struct PerfCounters *pc, uint64_t counts[PERF_COUNTERS]) {
+    memset(counts, 0, PERF_COUNTERS * sizeof(uint64_t));
+    if (!pc->available) return;
+    ioctl(pc->fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    uint64_t buf[1 + PERF_COUNTERS];   // nr, then the values in group order
+    ssize_t want = (ssize_t)((1 + pc->count) * sizeof(uint64_t));
+    if (read(pc->fd[0], buf, sizeof(buf)) == want && buf[0] == (uint64_t)pc->count)
+        memcpy(counts, buf + 1, pc->count * sizeof(uint64_t));
+}
+
+void perfClose(struct PerfCounters *pc) {
+    for (int i = PERF_COUNTERS - 1; i >= 0; --i)
+        if (pc->fd[i] >= 0) close(pc->fd[i]);
+    for (int i = 0; i < PERF_COUNTERS; ++i) pc->fd[i] = -1;
+    pc->available = 0;
+}
+
+#else
+
+int perfOpen(struct PerfCounters *pc) {
+    memset(pc, 0, sizeof(*pc));
+    return 0;
+}
+
+int perfOpenTlb(struct PerfCounters *pc) {
+    return perfOpen(pc);
+}
+
+void perfStart(struct PerfCounters *pc) {
+    (void)pc;
+}
+
+void perfStop(struct PerfCounters *pc, uint64_t counts[PERF_COUNTERS]) {
+    (void)pc;
+    memset(counts, 0, PERF_COUNTERS * sizeof(uint64_t));
+}
+
+void perfClose(struct PerfCounters *pc) {
+    pc->available = 0;
+}
+
+#endif
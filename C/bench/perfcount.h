@@ -0,0 +1,48 @@
+#ifndef BENCH_PERFCOUNT_H
+#define BENCH_PERFCOUNT_H
+
+#include <stdint.h>
+
+// Hardware counters around a measured region, through perf_event_open on
+// Linux. Counting is user-space only and covers the calling thread.
+//
+//   struct PerfCounters pc;
+//   if (perfOpen(&pc)) { perfStart(&pc); work(); perfStop(&pc, counts); }
+//   perfClose(&pc);
+//
+// perfOpen fails (returns 0) when the kernel or a hypervisor does not
+// expose the PMU, or perf_event_paranoid forbids it; callers fall back
+// to reporting without counters.
+//
+// perfOpenTlb opens the data-TLB group instead; perfStop then fills
+// counts[] in PERF_TLB_* order (the array is PERF_COUNTERS long either
+// way).
+
+enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCHES,
+    PERF_BRANCH_MISSES,
+    PERF_COUNTERS
+};
+
+enum {
+    PERF_TLB_CYCLES,
+    PERF_DTLB_LOAD_MISSES,
+    PERF_DTLB_STORE_MISSES,
+    PERF_TLB_COUNTERS
+};
+
+struct PerfCounters {
+    int fd[PERF_COUNTERS];
+    int count;               // events in the open group
+    int available;
+};
+
+int perfOpen(struct PerfCounters *pc);
+int perfOpenTlb(struct PerfCounters *pc);
+void perfStart(struct PerfCounters *pc);
+void perfStop(struct PerfCounters *pc, uint64_t counts[PERF_COUNTERS]);
+void perfClose(struct PerfCounters *pc);
+
+#endif // BENCH_PERFCOUNT_H
@@ -0,0 +1,202 @@
+#include "pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_SIZE 64           // buffers per thread cache
+#define TAG_SHIFT 48
+#define PTR_MASK ((1ULL << TAG_SHIFT) - 1)
+
+// A free buffer's first word links it into the shared stack.
+struct FreeNode {
+    struct FreeNode *next;
+};
+
+struct Slab {
+    struct Slab *next;
+};
+
+struct ThreadCache {
+    struct BufPool *pool;
+    void *bufs[CACHE_SIZE];
+    int count;
+    uint64_t allocs, cacheHits, sharedHits, misses;
+};
+
+struct BufPool {
+    uint64_t top;               // tag << 48 | struct FreeNode *
+    struct Slab *slabs;
+    size_t bufSize, slabBuffers, slabBytes;
+    pthread_key_t key;
+    uint64_t allocs, cacheHits, sharedHits, misses, numSlabs;
+};
+
+// Slab header padded so the buffers after it stay 64-byte aligned.
+#define SLAB_HEADER 64
+
+// === Shared stack ===
+// `first`..`last` is already linked through ->next.
+static void pushChain(struct BufPool *pool, struct FreeNode *first, struct FreeNode *last) {
+    uint64_t old = __atomic_load_n(&pool->top, __ATOMIC_RELAXED), next;
+    do {
+        __atomic_store_n(&last->next, (struct FreeNode *)(uintptr_t)(old & PTR_MASK), __ATOMIC_RELAXED);
+        next = (((old >> TAG_SHIFT) + 1) << TAG_SHIFT) | (uint64_t)(uintptr_t)first;
+    } while (!__atomic_compare_exchange_n(&pool->top, &old, next, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+// The node read here may be popped and reused by another thread before
+// our CAS; the tag makes that CAS fail. Slabs are never unmapped while
+// the pool lives, so the read itself is always of pool memory.
+static struct FreeNode *popOne(struct BufPool *pool) {
+    uint64_t old = __atomic_load_n(&pool->top, __ATOMIC_ACQUIRE), next;
+    struct FreeNode *node;
+    do {
+        node = (struct FreeNode *)(uintptr_t)(old & PTR_MASK);
+        if (!node) return NULL;
+        struct FreeNode *after = __atomic_load_n(&node->next, __ATOMIC_RELAXED);
+        next = (((old >> TAG_SHIFT) + 1) << TAG_SHIFT) | (uint64_t)(uintptr_t)after;
+    } while (!__atomic_compare_exchange_n(&pool->top, &old, next, 1, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+    return node;
+}
+
+// === Thread caches ===
+static void foldCounts(struct ThreadCache *tc) {
+    struct BufPool *pool = tc->pool;
+    __atomic_add_fetch(&pool->allocs, tc->allocs, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&pool->cacheHits, tc->cacheHits, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&pool->sharedHits, tc->sharedHits, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&pool->misses, tc->misses, __ATOMIC_RELAXED);
+    tc->allocs = tc->cacheHits = tc->sharedHits = tc->misses = 0;
+}
+
+// Returns bufs[from..count) to the shared stack in one CAS.
+static void spill(struct ThreadCache *tc, int from) {
+    if (tc->count <= from) return;
+    for (int i = from; i + 1 < tc->count; ++i)
+        ((struct FreeNode *)tc->bufs[i])->next = tc->bufs[i + 1];
+    pushChain(tc->pool, tc->bufs[from], tc->bufs[tc->count - 1]);
+    tc->count = from;
+}
+
+static void flushCache(struct ThreadCache *tc) {
+    spill(tc, 0);
+    foldCounts(tc);
+}
+
+static void cacheDestructor(void *arg) {
+    flushCache(arg);
+    free(arg);
+}
+
+static struct ThreadCache *cacheOf(struct BufPool *pool) {
+    struct ThreadCache *tc = pthread_getspecific(pool->key);
+    if (tc) return tc;
+    tc = calloc(1, sizeof(*tc));
+    if (!tc) return NULL;
+    tc->pool = pool;
+    pthread_setspecific(pool->key, tc);
+    return tc;
+}
+
+// === Slabs ===
+// New slab: one buffer for the caller, as many as fit into the cache,
+// the rest onto the shared stack.
+static void *newSlab(struct BufPool *pool, struct ThreadCache *tc) {
+    void *mem;
+    if (posix_memalign(&mem, 64, pool->slabBytes) != 0) return NULL;
+    struct Slab *slab = mem;
+    slab->next = __atomic_load_n(&pool->slabs, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&pool->slabs, &slab->next, slab, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ;
+    __atomic_add_fetch(&pool->numSlabs, 1, __ATOMIC_RELAXED);
+
+    char *bufs = (char *)mem + SLAB_HEADER;
+    size_t i = 1;
+    for (; i < pool->slabBuffers && tc->count < CACHE_SIZE / 2; ++i)
+        tc->bufs[tc->count++] = bufs + i * pool->bufSize;
+    if (i < pool->slabBuffers) {
+        for (size_t k = i; k + 1 < pool->slabBuffers; ++k)
+            ((struct FreeNode *)(bufs + k * pool->bufSize))->next = (struct FreeNode *)(bufs + (k + 1) * pool->bufSize);
+        pushChain(pool, (struct FreeNode *)(bufs + i * pool->bufSize),
+                  (struct FreeNode *)(bufs + (pool->slabBuffers - 1) * pool->bufSize));
+    }
+    return bufs;
+}
+
+// === Public API ===
+struct BufPool *poolCreate(size_t bufSize, size_t slabBuffers) {
+    struct BufPool *pool = calloc(1, sizeof(*pool));
+    if (!pool) return NULL;
+    if (bufSize < sizeof(struct FreeNode)) bufSize = sizeof(struct FreeNode);
+    pool->bufSize = (bufSize + 15) & ~(size_t)15;
+    pool->slabBuffers = slabBuffers ? slabBuffers : (256 * 1024) / pool->bufSize + 1;
+    pool->slabBytes = SLAB_HEADER + pool->slabBuffers * pool->bufSize;
+    if (pthread_key_create(&pool->key, cacheDestructor) != 0) {
+        free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void *poolAlloc(struct BufPool *pool) {
+    struct ThreadCache *tc = cacheOf(pool);
+    if (!tc) return NULL;
+    ++tc->allocs;
+    if (tc->count > 0) {
+        ++tc->cacheHits;
+        return tc->bufs[--tc->count];
+    }
+    // Refill half the cache, so the next few allocations hit.
+    struct FreeNode *node = popOne(pool);
+    if (node) {
+        ++tc->sharedHits;
+        struct FreeNode *more;
+        while (tc->count < CACHE_SIZE / 2 && (more = popOne(pool)))
+            tc->bufs[tc->count++] = more;
+        return node;
+    }
+    ++tc->misses;
+    return newSlab(pool, tc);
+}
+
+void poolFree(struct BufPool *pool, void *buf) {
+    if (!buf) return;
+    struct ThreadCache *tc = cacheOf(pool);
+    if (!tc) {
+        struct FreeNode *node = buf;
+        pushChain(pool, node, node);
+        return;
+    }
+    if (tc->count == CACHE_SIZE) spill(tc, CACHE_SIZE / 2);
+    tc->bufs[tc->count++] = buf;
+}
+
+void poolFlush(struct BufPool *pool) {
+    struct ThreadCache *tc = pthread_getspecific(pool->key);
+    if (tc) flushCache(tc);
+}
+
+void poolStats(struct BufPool *pool, struct PoolStats *out) {
+    out->allocs = __atomic_load_n(&pool->allocs, __ATOMIC_RELAXED);
+    out->cacheHits = __atomic_load_n(&pool->cacheHits, __ATOMIC_RELAXED);
+    out->sharedHits = __atomic_load_n(&pool->sharedHits, __ATOMIC_RELAXED);
+    out->misses = __atomic_load_n(&pool->misses, __ATOMIC_RELAXED);
+    out->slabs = __atomic_load_n(&pool->numSlabs, __ATOMIC_RELAXED);
+    out->bytesHeld = out->slabs * pool->slabBytes;
+    out->bufSize = pool->bufSize;
+}
+
+void poolDestroy(struct BufPool *pool) {
+    struct ThreadCache *tc = pthread_getspecific(pool->key);
+    if (tc) {
+        pthread_setspecific(pool->key, NULL);
+        free(tc);
+    }
+    pthread_key_delete(pool->key);
+    for (struct Slab *s = pool->slabs, *next; s; s = next) {
+        next = s->next;
+        free(s);
+    }
+    free(pool);
+}
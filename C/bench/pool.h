@@ -0,0 +1,58 @@
+#ifndef BENCH_POOL_H
+#define BENCH_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Pool of fixed-size buffers (STR_LEN + 1 strings, 2 KB records) for code
+// that allocates and frees the same size over and over.
+//
+// Every thread keeps a small cache of free buffers and allocates from it
+// without any synchronisation. An empty cache refills from a shared
+// lock-free stack (a Treiber stack, with a generation tag in the top 16
+// bits of the head against ABA); a full one spills half of itself back
+// in one CAS. Only when the shared stack is empty too does the pool take
+// a new slab of buffers from malloc. Buffers go back to the system only
+// in poolDestroy.
+//
+//   struct BufPool *pool = poolCreate(2049, 0);
+//   char *s = poolAlloc(pool);
+//   ...
+//   poolFree(pool, s);
+//   poolDestroy(pool);
+//
+// Buffers are 16-byte aligned, like malloc's. A buffer may be freed by a
+// different thread than the one that allocated it.
+
+struct BufPool;
+
+struct PoolStats {
+    uint64_t allocs;
+    uint64_t cacheHits;      // served from the calling thread's cache
+    uint64_t sharedHits;     // refilled from the shared stack
+    uint64_t misses;         // needed a new slab
+    uint64_t slabs;
+    size_t bytesHeld;        // slab memory owned by the pool
+    size_t bufSize;
+};
+
+// `slabBuffers` buffers are carved from each malloc (0: about 256 KB
+// worth). Returns NULL when out of memory.
+struct BufPool *poolCreate(size_t bufSize, size_t slabBuffers);
+
+void *poolAlloc(struct BufPool *pool);
+void poolFree(struct BufPool *pool, void *buf);
+
+// Moves the calling thread's cached buffers and counts to the shared
+// side. Threads do this on exit; call it before reading stats that
+// should include this thread.
+void poolFlush(struct BufPool *pool);
+
+// Counts folded in so far (see poolFlush).
+void poolStats(struct BufPool *pool, struct PoolStats *out);
+
+// Frees every slab. All buffers must have been returned, and no other
+// thread may use the pool any more.
+void poolDestroy(struct BufPool *pool);
+
+#endif // BENCH_POOL_H
@@ -0,0 +1,220 @@
+#include "roofline.h"
+#include "tsc.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+// Each probe repeats its pass until at least this many ticks have gone
+// by, and the best of ROOF_TRIALS such measurements is kept.
+#define ROOF_TRIALS 3
+#define ROOF_MIN_NS 20000000.0
+
+#define DRAM_MIN_BYTES ((size_t)64 << 20)
+#define DRAM_MAX_BYTES ((size_t)1 << 30)
+
+// === Cache sizes ===
+static size_t cacheSize(int level) {
+    static const size_t fallback[3] = {32 << 10, 1 << 20, 8 << 20};
+    long v = -1;
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+    v = sysconf(level == 0 ? _SC_LEVEL1_DCACHE_SIZE
+              : level == 1 ? _SC_LEVEL2_CACHE_SIZE
+                           : _SC_LEVEL3_CACHE_SIZE);
+#endif
+    return v > 0 ? (size_t)v : fallback[level];
+}
+
+// === Probes ===
+// AVX2 when the CPU has it, so the probes are limited by the memory
+// system and not by the width of the loop; 64-bit words otherwise.
+// `n` is in bytes and a multiple of 128.
+__attribute__((target("avx2")))
+static uint64_t readAvx2(const char *src, size_t n) {
+    __m256i a0 = _mm256_setzero_si256(), a1 = a0, a2 = a0, a3 = a0;
+    for (size_t i = 0; i < n; i += 128) {
+        a0 = _mm256_xor_si256(a0, _mm256_load_si256((const __m256i *)(src + i)));
+        a1 = _mm256_xor_si256(a1, _mm256_load_si256((const __m256i *)(src + i + 32)));
+        a2 = _mm256_xor_si256(a2, _mm256_load_si256((const __m256i *)(src + i + 64)));
+        a3 = _mm256_xor_si256(a3, _mm256_load_si256((const __m256i *)(src + i + 96)));
+    }
+    __m256i a = _mm256_xor_si256(_mm256_xor_si256(a0, a1), _mm256_xor_si256(a2, a3));
+    return (uint64_t)_mm256_extract_epi64(a, 0) ^ (uint64_t)_mm256_extract_epi64(a, 2);
+}
+
+__attribute__((target("avx2")))
+static void copyAvx2(char *dst, const char *src, size_t n) {
+    for (size_t i = 0; i < n; i += 64) {
+        __m256i v0 = _mm256_load_si256((const __m256i *)(src + i));
+        __m256i v1 = _mm256_load_si256((const __m256i *)(src + i + 32));
+        _mm256_store_si256((__m256i *)(dst + i), v0);
+        _mm256_store_si256((__m256i *)(dst + i + 32), v1);
+    }
+}
+
+__attribute__((target("avx2")))
+static void rmwAvx2(char *buf, size_t n) {
+    const __m256i k = _mm256_set1_epi8(0x20);
+    for (size_t i = 0; i < n; i += 64) {
+        __m256i v0 = _mm256_load_si256((const __m256i *)(buf + i));
+        __m256i v1 = _mm256_load_si256((const __m256i *)(buf + i + 32));
+        _mm256_store_si256((__m256i *)(buf + i), _mm256_xor_si256(v0, k));
+        _mm256_store_si256((__m256i *)(buf + i + 32), _mm256_xor_si256(v1, k));
+    }
+}
+
+static uint64_t readScalar(const char *src, size_t n) {
+    const uint64_t *p = (const uint64_t *)src;
+    uint64_t a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+    for (size_t i = 0; i < n / 8; i += 4) {
+        a0 ^= p[i]; a1 ^= p[i + 1]; a2 ^= p[i + 2]; a3 ^= p[i + 3];
+    }
+    return a0 ^ a1 ^ a2 ^ a3;
+}
+
+static void rmwScalar(char *buf, size_t n) {
+    uint64_t *p = (uint64_t *)buf;
+    for (size_t i = 0; i < n / 8; ++i)
+        p[i] ^= 0x2020202020202020ULL;
+}
+
+enum { PROBE_READ, PROBE_COPY, PROBE_RMW };
+
+static volatile uint64_t probeSink;
+
+static void probePass(int kind, int avx2, char *a, char *b, size_t n) {
+    switch (kind) {
+    case PROBE_READ:
+        probeSink ^= avx2 ? readAvx2(a, n) : readScalar(a, n);
+        break;
+    case PROBE_COPY:
+        if (avx2) copyAvx2(b, a, n);
+        else memcpy(b, a, n);
+        break;
+    default:
+        if (avx2) rmwAvx2(a, n);
+        else rmwScalar(a, n);
+        break;
+    }
+}
+
+// GB/s of traffic for one probe over a `bytes` working set. Copy splits
+// it into a source and a destination half.
+static double probe(int kind, int avx2, char *buf, size_t bytes, double ticksPerNs) {
+    size_t n = kind == PROBE_COPY ? bytes / 2 : bytes;
+    n &= ~(size_t)127;
+    char *a = buf, *b = buf + n;
+    double traffic = kind == PROBE_READ ? (double)n : 2.0 * (double)n;
+
+    probePass(kind, avx2, a, b, n);   // fault in and warm up
+    double best = 0.0;
+    for (int t = 0; t < ROOF_TRIALS; ++t) {
+        long passes = 0;
+        uint64_t t0 = tscBegin(), t1;
+        do {
+            probePass(kind, avx2, a, b, n);
+            ++passes;
+            t1 = tscEnd();
+        } while ((double)(t1 - t0) < ROOF_MIN_NS * ticksPerNs);
+        double gbs = traffic * (double)passes / ((double)(t1 - t0) / ticksPerNs);
+        if (gbs > best) best = gbs;
+    }
+    return best;
+}
+
+// Eight independent byte-add chains keep every vector ALU port busy; the
+// result is the compute ceiling in byte lanes per tick.
+__attribute__((target("avx2")))
+static double peakAvx2(void) {
+    const long ITER = 4000000;
+    __m256i a0 = _mm256_set1_epi8(1), a1 = a0, a2 = a0, a3 = a0, a4 = a0, a5 = a0, a6 = a0, a7 = a0;
+    const __m256i k = _mm256_set1_epi8(3);
+    uint64_t t0 = tscBegin();
+    for (long i = 0; i < ITER; ++i) {
+        a0 = _mm256_add_epi8(a0, k); a1 = _mm256_add_epi8(a1, k);
+        a2 = _mm256_add_epi8(a2, k); a3 = _mm256_add_epi8(a3, k);
+        a4 = _mm256_add_epi8(a4, k); a5 = _mm256_add_epi8(a5, k);
+        a6 = _mm256_add_epi8(a6, k); a7 = _mm256_add_epi8(a7, k);
+        __asm__ volatile("" : "+x"(a0), "+x"(a1), "+x"(a2), "+x"(a3),
+                              "+x"(a4), "+x"(a5), "+x"(a6), "+x"(a7));
+    }
+    uint64_t t1 = tscEnd();
+    __m256i a = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(a0, a1), _mm256_xor_si256(a2, a3)),
+                                 _mm256_xor_si256(_mm256_xor_si256(a4, a5), _mm256_xor_si256(a6, a7)));
+    probeSink ^= (uint64_t)_mm256_extract_epi64(a, 0);
+    return (double)ITER * 8 * 32 / (double)(t1 - t0);
+}
+
+static double peakScalar(void) {
+    const long ITER = 4000000;
+    uint64_t a0 = 1, a1 = 2, a2 = 3, a3 = 4;
+    uint64_t t0 = tscBegin();
+    for (long i = 0; i < ITER; ++i) {
+        a0 += 3; a1 += 3; a2 += 3; a3 += 3;
+        __asm__ volatile("" : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3));
+    }
+    uint64_t t1 = tscEnd();
+    probeSink ^= a0 ^ a1 ^ a2 ^ a3;
+    return (double)ITER * 4 * 8 / (double)(t1 - t0);
+}
+
+// === Public API ===
+void rooflineMeasure(struct Roofline *roof) {
+    memset(roof, 0, sizeof(*roof));
+    roof->ticksPerNs = tscTicksPerNs();
+    for (int l = 0; l < 3; ++l)
+        roof->cacheBytes[l] = cacheSize(l);
+
+    // Half of each level leaves room for the stack, code and page tables.
+    roof->probeBytes[ROOF_L1] = roof->cacheBytes[0] / 2;
+    roof->probeBytes[ROOF_L2] = roof->cacheBytes[1] / 2;
+    roof->probeBytes[ROOF_L3] = roof->cacheBytes[2] / 2;
+    size_t dram = roof->cacheBytes[2] * 4;
+    roof->probeBytes[ROOF_DRAM] = dram < DRAM_MIN_BYTES ? DRAM_MIN_BYTES
+                                : dram > DRAM_MAX_BYTES ? DRAM_MAX_BYTES : dram;
+
+    __builtin_cpu_init();
+    int avx2 = __builtin_cpu_supports("avx2");
+    for (int l = 0; l < ROOF_LEVELS; ++l) {
+        size_t bytes = roof->probeBytes[l];
+        char *buf = aligned_alloc(64, (bytes + 63) & ~(size_t)63);
+        if (!buf) continue;
+        memset(buf, 0x41, bytes);
+        roof->readGBs[l] = probe(PROBE_READ, avx2, buf, bytes, roof->ticksPerNs);
+        roof->copyGBs[l] = probe(PROBE_COPY, avx2, buf, bytes, roof->ticksPerNs);
+        roof->rmwGBs[l] = probe(PROBE_RMW, avx2, buf, bytes, roof->ticksPerNs);
+        free(buf);
+    }
+    roof->peakBytesPerCycle = avx2 ? peakAvx2() : peakScalar();
+}
+
+int rooflineLevel(const struct Roofline *roof, size_t bytes) {
+    for (int l = 0; l < 3; ++l)
+        if (bytes <= roof->cacheBytes[l]) return l;
+    return ROOF_DRAM;
+}
+
+const char *rooflineLevelName(int level) {
+    static const char *names[ROOF_LEVELS] = {"L1", "L2", "L3", "DRAM"};
+    return level >= 0 && level < ROOF_LEVELS ? names[level] : "?";
+}
+
+void rooflinePrint(FILE *out, const struct Roofline *roof) {
+    fprintf(out, "=== ROOFLINE (GB/s of traffic, bytes per TSC cycle) ===\n");
+    fprintf(out, "%-6s %-10s %-18s %-18s %-18s\n", "Level", "Set", "Read", "Copy", "Read-mod-write");
+    fprintf(out, "-----------------------------------------------------------------------\n");
+    for (int l = 0; l < ROOF_LEVELS; ++l) {
+        double perCycle = 1.0 / roof->ticksPerNs;
+        fprintf(out, "%-6s %-10zu %7.1f (%5.1f B/c) %7.1f (%5.1f B/c) %7.1f (%5.1f B/c)\n",
+                rooflineLevelName(l), roof->probeBytes[l],
+                roof->readGBs[l], roof->readGBs[l] * perCycle,
+                roof->copyGBs[l], roof->copyGBs[l] * perCycle,
+                roof->rmwGBs[l], roof->rmwGBs[l] * perCycle);
+    }
+    fprintf(out, "Peak compute: %.1f byte-ops per cycle\n\n", roof->peakBytesPerCycle);
+}
@@ -0,0 +1,38 @@
+#ifndef BENCH_ROOFLINE_H
+#define BENCH_ROOFLINE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+// Measured roofline: STREAM-style bandwidth probes at a working set
+// inside each cache level and in DRAM, plus a peak-ops probe, so a
+// kernel's throughput can be read as a fraction of what the machine can
+// do at the level its data lives in.
+//
+// Bandwidth counts every byte read plus every byte written, as STREAM
+// does: copying N bytes moves 2N, an in-place read-modify-write of N
+// bytes moves 2N, a read-only pass moves N. "Per cycle" figures are per
+// TSC tick (the nominal clock), see tsc.h.
+
+enum { ROOF_L1, ROOF_L2, ROOF_L3, ROOF_DRAM, ROOF_LEVELS };
+
+struct Roofline {
+    size_t cacheBytes[3];          // L1d, L2, L3 sizes
+    size_t probeBytes[ROOF_LEVELS];
+    double readGBs[ROOF_LEVELS];
+    double copyGBs[ROOF_LEVELS];
+    double rmwGBs[ROOF_LEVELS];
+    double peakBytesPerCycle;      // byte lanes of vector adds retired per tick
+    double ticksPerNs;
+};
+
+// Runs every probe; takes a second or two, most of it in DRAM.
+void rooflineMeasure(struct Roofline *roof);
+
+// Cache level a working set of `bytes` fits in.
+int rooflineLevel(const struct Roofline *roof, size_t bytes);
+const char *rooflineLevelName(int level);
+
+void rooflinePrint(FILE *out, const struct Roofline *roof);
+
+#endif // BENCH_ROOFLINE_H
@@ -0,0 +1,487 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "service.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <limits.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "branchless.h"
+
+#ifdef __linux__
+
+#define READ_CHUNK  65536
+#define MAX_EVENTS  64
+
+struct Conn {
+    int fd;
+    int dead;
+    int wantOut;             // EPOLLOUT registered
+    char *in;
+    size_t inLen, inOff, inCap;     // inOff: first byte not yet parsed
+    char *out;
+    size_t outLen, outOff, outCap;  // replies the socket did not take
+    struct Conn *next;
+};
+
+// Payloads of one op in the current batch, back to back.
+struct Arena {
+    char *buf;
+    size_t len, cap;
+};
+
+struct Entry {
+    struct Conn *conn;
+    struct SvcHeader reply;
+    int arena;
+    size_t at;
+};
+
+struct Server {
+    int ep, listenFd, maxBatch;
+    struct Conn *conns, *cursor;    // cursor: where the next batch starts
+    struct Entry *batch;
+    struct iovec *iov;
+    struct Arena arenas[SVC_OPS];   // [SVC_STATS] holds stats replies
+    struct SvcStats stats;
+};
+
+static const upper_func_t kernels[SVC_OPS] = {
+    NULL, upperCase, lowerCase, utf8UpperCase
+};
+
+static int reserve(char **buf, size_t *cap, size_t need) {
+    if (need <= *cap) return 0;
+    size_t size = *cap ? *cap : READ_CHUNK;
+    while (size < need) size *= 2;
+    char *p = realloc(*buf, size);
+    if (!p) return -1;
+    *buf = p;
+    *cap = size;
+    return 0;
+}
+
+static void watch(struct Server *s, struct Conn *c, int wantOut) {
+    if (c->wantOut == wantOut) return;
+    struct epoll_event ev;
+    ev.events = EPOLLIN | (wantOut ? EPOLLOUT : 0);
+    ev.data.ptr = c;
+    epoll_ctl(s->ep, EPOLL_CTL_MOD, c->fd, &ev);
+    c->wantOut = wantOut;
+}
+
+// === Connections ===
+static void acceptAll(struct Server *s) {
+    for (;;) {
+        int fd = accept4(s->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;              // EAGAIN, or out of descriptors for now
+        }
+        struct Conn *c = calloc(1, sizeof(*c));
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = c;
+        if (!c || epoll_ctl(s->ep, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            free(c);
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->next = s->conns;
+        s->conns = c;
+    }
+}
+
+static void readConn(struct Conn *c) {
+    for (;;) {
+        if (reserve(&c->in, &c->inCap, c->inLen + READ_CHUNK) != 0) {
+            c->dead = 1;
+            return;
+        }
+        ssize_t n = read(c->fd, c->in + c->inLen, c->inCap - c->inLen);
+        if (n > 0) {
+            c->inLen += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) c->dead = 1;
+        return;
+    }
+}
+
+static void flushConn(struct Server *s, struct Conn *c) {
+    while (c->outOff < c->outLen) {
+        ssize_t n = send(c->fd, c->out + c->outOff, c->outLen - c->outOff, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) c->dead = 1;
+            return;
+        }
+        c->outOff += (size_t)n;
+    }
+    c->outLen = c->outOff = 0;
+    watch(s, c, 0);
+}
+
+// Copies iov[0..count) to the output buffer and waits for EPOLLOUT.
+static void queueOut(struct Server *s, struct Conn *c, const struct iovec *iov, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) total += iov[i].iov_len;
+    if (reserve(&c->out, &c->outCap, c->outLen + total) != 0) {
+        c->dead = 1;
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        memcpy(c->out + c->outLen, iov[i].iov_base, iov[i].iov_len);
+        c->outLen += iov[i].iov_len;
+    }
+    s->stats.queued++;
+    watch(s, c, 1);
+}
+
+// Writes iov[0..count) with as few sendmsg calls as the socket allows;
+// whatever it does not take goes to the output buffer. Replies already
+// waiting there go first, so this one queues behind them.
+static void sendReplies(struct Server *s, struct Conn *c, struct iovec *iov, size_t count) {
+    size_t i = 0;
+    while (i < count && c->outOff == c->outLen) {
+        size_t end = count - i < IOV_MAX ? count : i + IOV_MAX;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov + i;
+        msg.msg_iovlen = end - i;
+        ssize_t n = sendmsg(c->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                c->dead = 1;
+                return;
+            }
+            n = 0;
+        }
+        size_t left = (size_t)n;
+        while (i < end && left >= iov[i].iov_len) left -= iov[i++].iov_len;
+        if (i < end) {
+            iov[i].iov_base = (char *)iov[i].iov_base + left;
+            iov[i].iov_len -= left;
+            break;
+        }
+    }
+    if (i < count) queueOut(s, c, iov + i, count - i);
+}
+
+// === Batches ===
+static int arenaAppend(struct Arena *a, const void *p, size_t len, size_t *at) {
+    if (reserve(&a->buf, &a->cap, a->len + len) != 0) return -1;
+    memcpy(a->buf + a->len, p, len);
+    *at = a->len;
+    a->len += len;
+    return 0;
+}
+
+// Takes complete requests, connection by connection starting at the
+// cursor, until the batch is full. Returns the batch size.
+static int collect(struct Server *s) {
+    int count = 0;
+    for (int op = 0; op < SVC_OPS; ++op) s->arenas[op].len = 0;
+    if (!s->cursor) s->cursor = s->conns;
+    struct Conn *c = s->cursor;
+    if (!c) return 0;
+    do {
+        while (!c->dead && count < s->maxBatch) {
+            struct SvcHeader h;
+            size_t avail = c->inLen - c->inOff;
+            if (avail < sizeof(h)) break;
+            memcpy(&h, c->in + c->inOff, sizeof(h));
+            if (h.len > SVC_MAX_PAYLOAD) {
+                c->dead = 1;
+                break;
+            }
+            if (avail < sizeof(h) + h.len) break;
+
+            struct Entry *e = &s->batch[count];
+            const char *payload = c->in + c->inOff + sizeof(h);
+            e->conn = c;
+            e->reply = h;
+            e->reply.status = SVC_OK;
+            e->arena = h.op < SVC_OPS ? h.op : SVC_STATS;
+            int failed;
+            if (h.op == SVC_STATS) {
+                e->reply.len = sizeof(s->stats);
+                failed = arenaAppend(&s->arenas[SVC_STATS], &s->stats, sizeof(s->stats), &e->at);
+            } else if (h.op < SVC_OPS) {
+                failed = arenaAppend(&s->arenas[h.op], payload, h.len, &e->at);
+            } else {
+                e->reply.status = SVC_BAD_OP;
+                e->reply.len = 0;
+                e->at = 0;
+                failed = 0;
+            }
+            if (failed) {
+                c->dead = 1;
+                break;
+            }
+            c->inOff += sizeof(h) + h.len;
+            ++count;
+        }
+        c = c->next ? c->next : s->conns;
+    } while (c != s->cursor && count < s->maxBatch);
+    s->cursor = c;
+    return count;
+}
+
+// The ASCII kernels map every byte on its own, so one call over an
+// arena is the same as one per payload. utf8UpperCase decodes sequences
+// and must not see two payloads as one: a lead byte at the end of one
+// would pair with the first byte of the next.
+static const int perRequest[SVC_OPS] = {0, 0, 0, 1};
+
+// The kernel calls, then the replies, grouped by connection (a
+// connection's entries are adjacent in the batch).
+static void runBatch(struct Server *s, int count) {
+    for (int op = 1; op < SVC_OPS; ++op) {
+        struct Arena *a = &s->arenas[op];
+        if (a->len == 0 || perRequest[op]) continue;
+        kernels[op](a->buf, a->len);
+        s->stats.passes++;
+        s->stats.bytes += a->len;
+    }
+    for (int i = 0; i < count; ++i) {
+        struct Entry *e = &s->batch[i];
+        if (!perRequest[e->arena] || e->reply.len == 0) continue;
+        kernels[e->arena](s->arenas[e->arena].buf + e->at, e->reply.len);
+        s->stats.passes++;
+        s->stats.bytes += e->reply.len;
+    }
+    s->stats.batches++;
+    s->stats.requests += (uint64_t)count;
+
+    for (int i = 0; i < count;) {
+        struct Conn *c = s->batch[i].conn;
+        size_t n = 0;
+        for (; i < count && s->batch[i].conn == c; ++i) {
+            struct Entry *e = &s->batch[i];
+            s->iov[n].iov_base = &e->reply;
+            s->iov[n++].iov_len = sizeof(e->reply);
+            if (e->reply.len) {
+                s->iov[n].iov_base = s->arenas[e->arena].buf + e->at;
+                s->iov[n++].iov_len = e->reply.len;
+            }
+        }
+        if (!c->dead) sendReplies(s, c, s->iov, n);
+    }
+}
+
+static void compactAndReap(struct Server *s) {
+    struct Conn **link = &s->conns;
+    while (*link) {
+        struct Conn *c = *link;
+        if (c->dead) {
+            *link = c->next;
+            if (s->cursor == c) s->cursor = c->next;
+            epoll_ctl(s->ep, EPOLL_CTL_DEL, c->fd, NULL);
+            close(c->fd);
+            free(c->in);
+            free(c->out);
+            free(c);
+            continue;
+        }
+        if (c->inOff > 0) {
+            memmove(c->in, c->in + c->inOff, c->inLen - c->inOff);
+            c->inLen -= c->inOff;
+            c->inOff = 0;
+        }
+        link = &c->next;
+    }
+}
+
+// === Server ===
+int svcListen(const char *path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 128) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+int svcServe(int listenFd, int maxBatch, volatile sig_atomic_t *stop) {
+    struct Server s;
+    memset(&s, 0, sizeof(s));
+    s.listenFd = listenFd;
+    s.maxBatch = maxBatch > 0 ? maxBatch : 1;
+    s.ep = epoll_create1(EPOLL_CLOEXEC);
+    s.batch = malloc((size_t)s.maxBatch * sizeof(*s.batch));
+    s.iov = malloc(2 * (size_t)s.maxBatch * sizeof(*s.iov));
+    int rc = -1;
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (s.ep < 0 || !s.batch || !s.iov || epoll_ctl(s.ep, EPOLL_CTL_ADD, listenFd, &ev) != 0)
+        goto out;
+
+    struct epoll_event events[MAX_EVENTS];
+    while (!(stop && *stop)) {
+        int n = epoll_wait(s.ep, events, MAX_EVENTS, 100);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            goto out;
+        }
+        for (int i = 0; i < n; ++i) {
+            struct Conn *c = events[i].data.ptr;
+            if (!c) {
+                acceptAll(&s);
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) readConn(c);
+            if (events[i].events & EPOLLOUT) flushConn(&s, c);
+        }
+        int count;
+        while ((count = collect(&s)) > 0)
+            runBatch(&s, count);
+        compactAndReap(&s);
+    }
+    rc = 0;
+
+out:;
+    int saved = errno;
+    for (struct Conn *c = s.conns; c; c = c->next) c->dead = 1;
+    compactAndReap(&s);
+    for (int op = 0; op < SVC_OPS; ++op) free(s.arenas[op].buf);
+    free(s.batch);
+    free(s.iov);
+    if (s.ep >= 0) close(s.ep);
+    errno = saved;
+    return rc;
+}
+
+// === Client side ===
+int svcConnect(const char *path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+int svcSend(int fd, uint32_t id, int op, const char *payload, uint32_t len) {
+    struct SvcHeader h = {id, (uint16_t)op, 0, len};
+    struct iovec iov[2] = {{&h, sizeof(h)}, {(void *)payload, len}};
+    int at = 0;
+    while (at < 2) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov + at;
+        msg.msg_iovlen = 2 - at;
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        while (at < 2 && (size_t)n >= iov[at].iov_len) n -= (ssize_t)iov[at++].iov_len;
+        if (at < 2) {
+            iov[at].iov_base = (char *)iov[at].iov_base + n;
+            iov[at].iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+static int readFull(int fd, void *buf, size_t size) {
+    size_t got = 0;
+    while (got < size) {
+        ssize_t n = read(fd, (char *)buf + got, size - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        got += (size_t)n;
+    }
+    return 0;
+}
+
+int svcRecv(int fd, struct SvcHeader *reply, char *buf, size_t cap) {
+    if (readFull(fd, reply, sizeof(*reply)) != 0) return -1;
+    if (reply->len > cap) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    return readFull(fd, buf, reply->len);
+}
+
+#else // !__linux__
+
+int svcListen(const char *path) {
+    (void)path;
+    errno = ENOSYS;
+    return -1;
+}
+
+int svcServe(int listenFd, int maxBatch, volatile sig_atomic_t *stop) {
+    (void)listenFd;
+    (void)maxBatch;
+    (void)stop;
+    errno = ENOSYS;
+    return -1;
+}
+
+int svcConnect(const char *path) {
+    (void)path;
+    errno = ENOSYS;
+    return -1;
+}
+
+int svcSend(int fd, uint32_t id, int op, const char *payload, uint32_t len) {
+    (void)fd;
+    (void)id;
+    (void)op;
+    (void)payload;
+    (void)len;
+    errno = ENOSYS;
+    return -1;
+}
+
+int svcRecv(int fd, struct SvcHeader *reply, char *buf, size_t cap) {
+    (void)fd;
+    (void)reply;
+    (void)buf;
+    (void)cap;
+    errno = ENOSYS;
+    return -1;
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef BENCH_SERVICE_H
+#define BENCH_SERVICE_H
+
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Case-mapping service over a Unix domain socket, so other processes can
+// use the kernels without linking the library.
+//
+// Every message, in both directions, is a SvcHeader followed by `len`
+// payload bytes (native byte order; both ends are on the same machine).
+// A reply carries the request's id and op, a status and the mapped text.
+// Replies on one connection come back in request order.
+//
+// The server is one epoll loop. Whatever complete requests are buffered
+// after a round of reads form a batch of up to `maxBatch` requests; their
+// payloads are copied into one arena per op, each ASCII arena gets a
+// single kernel call (SVC_FOLD, which decodes UTF-8, one per request, so
+// a sequence cut at the end of one payload cannot change the next), and
+// the replies are sent straight out of the arenas with
+// sendmsg scatter lists (header, text, header, text, ...). Only a reply
+// the socket will not take right away is copied, into that connection's
+// output buffer.
+
+enum {
+    SVC_STATS = 0,           // no payload; replies with a struct SvcStats
+    SVC_UPPER = 1,           // upperCase
+    SVC_LOWER = 2,           // lowerCase
+    SVC_FOLD  = 3,           // utf8UpperCase: ASCII, Latin, Greek and
+                             // Cyrillic (ascii_casecmp folds ASCII only)
+    SVC_OPS
+};
+
+enum {
+    SVC_OK = 0,
+    SVC_BAD_OP = 1           // unknown op; the reply has no payload
+};
+
+// Larger requests are a protocol error and close the connection.
+#define SVC_MAX_PAYLOAD (1u << 20)
+
+struct SvcHeader {
+    uint32_t id;             // chosen by the client, echoed back
+    uint16_t op;
+    uint16_t status;         // replies only
+    uint32_t len;
+};
+
+struct SvcStats {
+    uint64_t requests;
+    uint64_t batches;
+    uint64_t passes;         // kernel calls: one per ASCII op per batch,
+                             // one per SVC_FOLD request
+    uint64_t bytes;          // payload bytes mapped
+    uint64_t queued;         // replies (partly) copied to an output buffer
+};
+
+// Binds and listens on `path` (replacing a stale socket file). Returns
+// the listening socket, or -1 with errno set.
+int svcListen(const char *path);
+
+// Serves on a socket from svcListen until *stop becomes non-zero (checked
+// at least every 100 ms). Returns 0, or -1 with errno set.
+int svcServe(int listenFd, int maxBatch, volatile sig_atomic_t *stop);
+
+// === Client side ===
+// Blocking helpers. svcConnect returns the socket or -1. svcSend writes
+// one request; svcRecv reads one reply, its payload into buf (up to cap
+// bytes; a longer payload is an error). Both return 0, or -1 on error or
+// end of stream.
+int svcConnect(const char *path);
+int svcSend(int fd, uint32_t id, int op, const char *payload, uint32_t len);
+int svcRecv(int fd, struct SvcHeader *reply, char *buf, size_t cap);
+
+#endif // BENCH_SERVICE_H
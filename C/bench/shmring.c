@@ -0,0 +1,315 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "shmring.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define RING_MAGIC 0x474E4952u     // "RING"
+#define STOP_LEN   UINT32_MAX
+#define SPINS      256
+
+// Slot header; the data follows it, and the stride keeps every slot on
+// its own cache lines.
+struct RingSlot {
+    uint32_t seq;
+    uint32_t waiters;
+    uint32_t len;
+    uint32_t pad;
+};
+
+// Offsets only, no pointers: every process maps the ring at its own
+// address.
+struct ShmRing {
+    uint32_t magic, slots, mask, dataBytes, stride, mode;
+    uint64_t mapSize;
+    uint32_t head __attribute__((aligned(64)));      // next ticket to hand out
+    uint32_t tail __attribute__((aligned(64)));      // worker's next ticket
+    uint64_t processed, sweeps, workerSleeps;
+    uint64_t producerSleeps __attribute__((aligned(64)));
+};
+
+#define HEADER_BYTES ((sizeof(struct ShmRing) + 63) / 64 * 64)
+
+static struct RingSlot *slotIn(struct ShmRing *r, uint32_t mask, uint32_t stride, uint32_t ticket) {
+    return (struct RingSlot *)((char *)r + HEADER_BYTES + (size_t)(ticket & mask) * stride);
+}
+
+static struct RingSlot *slotAt(struct ShmRing *r, uint32_t ticket) {
+    return slotIn(r, r->mask, r->stride, ticket);
+}
+
+uint32_t ringSlotBytes(const struct ShmRing *r) {
+    return r->dataBytes;
+}
+
+char *ringData(struct ShmRing *r, uint32_t ticket) {
+    return (char *)(slotAt(r, ticket) + 1);
+}
+
+void ringStats(const struct ShmRing *r, struct RingStats *out) {
+    out->processed = __atomic_load_n(&r->processed, __ATOMIC_RELAXED);
+    out->sweeps = __atomic_load_n(&r->sweeps, __ATOMIC_RELAXED);
+    out->workerSleeps = __atomic_load_n(&r->workerSleeps, __ATOMIC_RELAXED);
+    out->producerSleeps = __atomic_load_n(&r->producerSleeps, __ATOMIC_RELAXED);
+}
+
+#ifdef __linux__
+
+static inline void cpuRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Spinning only helps when the other side is running on another CPU.
+static int spinLimit(void) {
+    static int limit = -1;
+    if (limit < 0) limit = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SPINS : 0;
+    return limit;
+}
+
+// === Sequence words ===
+// The waiter counter and the sequence word are both accessed sequentially
+// consistent, so a setter either sees the waiter or the waiter sees the
+// new value before it sleeps.
+static void waitSeq(struct RingSlot *s, uint32_t target, uint64_t *sleeps) {
+    for (int i = 0, n = spinLimit(); i < n; ++i) {
+        if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) == target) return;
+        cpuRelax();
+    }
+    for (;;) {
+        __atomic_add_fetch(&s->waiters, 1, __ATOMIC_SEQ_CST);
+        uint32_t seen = __atomic_load_n(&s->seq, __ATOMIC_SEQ_CST);
+        if (seen != target) {
+            syscall(SYS_futex, &s->seq, FUTEX_WAIT, seen, NULL, NULL, 0);
+            __atomic_add_fetch(sleeps, 1, __ATOMIC_RELAXED);
+        }
+        __atomic_sub_fetch(&s->waiters, 1, __ATOMIC_RELAXED);
+        if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) == target) return;
+    }
+}
+
+static void setSeq(struct RingSlot *s, uint32_t value) {
+    __atomic_store_n(&s->seq, value, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&s->waiters, __ATOMIC_SEQ_CST))
+        syscall(SYS_futex, &s->seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+// === Mapping ===
+struct ShmRing *ringCreate(uint32_t slots, uint32_t dataBytes, int mode, int *fd) {
+    uint32_t n = 4;
+    while (n < slots && n < (1u << 30)) n *= 2;
+    size_t stride = (sizeof(struct RingSlot) + (size_t)dataBytes + 63) / 64 * 64;
+    size_t size = HEADER_BYTES + (size_t)n * stride;
+
+    int memfd = memfd_create("branchless-ring", MFD_CLOEXEC);
+    if (memfd < 0) return NULL;
+    void *p = MAP_FAILED;
+    if (ftruncate(memfd, (off_t)size) == 0)
+        p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (p == MAP_FAILED) {
+        int saved = errno;
+        close(memfd);
+        errno = saved;
+        return NULL;
+    }
+
+    struct ShmRing *r = p;           // the memfd starts out zeroed
+    r->magic = RING_MAGIC;
+    r->slots = n;
+    r->mask = n - 1;
+    r->dataBytes = dataBytes;
+    r->stride = (uint32_t)stride;
+    r->mode = (uint32_t)mode;
+    r->mapSize = size;
+    for (uint32_t i = 0; i < n; ++i) slotAt(r, i)->seq = i;
+    if (fd) *fd = memfd;
+    else close(memfd);
+    return r;
+}
+
+// The header is writable by every process that maps the ring, so an
+// attacher checks that its geometry describes exactly the mapping it got.
+static int geometryOk(const struct ShmRing *r, size_t size) {
+    uint32_t slots = r->slots, stride = r->stride;
+    return slots >= 4 && (slots & (slots - 1)) == 0 && r->mask == slots - 1 &&
+           stride % 64 == 0 && stride >= sizeof(struct RingSlot) + (size_t)r->dataBytes &&
+           HEADER_BYTES + (size_t)slots * stride == size;
+}
+
+struct ShmRing *ringAttach(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) return NULL;
+    if ((size_t)st.st_size < HEADER_BYTES) {
+        errno = EINVAL;
+        return NULL;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return NULL;
+    struct ShmRing *r = p;
+    if (r->magic != RING_MAGIC || r->mapSize != (uint64_t)st.st_size ||
+        !geometryOk(r, (size_t)st.st_size)) {
+        munmap(p, (size_t)st.st_size);
+        errno = EINVAL;
+        return NULL;
+    }
+    return r;
+}
+
+void ringUnmap(struct ShmRing *r) {
+    if (r) munmap(r, (size_t)r->mapSize);
+}
+
+// === Producer side ===
+uint32_t ringClaim(struct ShmRing *r) {
+    uint32_t ticket;
+    if (r->mode == RING_SPSC) {
+        ticket = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+        __atomic_store_n(&r->head, ticket + 1, __ATOMIC_RELAXED);
+    } else {
+        ticket = __atomic_fetch_add(&r->head, 1, __ATOMIC_RELAXED);
+    }
+    waitSeq(slotAt(r, ticket), ticket, &r->producerSleeps);
+    return ticket;
+}
+
+static void submit(struct ShmRing *r, uint32_t ticket, uint32_t len) {
+    struct RingSlot *s = slotAt(r, ticket);
+    s->len = len;
+    setSeq(s, ticket + 1);
+}
+
+int ringSubmit(struct ShmRing *r, uint32_t ticket, uint32_t len) {
+    if (len > r->dataBytes) {
+        errno = EINVAL;
+        return -1;
+    }
+    submit(r, ticket, len);
+    return 0;
+}
+
+uint32_t ringWait(struct ShmRing *r, uint32_t ticket) {
+    struct RingSlot *s = slotAt(r, ticket);
+    waitSeq(s, ticket + 2, &r->producerSleeps);
+    return s->len;
+}
+
+void ringRelease(struct ShmRing *r, uint32_t ticket) {
+    setSeq(slotAt(r, ticket), ticket + r->slots);
+}
+
+// === Worker side ===
+// One sweep runs every slot that is already submitted, without touching
+// the futex path in between.
+//
+// Every length is written by some producer process, so it is read once
+// and clamped to the slot size before the kernel sees it. The geometry
+// (slot size, mask, stride) is read once at entry, as ringCreate wrote
+// it or ringAttach checked it, so a producer rewriting the header later
+// cannot move the slots either: a bad length maps at most its own slot.
+void ringServe(struct ShmRing *r, upper_func_t kernel) {
+    const uint32_t dataBytes = r->dataBytes, mask = r->mask, stride = r->stride;
+    uint32_t ticket = r->tail;
+    for (;;) {
+        struct RingSlot *s = slotIn(r, mask, stride, ticket);
+        waitSeq(s, ticket + 1, &r->workerSleeps);
+        __atomic_store_n(&r->sweeps, r->sweeps + 1, __ATOMIC_RELAXED);
+        do {
+            uint32_t len = __atomic_load_n(&s->len, __ATOMIC_RELAXED);
+            if (len == STOP_LEN) {
+                r->tail = ticket + 1;
+                setSeq(s, ticket + 2);
+                return;
+            }
+            if (len > dataBytes) len = dataBytes;
+            kernel((char *)(s + 1), len);
+            __atomic_store_n(&r->processed, r->processed + 1, __ATOMIC_RELAXED);
+            setSeq(s, ticket + 2);
+            s = slotIn(r, mask, stride, ++ticket);
+        } while (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) == ticket + 1);
+    }
+}
+
+void ringStop(struct ShmRing *r) {
+    uint32_t ticket = ringClaim(r);
+    submit(r, ticket, STOP_LEN);
+    ringWait(r, ticket);
+    ringRelease(r, ticket);
+}
+
+#else // !__linux__
+
+struct ShmRing *ringCreate(uint32_t slots, uint32_t dataBytes, int mode, int *fd) {
+    (void)slots;
+    (void)dataBytes;
+    (void)mode;
+    (void)fd;
+    errno = ENOSYS;
+    return NULL;
+}
+
+// The header is writable by every process that maps the ring, so an
+// attacher checks that its geometry describes exactly the mapping it got.
+static int geometryOk(const struct ShmRing *r, size_t size) {
+    uint32_t slots = r->slots, stride = r->stride;
+    return slots >= 4 && (slots & (slots - 1)) == 0 && r->mask == slots - 1 &&
+           stride % 64 == 0 && stride >= sizeof(struct RingSlot) + (size_t)r->dataBytes &&
+           HEADER_BYTES + (size_t)slots * stride == size;
+}
+
+struct ShmRing *ringAttach(int fd) {
+    (void)fd;
+    errno = ENOSYS;
+    return NULL;
+}
+
+void ringUnmap(struct ShmRing *r) {
+    (void)r;
+}
+
+uint32_t ringClaim(struct ShmRing *r) {
+    (void)r;
+    return 0;
+}
+
+int ringSubmit(struct ShmRing *r, uint32_t ticket, uint32_t len) {
+    (void)r;
+    (void)ticket;
+    (void)len;
+    errno = ENOSYS;
+    return -1;
+}
+
+uint32_t ringWait(struct ShmRing *r, uint32_t ticket) {
+    (void)r;
+    (void)ticket;
+    return 0;
+}
+
+void ringRelease(struct ShmRing *r, uint32_t ticket) {
+    (void)r;
+    (void)ticket;
+}
+
+void ringServe(struct ShmRing *r, upper_func_t kernel) {
+    (void)r;
+    (void)kernel;
+}
+
+void ringStop(struct ShmRing *r) {
+    (void)r;
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef BENCH_SHMRING_H
+#define BENCH_SHMRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "branchless.h"
+
+// Shared-memory request ring: the same job as bench/service.h without
+// the socket copies. The ring lives in a memfd mapped MAP_SHARED by the
+// producers and by one worker process. A producer claims a slot, writes
+// its string straight into it and submits; the worker runs the kernel on
+// the slot in place; the producer reads the result where it wrote the
+// input and releases the slot for the next lap.
+//
+// Every slot carries a sequence number that says whose turn it is, for
+// the lap that started at ticket t:
+//
+//   t        free, the claimant of ticket t may write
+//   t + 1    submitted, waiting for the worker
+//   t + 2    done, the result is in place
+//   t + N    released, free for ticket t + N (N = slot count)
+//
+// Waiters spin briefly, then sleep on the sequence word with a shared
+// (not process-private) futex; whoever changes the word wakes them only
+// if a waiter has announced itself, so the uncontended path makes no
+// system calls.
+//
+//   int fd;
+//   struct ShmRing *r = ringCreate(1024, 64, RING_MPSC, &fd);
+//   // worker process:  ringServe(r, upperCase);
+//   uint32_t t = ringClaim(r);
+//   memcpy(ringData(r, t), s, len);
+//   ringSubmit(r, t, len);
+//   ringWait(r, t);            // ringData(r, t) now holds the result
+//   ringRelease(r, t);
+
+enum {
+    RING_SPSC = 0,           // one producer thread: plain ticket counter
+    RING_MPSC = 1            // any number: tickets from an atomic add
+};
+
+struct ShmRing;
+
+struct RingStats {
+    uint64_t processed;      // slots the worker ran the kernel on
+    uint64_t sweeps;         // runs of consecutive submitted slots
+    uint64_t workerSleeps;   // futex waits by the worker
+    uint64_t producerSleeps; // futex waits by producers
+};
+
+// `slots` is rounded up to a power of two (at least 4); every slot holds
+// up to `dataBytes` bytes. Producers between them must never hold more
+// tickets than there are slots, or a claim can wait on a slot whose owner
+// is itself waiting to claim. The memfd is returned in *fd for processes
+// that do not inherit the mapping (see ringAttach). Returns NULL with
+// errno set on failure.
+struct ShmRing *ringCreate(uint32_t slots, uint32_t dataBytes, int mode, int *fd);
+// Fails with EINVAL unless the header's slot count, stride and slot size
+// describe exactly the memfd's size.
+struct ShmRing *ringAttach(int fd);
+void ringUnmap(struct ShmRing *r);
+
+uint32_t ringSlotBytes(const struct ShmRing *r);
+
+// === Producer side ===
+// ringSubmit returns 0, or -1 with errno EINVAL when len is larger than
+// ringSlotBytes; the slot then stays claimed and must still be submitted
+// (the worker takes tickets in order), with a valid length.
+uint32_t ringClaim(struct ShmRing *r);
+char *ringData(struct ShmRing *r, uint32_t ticket);
+int ringSubmit(struct ShmRing *r, uint32_t ticket, uint32_t len);
+uint32_t ringWait(struct ShmRing *r, uint32_t ticket);     // result length
+void ringRelease(struct ShmRing *r, uint32_t ticket);
+
+// === Worker side ===
+// Runs `kernel` on every submitted slot, in ticket order, until
+// ringStop. Only one worker per ring.
+void ringServe(struct ShmRing *r, upper_func_t kernel);
+
+// Queues a stop request behind everything already submitted and waits
+// for the worker to reach it.
+void ringStop(struct ShmRing *r);
+
+void ringStats(const struct ShmRing *r, struct RingStats *out);
+
+#endif // BENCH_SHMRING_H
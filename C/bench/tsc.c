@@ -0,0 +1,44 @@
+#include "tsc.h"
+
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+long long nowNs(void) {
+#ifdef _WIN32
+    LARGE_INTEGER t, freq;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (long long)((double)t.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+uint64_t tscOverhead(void) {
+    static uint64_t overhead = UINT64_MAX;
+    if (overhead != UINT64_MAX) return overhead;
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t t0 = tscBegin();
+        uint64_t t1 = tscEnd();
+        if (t1 - t0 < best) best = t1 - t0;
+    }
+    return overhead = best;
+}
+
+// 50 ms is long enough that the clock_gettime cost at both ends is noise.
+double tscTicksPerNs(void) {
+    static double ratio = 0.0;
+    if (ratio > 0.0) return ratio;
+    long long n0 = nowNs();
+    uint64_t t0 = tscBegin();
+    while (nowNs() - n0 < 50000000LL) {}
+    uint64_t t1 = tscEnd();
+    long long n1 = nowNs();
+    return ratio = (double)(t1 - t0) / (double)(n1 - n0);
+}
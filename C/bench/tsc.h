@@ -0,0 +1,50 @@
+#ifndef BENCH_TSC_H
+#define BENCH_TSC_H
+
+#include <stdint.h>
+#include <x86intrin.h>
+
+// Serialized time-stamp counter reads for timing a single call.
+//
+//   uint64_t t0 = tscBegin();
+//   func(str);
+//   uint64_t t1 = tscEnd();
+//   ticks = t1 - t0 - tscOverhead();
+//
+// tscBegin fences on both sides of rdtsc so earlier work has retired and
+// the call has not started; tscEnd uses rdtscp, which waits for the call
+// to retire, and the trailing lfence keeps later work out of the window.
+
+static inline uint64_t tscBegin(void) {
+    _mm_lfence();
+    uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+}
+
+static inline uint64_t tscEnd(void) {
+    unsigned aux;
+    uint64_t t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Monotonic clock in nanoseconds, for timing whole passes.
+long long nowNs(void);
+
+// Cost of an empty tscBegin/tscEnd pair: the minimum over many samples,
+// measured once and cached.
+uint64_t tscOverhead(void);
+
+// TSC ticks per nanosecond, calibrated once against the monotonic clock.
+double tscTicksPerNs(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BENCH_TSC_H
@@ -0,0 +1,294 @@
+#ifndef BRANCHLESS_H
+#define BRANCHLESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// libbranchless: the uppercase and clamp kernels the benchmarks in C/
+// measure, built once as a static and a shared library.
+//
+// ABI: symbols are exported under the BRANCHLESS_1.0 version node, later
+// additions under BRANCHLESS_1.1 and up (see branchless.map). Additions
+// bump the minor version; removing or changing a signature needs a new
+// node and a new major/soname.
+
+#define BRANCHLESS_VERSION_MAJOR 1
+#define BRANCHLESS_VERSION_MINOR 1
+#define BRANCHLESS_VERSION_PATCH 0
+#define BRANCHLESS_VERSION \
+    (BRANCHLESS_VERSION_MAJOR * 10000 + BRANCHLESS_VERSION_MINOR * 100 + BRANCHLESS_VERSION_PATCH)
+
+#if defined(_WIN32) && defined(BRANCHLESS_SHARED)
+#  ifdef BRANCHLESS_BUILD
+#    define BL_API __declspec(dllexport)
+#  else
+#    define BL_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define BL_API __attribute__((visibility("default")))
+#else
+#  define BL_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Version of the library actually loaded, as BRANCHLESS_VERSION.
+BL_API int branchlessVersion(void);
+
+// === CPU features ===
+// Instruction sets a kernel may need; kernels are only safe to call when
+// cpuSupports() says so. Dispatched entry points check for you.
+enum {
+    CPU_ANY,
+    CPU_AVX2,
+    CPU_AVX512BW,     // AVX-512BW + BMI2
+    CPU_AVX512VBMI    // AVX-512VBMI + AVX-512BW + BMI2
+};
+
+BL_API int cpuSupports(int cpu);
+BL_API const char *cpuName(int cpu);
+
+// === Uppercase family ===
+// The original NUL-terminated kernels.
+BL_API void obviouseUpperCase(char *str);
+BL_API void branchlessUpperCase1(char *str);
+BL_API void branchlessUpperCase2(char *str);
+
+// Length-based kernels: uppercase str[0..len) in place, ASCII letters
+// only, every other byte unchanged. The terminator is never touched.
+typedef void (*upper_func_t)(char *, size_t);
+
+BL_API void obviouseUpperCaseN(char *str, size_t len);
+BL_API void branchlessUpperCase1N(char *str, size_t len);
+BL_API void branchlessUpperCase2N(char *str, size_t len);
+BL_API void lutUpperCase(char *str, size_t len);
+BL_API void swarUpperCase(char *str, size_t len);
+BL_API void pshufbUpperCase(char *str, size_t len);   // CPU_AVX2
+BL_API void avx2UpperCase(char *str, size_t len);     // CPU_AVX2
+BL_API void avx512UpperCase(char *str, size_t len);   // CPU_AVX512BW
+BL_API void vpermbUpperCase(char *str, size_t len);   // CPU_AVX512VBMI
+
+// Widest kernel this CPU supports (ifunc / CPUID dispatched).
+BL_API void upperCase(char *str, size_t len);
+
+// Registry of every length-based kernel above, in a stable order. Names
+// are stable too: the auto-tuner persists them. `table` is the read-only
+// lookup data the kernel reads, if any, so cache experiments can evict it.
+struct UpperKernel {
+    const char *name;
+    upper_func_t func;
+    int cpu;
+    const void *table;
+    size_t tableSize;
+};
+
+BL_API const struct UpperKernel *upperKernels(int *count);
+
+// === Auto-tuned dispatch ===
+// Per-length-bucket choice among upperKernels(). upper_auto is usable
+// before autotuneInit (it starts on branchlessUpperCase2N everywhere).
+// autotuneInit loads the cache file if it matches this CPU model and
+// microcode, otherwise times every kernel and writes the cache. The path
+// is BRANCHLESS_TUNE_CACHE or ./branchless-autotune.txt.
+// Returns 1 when the cache was used.
+#define AUTOTUNE_BUCKETS 7
+
+BL_API void upper_auto(char *str, size_t len);
+BL_API int autotuneInit(int forceRetune);
+BL_API int autotuneBucketOf(size_t len);
+BL_API size_t autotuneProbeLen(int bucket);
+BL_API const struct UpperKernel *autotuneChoice(int bucket);
+
+// ns per call of func at length len, timed the way the tuner times its
+// candidates (same string pool, best of the same trials), or -1 when out
+// of memory. For comparing against the tuner's own choices. (1.1)
+BL_API double autotuneMeasure(upper_func_t func, size_t len);
+
+// === Case-insensitive compare and hash ===
+// Fold to uppercase on the fly (the branchlessUpperCase2 mask), so the
+// order of the punctuation between 'Z' and 'a' can differ from
+// strcasecmp, which folds to lowercase. Equality is identical.
+BL_API int ascii_casecmp_scalar(const char *a, size_t alen, const char *b, size_t blen);
+BL_API int ascii_casecmp_swar(const char *a, size_t alen, const char *b, size_t blen);
+BL_API int ascii_casecmp_avx2(const char *a, size_t alen, const char *b, size_t blen);
+BL_API int ascii_casecmp(const char *a, size_t alen, const char *b, size_t blen);
+
+BL_API int ascii_caseeq_swar(const char *a, const char *b, size_t n);
+BL_API int ascii_caseeq_avx2(const char *a, const char *b, size_t n);
+BL_API int ascii_caseeq(const char *a, const char *b, size_t n);
+
+// wyhash-style; ascii_casehash(s) == ascii_hash(upper(s)) for any input.
+BL_API uint64_t ascii_hash(const char *s, size_t n, uint64_t seed);
+BL_API uint64_t ascii_casehash(const char *s, size_t n, uint64_t seed);
+
+// === UTF-8 uppercase ===
+// Simple case mapping for ASCII, Latin-1 Supplement, Latin Extended-A,
+// Greek and Cyrillic, in place. Mappings that change the encoded length
+// (U+00DF, U+0131, U+017F) and malformed bytes are left as they are.
+BL_API void naiveUtf8UpperCase(char *str, size_t len);
+BL_API void tableUtf8UpperCase(char *str, size_t len);
+BL_API void swarUtf8UpperCase(char *str, size_t len);
+BL_API void avx2Utf8UpperCase(char *str, size_t len);     // CPU_AVX2
+BL_API void avx512Utf8UpperCase(char *str, size_t len);   // CPU_AVX512BW
+BL_API void utf8UpperCase(char *str, size_t len);
+
+// === Fused ASCII validation + uppercase ===
+// Flags returned by the check and fused kernels; 0 means clean printable
+// ASCII. The fused kernels uppercase either way.
+enum {
+    ASCII_NON_ASCII = 1,  // some byte >= 0x80
+    ASCII_CONTROL   = 2   // some byte < 0x20 or == 0x7F
+};
+
+BL_API int asciiCheckScalar(const char *str, size_t len);
+BL_API int asciiCheckSwar(const char *str, size_t len);
+BL_API int asciiCheckAvx2(const char *str, size_t len);      // CPU_AVX2
+BL_API int upperValidateScalar(char *str, size_t len);
+BL_API int upperValidateSwar(char *str, size_t len);
+BL_API int upperValidateAvx2(char *str, size_t len);         // CPU_AVX2
+BL_API int upperValidate(char *str, size_t len);
+
+// === Clamp family ===
+// C versions of the Dart clamp implementations, same names and logic.
+BL_API double clampIf(double x, double min, double max);
+BL_API double clampTernary(double x, double min, double max);
+BL_API double clampSwitch(double x, double min, double max);
+BL_API double clampBranchless(double x, double min, double max);
+BL_API double clampStandard(double x, double min, double max);
+
+// In-place clamp of an array.
+BL_API void clampArrayScalar(double *data, size_t n, double min, double max);
+BL_API void clampArrayAvx2(double *data, size_t n, double min, double max);     // CPU_AVX2
+BL_API void clampArrayAvx512(double *data, size_t n, double min, double max);   // CPU_AVX512BW
+BL_API void clampArray(double *data, size_t n, double min, double max);
+
+// === Packed string tables (1.1) ===
+// A corpus of strings as one blob plus an offset array, instead of a
+// char * per string. String i starts at blob + offsets[i], is NUL
+// terminated, and is offsets[i + 1] - offsets[i] - 1 bytes long; the
+// offsets are 32-bit, so one table holds at most 4 GiB of text.
+struct StrTable {
+    size_t count;
+    uint32_t *offsets;       // count + 1 entries, offsets[0] == 0
+    char *blob;
+    size_t capacity;         // allocated offsets - 1
+    size_t blobCapacity;     // allocated blob bytes
+};
+
+static inline const char *strTableAt(const struct StrTable *t, size_t i) {
+    return t->blob + t->offsets[i];
+}
+
+static inline size_t strTableLen(const struct StrTable *t, size_t i) {
+    return t->offsets[i + 1] - t->offsets[i] - 1;
+}
+
+// strTableInit reserves room for `count` strings and `bytes` of text
+// (both may be 0); strTableAppend copies s[0..len) plus a NUL and grows
+// the table as needed. Both return 0, or -1 when out of memory (or past
+// 4 GiB), leaving the table as it was.
+BL_API int strTableInit(struct StrTable *t, size_t count, size_t bytes);
+BL_API int strTableAppend(struct StrTable *t, const char *s, size_t len);
+BL_API void strTableFree(struct StrTable *t);
+
+// Uppercase every string in one call: one pass of upperCase over the
+// whole blob, crossing string boundaries (the NULs stay NULs).
+BL_API void strTableUpperCase(struct StrTable *t);
+
+// === Lowercase (1.1) ===
+// Lowercase str[0..len) in place, ASCII letters only, like the
+// length-based uppercase kernels.
+BL_API void swarLowerCase(char *str, size_t len);
+BL_API void avx2LowerCase(char *str, size_t len);     // CPU_AVX2
+BL_API void lowerCase(char *str, size_t len);
+
+// === Lower bound (1.1) ===
+// std::lower_bound on sorted uint32_t keys. The two array kernels return
+// the index of the first a[i] >= key, n if there is none.
+BL_API size_t lowerBoundBranchy(const uint32_t *a, size_t n, uint32_t key);
+BL_API size_t lowerBoundBranchless(const uint32_t *a, size_t n, uint32_t key);
+
+// Eytzinger layout: the sorted keys as an implicit binary tree in BFS
+// order, keys[1..n] with the children of k at 2k and 2k + 1. keys is
+// 64-byte aligned so the 16 descendants four levels below a node share
+// one cache line, which the search prefetches while it compares.
+struct Eytzinger {
+    size_t n;
+    uint32_t *keys;
+};
+
+// 17-ary search tree: nodes of KARY_KEYS sorted keys (one cache line),
+// node k's children at k * (KARY_KEYS + 1) + 1 .. + KARY_KEYS + 1. One
+// level is two AVX2 compares, where the binary layouts need four.
+#define KARY_KEYS 16
+
+struct KaryTree {
+    size_t n, nodes;
+    uint32_t *keys;          // nodes * KARY_KEYS, padded with UINT32_MAX
+    uint32_t maxKey;
+};
+
+// Both build from sorted[0..n) and return 0, or -1 when out of memory.
+// Searches return a pointer to the first key >= key in the layout (its
+// value is the answer, its position is layout-specific), or NULL if
+// every key is smaller.
+BL_API int eytzingerInit(struct Eytzinger *t, const uint32_t *sorted, size_t n);
+BL_API void eytzingerFree(struct Eytzinger *t);
+BL_API const uint32_t *eytzingerLowerBound(const struct Eytzinger *t, uint32_t key);
+
+BL_API int karyInit(struct KaryTree *t, const uint32_t *sorted, size_t n);
+BL_API void karyFree(struct KaryTree *t);
+BL_API const uint32_t *karyLowerBoundScalar(const struct KaryTree *t, uint32_t key);
+BL_API const uint32_t *karyLowerBoundAvx2(const struct KaryTree *t, uint32_t key);   // CPU_AVX2
+BL_API const uint32_t *karyLowerBound(const struct KaryTree *t, uint32_t key);
+
+// === Fused clamp + sum (1.1) ===
+// Sum of clamp(data[i], min, max) without writing anything back. The
+// result is bit-identical across the scalar, AVX2 and AVX-512 kernels and
+// across thread counts: elements are summed in CLAMPSUM_LANES fixed lanes
+// inside blocks of CLAMPSUM_BLOCK elements, and block sums are added in
+// block order. CLAMPSUM_NEUMAIER adds a compensation term per lane.
+#define CLAMPSUM_LANES 16
+#define CLAMPSUM_BLOCK 4096
+
+enum {
+    CLAMPSUM_PLAIN    = 0,
+    CLAMPSUM_NEUMAIER = 1
+};
+
+BL_API double clampSumScalar(const double *data, size_t n, double min, double max, int mode);
+BL_API double clampSumAvx2(const double *data, size_t n, double min, double max, int mode);     // CPU_AVX2
+BL_API double clampSumAvx512(const double *data, size_t n, double min, double max, int mode);   // CPU_AVX512BW
+BL_API double clampSum(const double *data, size_t n, double min, double max, int mode);
+
+BL_API float clampSumFScalar(const float *data, size_t n, float min, float max, int mode);
+BL_API float clampSumFAvx2(const float *data, size_t n, float min, float max, int mode);       // CPU_AVX2
+BL_API float clampSumFAvx512(const float *data, size_t n, float min, float max, int mode);     // CPU_AVX512BW
+BL_API float clampSumF(const float *data, size_t n, float min, float max, int mode);
+
+// Threaded use: split the (n + CLAMPSUM_BLOCK - 1) / CLAMPSUM_BLOCK blocks
+// into runs, let each thread fill out[0 .. lastBlock - firstBlock) for its
+// run, then combine all partials in block order. The result equals
+// clampSum(data, n, min, max, mode) for any split.
+struct ClampSumPartial {
+    double sum, comp;
+};
+
+struct ClampSumPartialF {
+    float sum, comp;
+};
+
+BL_API void clampSumBlocks(const double *data, size_t n, double min, double max, int mode,
+                           size_t firstBlock, size_t lastBlock, struct ClampSumPartial *out);
+BL_API double clampSumCombine(const struct ClampSumPartial *parts, size_t count, int mode);
+BL_API void clampSumBlocksF(const float *data, size_t n, float min, float max, int mode,
+                            size_t firstBlock, size_t lastBlock, struct ClampSumPartialF *out);
+BL_API float clampSumCombineF(const struct ClampSumPartialF *parts, size_t count, int mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BRANCHLESS_H
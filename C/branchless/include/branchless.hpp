@@ -0,0 +1,117 @@
+#ifndef BRANCHLESS_HPP
+#define BRANCHLESS_HPP
+
+// Header-only C++20 layer over libbranchless.
+//
+// Every entry point takes a std::span (or anything that converts to one:
+// arrays, std::array, std::string's data; a std::string_view is const and
+// rejected, since everything works in place) and picks its kernel from
+// the span's extent:
+//
+//   - small fixed extent N: the inline C bodies from branchless_inline.h
+//     with a compile-time length, which the compiler fully unrolls, with
+//     no length checks and no call;
+//   - wide or std::dynamic_extent: the dispatched library kernels
+//     (upperCase, clampArray), which pick AVX-512 / AVX2 / SWAR at run
+//     time;
+//   - constant evaluation: a plain constexpr loop, so the same calls work
+//     in static_assert and constinit initializers.
+//
+// Results are identical on all three paths. Needs -std=c++20.
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+#include "branchless.h"
+#include "branchless_inline.h"
+
+namespace branchless {
+
+// Fixed extents up to this many bytes are inlined with their length as a
+// constant; wider ones and std::dynamic_extent (tested for explicitly,
+// not left to the comparison) go to the dispatched kernels, whose vector loops win from about one
+// AVX2 register onwards (see test_template.cpp).
+inline constexpr std::size_t inlineLimit = 32;
+
+// === Uppercase family ===
+// One character, the branchlessUpperCase2 mask. Works for any character
+// type; bytes >= 0x80 in a signed char are negative and left alone.
+template <class CharT>
+constexpr CharT toUpper(CharT c) noexcept {
+    return static_cast<CharT>(c - 32 * (c >= CharT('a') && c <= CharT('z')));
+}
+
+template <class CharT, std::size_t N>
+constexpr void upperCase(std::span<CharT, N> s) noexcept {
+    static_assert(!std::is_const_v<CharT>, "upperCase works in place");
+    if constexpr (sizeof(CharT) == 1) {
+        if (!std::is_constant_evaluated()) {
+            char *p = reinterpret_cast<char *>(s.data());
+            if constexpr (N != std::dynamic_extent && N <= inlineLimit)
+                swarUpperCaseInline(p, N);
+            else
+                ::upperCase(p, s.size());
+            return;
+        }
+    }
+    for (CharT &c : s) c = toUpper(c);
+}
+
+// Fixed-width fields: a char[N] member or a std::array. All N characters
+// are converted, which leaves a terminating NUL (if any) as it is.
+template <class CharT, std::size_t N>
+constexpr void upperCase(CharT (&field)[N]) noexcept {
+    upperCase(std::span<CharT, N>(field));
+}
+
+template <class CharT, std::size_t N>
+constexpr void upperCase(std::array<CharT, N> &field) noexcept {
+    upperCase(std::span<CharT, N>(field));
+}
+
+// Uppercased copy, usable at compile time:
+//   static_assert(branchless::upperCopy("abc") == std::array{'A', 'B', 'C', '\0'});
+template <class CharT, std::size_t N>
+constexpr std::array<std::remove_const_t<CharT>, N> upperCopy(CharT (&field)[N]) noexcept {
+    std::array<std::remove_const_t<CharT>, N> out{};
+    for (std::size_t i = 0; i < N; ++i) out[i] = field[i];
+    upperCase(out);
+    return out;
+}
+
+// === Clamp family ===
+// clampTernary semantics: NaN passes through, and -0.0 vs 0.0 comes out
+// exactly as the C kernels produce it.
+template <class T>
+constexpr T clamp(T x, T min, T max) noexcept {
+    T lower = x < min ? min : x;
+    return lower > max ? max : lower;
+}
+
+template <class T, std::size_t N>
+constexpr void clamp(std::span<T, N> s, std::type_identity_t<T> min, std::type_identity_t<T> max) noexcept {
+    static_assert(!std::is_const_v<T>, "clamp works in place");
+    if constexpr (std::is_same_v<T, double>) {
+        if (!std::is_constant_evaluated()) {
+            if constexpr (N != std::dynamic_extent && N <= inlineLimit / sizeof(double)) {
+                for (std::size_t i = 0; i < N; ++i)
+                    s[i] = clampTernaryInline(s[i], min, max);
+            } else {
+                clampArray(s.data(), s.size(), min, max);
+            }
+            return;
+        }
+    }
+    for (T &x : s) x = branchless::clamp(x, min, max);
+}
+
+template <class T, std::size_t N>
+constexpr void clamp(std::array<T, N> &a, std::type_identity_t<T> min, std::type_identity_t<T> max) noexcept {
+    branchless::clamp(std::span<T, N>(a), min, max);
+}
+
+}  // namespace branchless
+
+#endif // BRANCHLESS_HPP
@@ -0,0 +1,136 @@
+#ifndef BRANCHLESS_INLINE_H
+#define BRANCHLESS_INLINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// The scalar kernels as static inline definitions. The library's exported
+// functions are thin wrappers around these same bodies, so a caller that
+// wants the compiler to inline them (test_with_inline.c) benchmarks exactly
+// the code the library ships.
+
+// === Uppercase family ===
+static inline void obviouseUpperCaseInline(char *str) {
+    for (size_t i = 0; str[i] != '\0'; ++i)
+        if (str[i] >= 'a' && str[i] <= 'z')
+            str[i] -= 32;
+}
+
+static inline void branchlessUpperCase1Inline(char *str) {
+    for (size_t i = 0; str[i] != '\0'; ++i)
+        str[i] = (str[i] * !(str[i] >= 'a' && str[i] <= 'z')) +
+                 (str[i] - 32) * (str[i] >= 'a' && str[i] <= 'z');
+}
+
+static inline void branchlessUpperCase2Inline(char *str) {
+    for (size_t i = 0; str[i] != '\0'; ++i)
+        str[i] -= 32 * (str[i] >= 'a' && str[i] <= 'z');
+}
+
+// Length-based form of branchlessUpperCase2. With a constant len the
+// compiler unrolls or vectorizes it outright (see branchless.hpp).
+static inline void branchlessUpperCase2NInline(char *str, size_t len) {
+    for (size_t i = 0; i < len; ++i)
+        str[i] -= 32 * (str[i] >= 'a' && str[i] <= 'z');
+}
+
+// SWAR fold of 8 bytes at once. Bytes with the high bit set are left alone:
+// `heptets + (0x80 - 'a')` carries into bit 7 only for bytes >= 'a', and
+// `heptets + (0x80 - 'z' - 1)` only for bytes > 'z', so their XOR marks
+// exactly the lowercase letters. Shifting that 0x80 marker down by two
+// gives the 0x20 case bit to clear.
+static inline uint64_t swarFoldInline(uint64_t x) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    uint64_t heptets = x & (0x7F * ones);
+    uint64_t geA = heptets + ((0x80 - 'a') * ones);
+    uint64_t gtZ = heptets + ((0x80 - 'z' - 1) * ones);
+    uint64_t lower = (geA ^ gtZ) & ~x & (0x80 * ones);
+    return x ^ (lower >> 2);
+}
+
+static inline void swarUpperCaseInline(char *str, size_t len) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t x;
+        memcpy(&x, str + i, sizeof(x));
+        x = swarFoldInline(x);
+        memcpy(str + i, &x, sizeof(x));
+    }
+    branchlessUpperCase2NInline(str + i, len - i);
+}
+
+// === Clamp family ===
+// Branchy: classic implementation of clamp(x, min, max)
+static inline double clampIfInline(double x, double min, double max) {
+    if (x < min) return min;
+    if (x > max) return max;
+    return x;
+}
+
+// Ternary: implementation using the ternary operator
+static inline double clampTernaryInline(double x, double min, double max) {
+    double lower = x < min ? min : x;
+    return lower > max ? max : lower;
+}
+
+static inline int signOf(double d) {
+    return (d > 0) - (d < 0);
+}
+
+// Switch case: sign(x - min) + sign(x - max) is one of -2..2:
+//  -2, -1 -> x <= min;  0 -> inside (or NaN);  1, 2 -> x >= max
+static inline double clampSwitchInline(double x, double min, double max) {
+    switch (signOf(x - min) + signOf(x - max)) {
+    case -2:
+    case -1:
+        return min;
+    case 0:
+        return x;
+    case 1:
+    case 2:
+        return max;
+    default:
+        return x;
+    }
+}
+
+// Branchless: arithmetic version without if
+static inline double clampBranchlessInline(double x, double min, double max) {
+    int useMin = (1 - signOf(x - min)) >> 1; // 1 if x < min, otherwise 0
+    int useMax = (signOf(x - max) + 1) >> 1; // 1 if x > max, otherwise 0
+    int useX = 1 - useMin - useMax;          // 1 if min <= x <= max, otherwise 0
+
+    return useMin * min + useX * x + useMax * max;
+}
+
+// === Lower bound ===
+// Index of the first a[i] >= key in the sorted a[0..n), n if there is
+// none: std::lower_bound on uint32_t.
+
+// Branchy: the textbook halving loop, one hard-to-predict branch per level
+static inline size_t lowerBoundBranchyInline(const uint32_t *a, size_t n, uint32_t key) {
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (a[mid] < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Branchless: the range only ever shrinks from the top, so the loop runs
+// a fixed log2(n) times for a given n and the compare becomes a cmov on
+// the base pointer.
+static inline size_t lowerBoundBranchlessInline(const uint32_t *a, size_t n, uint32_t key) {
+    if (n == 0) return 0;
+    const uint32_t *base = a;
+    while (n > 1) {
+        size_t half = n / 2;
+        base = base[half] < key ? base + half : base;
+        n -= half;
+    }
+    return (size_t)(base - a) + (*base < key);
+}
+
+#endif // BRANCHLESS_INLINE_H
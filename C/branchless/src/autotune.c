@@ -0,0 +1,298 @@
+#include "internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <cpuid.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static long long nowNs(void) {
+#ifdef _WIN32
+    LARGE_INTEGER t, freq;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (long long)((double)t.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+// === Length buckets ===
+// Powers of four: [0,16) [16,64) [64,256) [256,1K) [1K,4K) [4K,16K) [16K,..)
+static const size_t bucketProbeLen[AUTOTUNE_BUCKETS] = {8, 32, 128, 512, 2048, 8192, 32768};
+
+int autotuneBucketOf(size_t len) {
+    int log4 = (63 - __builtin_clzll((unsigned long long)len | 1)) >> 1;
+    int b = log4 - 1;
+    return b < 0 ? 0 : b >= AUTOTUNE_BUCKETS ? AUTOTUNE_BUCKETS - 1 : b;
+}
+
+// === Dispatch table ===
+// Starts out on branchlessUpperCase2N everywhere, so upper_auto is safe to
+// call before autotuneInit has run.
+static upper_func_t autoTable[AUTOTUNE_BUCKETS] = {
+    branchlessUpperCase2N, branchlessUpperCase2N, branchlessUpperCase2N, branchlessUpperCase2N,
+    branchlessUpperCase2N, branchlessUpperCase2N, branchlessUpperCase2N
+};
+static int autoChoice[AUTOTUNE_BUCKETS] = {2, 2, 2, 2, 2, 2, 2};  // "branchless2" in upperKernels()
+
+void upper_auto(char *str, size_t len) {
+    autoTable[autotuneBucketOf(len)](str, len);
+}
+
+// === CPU identity ===
+// The cache is only valid for the exact CPU model and microcode it was
+// measured on. The brand string comes from CPUID so it works everywhere;
+// microcode is only exposed on Linux and reads "unknown" elsewhere.
+static void cpuBrand(char *out, size_t size) {
+    unsigned regs[12];
+    if (__get_cpuid_max(0x80000000, NULL) < 0x80000004) {
+        snprintf(out, size, "unknown");
+        return;
+    }
+    for (unsigned i = 0; i < 3; ++i)
+        __get_cpuid(0x80000002 + i, &regs[4 * i], &regs[4 * i + 1], &regs[4 * i + 2], &regs[4 * i + 3]);
+    char brand[49];
+    memcpy(brand, regs, 48);
+    brand[48] = '\0';
+    const char *p = brand;
+    while (*p == ' ') ++p;
+    snprintf(out, size, "%s", p);
+}
+
+static void cpuMicrocode(char *out, size_t size) {
+    snprintf(out, size, "unknown");
+#ifdef __linux__
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (!f) return;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "microcode", 9) == 0) {
+            char *colon = strchr(line, ':');
+            if (colon) {
+                colon += 1 + (colon[1] == ' ');
+                colon[strcspn(colon, "\n")] = '\0';
+                snprintf(out, size, "%s", colon);
+            }
+            break;
+        }
+    }
+    fclose(f);
+#endif
+}
+
+// === Cache file ===
+// Plain text, one key per line:
+//   branchless-autotune 1
+//   cpu <brand string>
+//   microcode <revision>
+//   bucket <index> <kernel name>
+#define CACHE_VERSION 1
+
+static void cachePath(char *out, size_t size) {
+    const char *env = getenv("BRANCHLESS_TUNE_CACHE");
+    if (env && *env) {
+        snprintf(out, size, "%s", env);
+        return;
+    }
+    snprintf(out, size, "branchless-autotune.txt");
+}
+
+static int findKernel(const char *name) {
+    int count;
+    const struct UpperKernel *kernels = upperKernels(&count);
+    for (int k = 0; k < count; ++k)
+        if (strcmp(kernels[k].name, name) == 0)
+            return cpuSupports(kernels[k].cpu) ? k : -1;
+    return -1;
+}
+
+// Returns 1 only if the file matches this CPU and names a usable kernel
+// for every bucket; anything else means "retune".
+static int loadCache(const char *path, const char *cpu, const char *ucode) {
+    int count;
+    const struct UpperKernel *kernels = upperKernels(&count);
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+
+    char line[256];
+    int version = 0, cpuOk = 0, ucodeOk = 0, seen = 0;
+    int choice[AUTOTUNE_BUCKETS];
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\n")] = '\0';
+        char name[64];
+        int b;
+        if (sscanf(line, "branchless-autotune %d", &version) == 1) continue;
+        if (strncmp(line, "cpu ", 4) == 0) { cpuOk = strcmp(line + 4, cpu) == 0; continue; }
+        if (strncmp(line, "microcode ", 10) == 0) { ucodeOk = strcmp(line + 10, ucode) == 0; continue; }
+        if (sscanf(line, "bucket %d %63s", &b, name) == 2 && b >= 0 && b < AUTOTUNE_BUCKETS) {
+            if ((choice[b] = findKernel(name)) < 0) break;
+            seen |= 1 << b;
+        }
+    }
+    fclose(f);
+
+    if (version != CACHE_VERSION || !cpuOk || !ucodeOk || seen != (1 << AUTOTUNE_BUCKETS) - 1)
+        return 0;
+    for (int b = 0; b < AUTOTUNE_BUCKETS; ++b) {
+        autoChoice[b] = choice[b];
+        autoTable[b] = kernels[choice[b]].func;
+    }
+    return 1;
+}
+
+static int saveCache(const char *path, const char *cpu, const char *ucode) {
+    int count;
+    const struct UpperKernel *kernels = upperKernels(&count);
+    FILE *f = fopen(path, "w");
+    if (!f) return 0;
+    fprintf(f, "branchless-autotune %d\n", CACHE_VERSION);
+    fprintf(f, "cpu %s\n", cpu);
+    fprintf(f, "microcode %s\n", ucode);
+    for (int b = 0; b < AUTOTUNE_BUCKETS; ++b)
+        fprintf(f, "bucket %d %s\n", b, kernels[autoChoice[b]].name);
+    return fclose(f) == 0;
+}
+
+// === Tuning ===
+// Same mix of upper and lower case letters as randStr in the benchmarks,
+// from a private xorshift so tuning does not disturb the caller's rand().
+static void randLetters(char *s, size_t len, uint32_t *state) {
+    for (size_t i = 0; i < len; ++i) {
+        uint32_t x = *state;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        *state = x;
+        s[i] = (char)(((x >> 8) & 1 ? 'a' : 'A') + (x >> 16) % 26);
+    }
+    s[len] = '\0';
+}
+
+// Each kernel runs over a ~256 KB pool of strings at the bucket's probe
+// length. The pool is restored from the same random master copy before
+// every trial, so kernels never see already-uppercased input, and the
+// best of several trials is kept to shave off noise.
+#define TUNE_POOL_BYTES (256 * 1024)
+#define TUNE_TRIALS 5
+
+struct TunePool {
+    char *master;
+    char *work;
+    size_t bytes;
+};
+
+static int makePool(struct TunePool *pool, size_t len, int count) {
+    pool->bytes = (size_t)count * (len + 1);
+    pool->master = malloc(pool->bytes);
+    pool->work = malloc(pool->bytes);
+    if (!pool->master || !pool->work) {
+        free(pool->master);
+        free(pool->work);
+        return 0;
+    }
+    uint32_t seed = 0x9E3779B9u;
+    for (int i = 0; i < count; ++i)
+        randLetters(pool->master + (size_t)i * (len + 1), len, &seed);
+    return 1;
+}
+
+static void freePool(struct TunePool *pool) {
+    free(pool->master);
+    free(pool->work);
+}
+
+static int poolCount(size_t len) {
+    int count = (int)(TUNE_POOL_BYTES / (len + 1));
+    return count > 0 ? count : 1;
+}
+
+static long long timeKernel(upper_func_t func, struct TunePool *pool, size_t len, int count) {
+    long long best = -1;
+    for (int t = 0; t < TUNE_TRIALS; ++t) {
+        memcpy(pool->work, pool->master, pool->bytes);
+        long long start = nowNs();
+        for (int i = 0; i < count; ++i)
+            func(pool->work + (size_t)i * (len + 1), len);
+        long long end = nowNs();
+        if (best < 0 || end - start < best)
+            best = end - start;
+    }
+    return best;
+}
+
+// Choices are only published once every bucket has been timed; if a pool
+// cannot be allocated the table keeps what it had.
+static int tuneAll(void) {
+    int numKernels;
+    const struct UpperKernel *kernels = upperKernels(&numKernels);
+    int choice[AUTOTUNE_BUCKETS];
+    for (int b = 0; b < AUTOTUNE_BUCKETS; ++b) {
+        size_t len = bucketProbeLen[b];
+        int count = poolCount(len);
+        struct TunePool pool;
+        if (!makePool(&pool, len, count)) return 0;
+
+        long long best = -1;
+        choice[b] = autoChoice[b];
+        for (int k = 0; k < numKernels; ++k) {
+            if (!cpuSupports(kernels[k].cpu)) continue;
+            long long t = timeKernel(kernels[k].func, &pool, len, count);
+            if (best < 0 || t < best) {
+                best = t;
+                choice[b] = k;
+            }
+        }
+        freePool(&pool);
+    }
+    for (int b = 0; b < AUTOTUNE_BUCKETS; ++b) {
+        autoChoice[b] = choice[b];
+        autoTable[b] = kernels[choice[b]].func;
+    }
+    return 1;
+}
+
+// Loads the cached table when it matches this machine, otherwise tunes
+// and writes it back; a tuning run that fails is neither used nor saved.
+// Returns 1 if the cache was used.
+int autotuneInit(int forceRetune) {
+    char cpu[64], ucode[64], path[512];
+    cpuBrand(cpu, sizeof(cpu));
+    cpuMicrocode(ucode, sizeof(ucode));
+    cachePath(path, sizeof(path));
+
+    if (!forceRetune && loadCache(path, cpu, ucode))
+        return 1;
+    if (!tuneAll()) {
+        fprintf(stderr, "branchless: out of memory while tuning, keeping the default kernels\n");
+        return 0;
+    }
+    if (!saveCache(path, cpu, ucode))
+        fprintf(stderr, "branchless: could not write tuning cache %s\n", path);
+    return 0;
+}
+
+// === Introspection ===
+size_t autotuneProbeLen(int bucket) {
+    return bucketProbeLen[bucket];
+}
+
+double autotuneMeasure(upper_func_t func, size_t len) {
+    int count = poolCount(len);
+    struct TunePool pool;
+    if (!makePool(&pool, len, count)) return -1.0;
+    long long ns = timeKernel(func, &pool, len, count);
+    freePool(&pool);
+    return (double)ns / count;
+}
+
+const struct UpperKernel *autotuneChoice(int bucket) {
+    int count;
+    return upperKernels(&count) + autoChoice[bucket];
+}
+
@@ -0,0 +1,136 @@
+#include "internal.h"
+
+// === Comparison ===
+int ascii_casecmp_scalar(const char *a, size_t alen, const char *b, size_t blen) {
+    size_t n = alen < blen ? alen : blen;
+    for (size_t i = 0; i < n; ++i) {
+        int d = foldByte((unsigned char)a[i]) - foldByte((unsigned char)b[i]);
+        if (d) return d;
+    }
+    return (alen > blen) - (alen < blen);
+}
+
+int ascii_casecmp_swar(const char *a, size_t alen, const char *b, size_t blen) {
+    size_t n = alen < blen ? alen : blen;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x = foldWord(load64(a + i));
+        uint64_t y = foldWord(load64(b + i));
+        if (x != y) {
+            // Little-endian: the lowest differing byte is the first one.
+            int k = __builtin_ctzll(x ^ y) >> 3;
+            return (int)((x >> (8 * k)) & 0xFF) - (int)((y >> (8 * k)) & 0xFF);
+        }
+    }
+    return ascii_casecmp_scalar(a + i, alen - i, b + i, blen - i);
+}
+
+__attribute__((target("avx2")))
+int ascii_casecmp_avx2(const char *a, size_t alen, const char *b, size_t blen) {
+    size_t n = alen < blen ? alen : blen;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = foldVec(_mm256_loadu_si256((const __m256i *)(a + i)));
+        __m256i y = foldVec(_mm256_loadu_si256((const __m256i *)(b + i)));
+        unsigned eq = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+        if (eq != 0xFFFFFFFFu) {
+            int k = __builtin_ctz(~eq);
+            return foldByte((unsigned char)a[i + k]) - foldByte((unsigned char)b[i + k]);
+        }
+    }
+    return ascii_casecmp_swar(a + i, alen - i, b + i, blen - i);
+}
+
+int ascii_caseeq_swar(const char *a, const char *b, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        if (foldWord(load64(a + i)) != foldWord(load64(b + i)))
+            return 0;
+    for (; i < n; ++i)
+        if (foldByte((unsigned char)a[i]) != foldByte((unsigned char)b[i]))
+            return 0;
+    return 1;
+}
+
+// Equality only needs "any difference", so the loop ORs the XOR of the
+// folded blocks and tests once per 128 bytes instead of once per block.
+__attribute__((target("avx2")))
+int ascii_caseeq_avx2(const char *a, const char *b, size_t n) {
+    size_t i = 0;
+    for (; i + 128 <= n; i += 128) {
+        __m256i acc = _mm256_setzero_si256();
+        for (size_t j = 0; j < 128; j += 32) {
+            __m256i x = foldVec(_mm256_loadu_si256((const __m256i *)(a + i + j)));
+            __m256i y = foldVec(_mm256_loadu_si256((const __m256i *)(b + i + j)));
+            acc = _mm256_or_si256(acc, _mm256_xor_si256(x, y));
+        }
+        if (!_mm256_testz_si256(acc, acc)) return 0;
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = foldVec(_mm256_loadu_si256((const __m256i *)(a + i)));
+        __m256i y = foldVec(_mm256_loadu_si256((const __m256i *)(b + i)));
+        __m256i d = _mm256_xor_si256(x, y);
+        if (!_mm256_testz_si256(d, d)) return 0;
+    }
+    return ascii_caseeq_swar(a + i, b + i, n - i);
+}
+
+// === Hashing ===
+// wyhash-style: 16 bytes per round mixed through a 64x64->128 multiply.
+// With `fold` set every word goes through foldWord on load, so
+// ascii_casehash(s) == ascii_hash(upper(s)) for any input, ASCII or not.
+static inline uint64_t wyMix(uint64_t a, uint64_t b) {
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+static const uint64_t WY_P0 = 0xa0761d6478bd642fULL;
+static const uint64_t WY_P1 = 0xe7037ed1a0b428dbULL;
+static const uint64_t WY_P2 = 0x8ebc6af09c88c6e3ULL;
+
+static inline uint64_t loadTail(const char *p, size_t n) {
+    uint64_t v = 0;
+    memcpy(&v, p, n);
+    return v;
+}
+
+static inline uint64_t hashImpl(const char *s, size_t n, uint64_t seed, int fold) {
+    uint64_t h = seed ^ WY_P0 ^ n;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint64_t x = load64(s + i), y = load64(s + i + 8);
+        if (fold) { x = foldWord(x); y = foldWord(y); }
+        h = wyMix(x ^ WY_P1, y ^ h);
+    }
+    uint64_t x = 0, y = 0;
+    size_t rest = n - i;
+    if (rest > 8) {
+        x = load64(s + i);
+        y = loadTail(s + i + 8, rest - 8);
+    } else if (rest) {
+        x = loadTail(s + i, rest);
+    }
+    // foldWord maps zero padding to zero, so tails fold the same way.
+    if (fold) { x = foldWord(x); y = foldWord(y); }
+    return wyMix(wyMix(x ^ WY_P1, y ^ h) ^ WY_P2, n ^ WY_P1);
+}
+
+uint64_t ascii_hash(const char *s, size_t n, uint64_t seed) {
+    return hashImpl(s, n, seed, 0);
+}
+
+uint64_t ascii_casehash(const char *s, size_t n, uint64_t seed) {
+    return hashImpl(s, n, seed, 1);
+}
+
+// === Dispatch ===
+static int (*ascii_casecmp_resolve(void))(const char *, size_t, const char *, size_t) {
+    return cpuHas(CPU_AVX2) ? ascii_casecmp_avx2 : ascii_casecmp_swar;
+}
+
+static int (*ascii_caseeq_resolve(void))(const char *, const char *, size_t) {
+    return cpuHas(CPU_AVX2) ? ascii_caseeq_avx2 : ascii_caseeq_swar;
+}
+
+BL_DISPATCH(int, ascii_casecmp, (const char *a, size_t alen, const char *b, size_t blen), (a, alen, b, blen))
+BL_DISPATCH(int, ascii_caseeq, (const char *a, const char *b, size_t n), (a, b, n))
@@ -0,0 +1,71 @@
+#include "internal.h"
+
+#include <math.h>
+
+// === Scalar family ===
+double clampIf(double x, double min, double max) {
+    return clampIfInline(x, min, max);
+}
+
+double clampTernary(double x, double min, double max) {
+    return clampTernaryInline(x, min, max);
+}
+
+double clampSwitch(double x, double min, double max) {
+    return clampSwitchInline(x, min, max);
+}
+
+double clampBranchless(double x, double min, double max) {
+    return clampBranchlessInline(x, min, max);
+}
+
+// Out of the box: the C library's own min/max
+double clampStandard(double x, double min, double max) {
+    return fmin(fmax(x, min), max);
+}
+
+// === Array kernels ===
+// Operand order matters: maxpd/minpd return the second operand when the
+// compare is false (NaN, or equal values such as -0.0 and 0.0), which
+// makes the vector kernels bit-for-bit equal to clampTernary.
+void clampArrayScalar(double *data, size_t n, double min, double max) {
+    for (size_t i = 0; i < n; ++i)
+        data[i] = clampTernaryInline(data[i], min, max);
+}
+
+__attribute__((target("avx2")))
+void clampArrayAvx2(double *data, size_t n, double min, double max) {
+    const __m256d lo = _mm256_set1_pd(min);
+    const __m256d hi = _mm256_set1_pd(max);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(data + i);
+        _mm256_storeu_pd(data + i, _mm256_min_pd(hi, _mm256_max_pd(lo, v)));
+    }
+    clampArrayScalar(data + i, n - i, min, max);
+}
+
+__attribute__((target("avx512f")))
+void clampArrayAvx512(double *data, size_t n, double min, double max) {
+    const __m512d lo = _mm512_set1_pd(min);
+    const __m512d hi = _mm512_set1_pd(max);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d v = _mm512_loadu_pd(data + i);
+        _mm512_storeu_pd(data + i, _mm512_min_pd(hi, _mm512_max_pd(lo, v)));
+    }
+    if (i < n) {
+        __mmask8 m = (__mmask8)((1u << (n - i)) - 1);
+        __m512d v = _mm512_maskz_loadu_pd(m, data + i);
+        _mm512_mask_storeu_pd(data + i, m, _mm512_min_pd(hi, _mm512_max_pd(lo, v)));
+    }
+}
+
+// === Dispatch ===
+static void (*clampArray_resolve(void))(double *, size_t, double, double) {
+    if (cpuHas(CPU_AVX512BW)) return clampArrayAvx512;
+    if (cpuHas(CPU_AVX2)) return clampArrayAvx2;
+    return clampArrayScalar;
+}
+
+BL_DISPATCH_VOID(clampArray, (double *data, size_t n, double min, double max), (data, n, min, max))
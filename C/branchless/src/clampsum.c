@@ -0,0 +1,362 @@
+#include "internal.h"
+
+#include <math.h>
+
+// === Fused clamp + sum ===
+// Element i always goes to lane i % CLAMPSUM_LANES, every lane adds its
+// elements in index order, and lanes are folded in a fixed tree. The
+// scalar, AVX2 and AVX-512 kernels only differ in how many lanes they
+// advance per instruction, so all three produce the same bits. Blocks of
+// CLAMPSUM_BLOCK elements are reduced independently and then added in
+// block order, which is what makes a threaded sum (each thread taking a
+// run of blocks, see clampSumBlocks) equal to the single-threaded one.
+//
+// CLAMPSUM_NEUMAIER keeps a compensation term per lane (Neumaier's
+// variant of Kahan summation, which also handles |x| > |sum|) and carries
+// it through the lane tree and the block sums.
+
+#define LANES CLAMPSUM_LANES
+
+// (s, c) += (s2, c2); with compensation the rounding error of s + s2 is
+// added to c.
+static inline void addPair(double *s, double *c, double s2, double c2, int mode) {
+    if (mode != CLAMPSUM_NEUMAIER) {
+        *s += s2;
+        return;
+    }
+    double t = *s + s2;
+    double err = fabs(*s) >= fabs(s2) ? (*s - t) + s2 : (s2 - t) + *s;
+    *c = (*c + c2) + err;
+    *s = t;
+}
+
+static inline void addPairF(float *s, float *c, float s2, float c2, int mode) {
+    if (mode != CLAMPSUM_NEUMAIER) {
+        *s += s2;
+        return;
+    }
+    float t = *s + s2;
+    float err = fabsf(*s) >= fabsf(s2) ? (*s - t) + s2 : (s2 - t) + *s;
+    *c = (*c + c2) + err;
+    *s = t;
+}
+
+static inline float clampTernaryF(float x, float min, float max) {
+    float lower = x < min ? min : x;
+    return lower > max ? max : lower;
+}
+
+// === Lane kernels ===
+// Add clamp(p[0..n)) into lanes s[]/c[]; p[0] belongs to lane 0, so
+// callers only start them at multiples of LANES.
+typedef void (*lanes_d_t)(const double *, size_t, double, double, int, double *, double *);
+typedef void (*lanes_f_t)(const float *, size_t, float, float, int, float *, float *);
+
+static void lanesScalar(const double *p, size_t n, double lo, double hi, int mode, double *s, double *c) {
+    for (size_t i = 0; i < n; ++i) {
+        double x = clampTernaryInline(p[i], lo, hi);
+        addPair(&s[i % LANES], &c[i % LANES], x, 0.0, mode);
+    }
+}
+
+static void lanesScalarF(const float *p, size_t n, float lo, float hi, int mode, float *s, float *c) {
+    for (size_t i = 0; i < n; ++i) {
+        float x = clampTernaryF(p[i], lo, hi);
+        addPairF(&s[i % LANES], &c[i % LANES], x, 0.0f, mode);
+    }
+}
+
+// Vector Neumaier step: the branch on |s| >= |x| becomes a blend.
+__attribute__((target("avx2")))
+static inline void neumaier256d(__m256d *s, __m256d *c, __m256d x) {
+    const __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    __m256d t = _mm256_add_pd(*s, x);
+    __m256d ge = _mm256_cmp_pd(_mm256_and_pd(*s, absMask), _mm256_and_pd(x, absMask), _CMP_GE_OQ);
+    __m256d big = _mm256_blendv_pd(x, *s, ge), small = _mm256_blendv_pd(*s, x, ge);
+    *c = _mm256_add_pd(*c, _mm256_add_pd(_mm256_sub_pd(big, t), small));
+    *s = t;
+}
+
+__attribute__((target("avx2")))
+static inline void neumaier256f(__m256 *s, __m256 *c, __m256 x) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 t = _mm256_add_ps(*s, x);
+    __m256 ge = _mm256_cmp_ps(_mm256_and_ps(*s, absMask), _mm256_and_ps(x, absMask), _CMP_GE_OQ);
+    __m256 big = _mm256_blendv_ps(x, *s, ge), small = _mm256_blendv_ps(*s, x, ge);
+    *c = _mm256_add_ps(*c, _mm256_add_ps(_mm256_sub_ps(big, t), small));
+    *s = t;
+}
+
+// Four accumulators of four doubles cover the sixteen lanes.
+__attribute__((target("avx2")))
+static void lanesAvx2(const double *p, size_t n, double lo, double hi, int mode, double *s, double *c) {
+    const __m256d vlo = _mm256_set1_pd(lo), vhi = _mm256_set1_pd(hi);
+    __m256d sv[4], cv[4];
+    for (int k = 0; k < 4; ++k) {
+        sv[k] = _mm256_loadu_pd(s + 4 * k);
+        cv[k] = _mm256_loadu_pd(c + 4 * k);
+    }
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (int k = 0; k < 4; ++k) {
+            __m256d x = _mm256_min_pd(vhi, _mm256_max_pd(vlo, _mm256_loadu_pd(p + i + 4 * k)));
+            if (mode == CLAMPSUM_NEUMAIER) neumaier256d(&sv[k], &cv[k], x);
+            else sv[k] = _mm256_add_pd(sv[k], x);
+        }
+    }
+    for (int k = 0; k < 4; ++k) {
+        _mm256_storeu_pd(s + 4 * k, sv[k]);
+        _mm256_storeu_pd(c + 4 * k, cv[k]);
+    }
+    lanesScalar(p + i, n - i, lo, hi, mode, s, c);
+}
+
+__attribute__((target("avx2")))
+static void lanesAvx2F(const float *p, size_t n, float lo, float hi, int mode, float *s, float *c) {
+    const __m256 vlo = _mm256_set1_ps(lo), vhi = _mm256_set1_ps(hi);
+    __m256 sv[2], cv[2];
+    for (int k = 0; k < 2; ++k) {
+        sv[k] = _mm256_loadu_ps(s + 8 * k);
+        cv[k] = _mm256_loadu_ps(c + 8 * k);
+    }
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (int k = 0; k < 2; ++k) {
+            __m256 x = _mm256_min_ps(vhi, _mm256_max_ps(vlo, _mm256_loadu_ps(p + i + 8 * k)));
+            if (mode == CLAMPSUM_NEUMAIER) neumaier256f(&sv[k], &cv[k], x);
+            else sv[k] = _mm256_add_ps(sv[k], x);
+        }
+    }
+    for (int k = 0; k < 2; ++k) {
+        _mm256_storeu_ps(s + 8 * k, sv[k]);
+        _mm256_storeu_ps(c + 8 * k, cv[k]);
+    }
+    lanesScalarF(p + i, n - i, lo, hi, mode, s, c);
+}
+
+// Two accumulators of eight doubles; floats fill the sixteen lanes with
+// one register.
+__attribute__((target("avx512f")))
+static void lanesAvx512(const double *p, size_t n, double lo, double hi, int mode, double *s, double *c) {
+    const __m512d vlo = _mm512_set1_pd(lo), vhi = _mm512_set1_pd(hi);
+    __m512d s0 = _mm512_loadu_pd(s), s1 = _mm512_loadu_pd(s + 8);
+    __m512d c0 = _mm512_loadu_pd(c), c1 = _mm512_loadu_pd(c + 8);
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        __m512d x0 = _mm512_min_pd(vhi, _mm512_max_pd(vlo, _mm512_loadu_pd(p + i)));
+        __m512d x1 = _mm512_min_pd(vhi, _mm512_max_pd(vlo, _mm512_loadu_pd(p + i + 8)));
+        if (mode == CLAMPSUM_NEUMAIER) {
+            __m512d t0 = _mm512_add_pd(s0, x0), t1 = _mm512_add_pd(s1, x1);
+            __mmask8 ge0 = _mm512_cmp_pd_mask(_mm512_abs_pd(s0), _mm512_abs_pd(x0), _CMP_GE_OQ);
+            __mmask8 ge1 = _mm512_cmp_pd_mask(_mm512_abs_pd(s1), _mm512_abs_pd(x1), _CMP_GE_OQ);
+            c0 = _mm512_add_pd(c0, _mm512_add_pd(_mm512_sub_pd(_mm512_mask_blend_pd(ge0, x0, s0), t0),
+                                                 _mm512_mask_blend_pd(ge0, s0, x0)));
+            c1 = _mm512_add_pd(c1, _mm512_add_pd(_mm512_sub_pd(_mm512_mask_blend_pd(ge1, x1, s1), t1),
+                                                 _mm512_mask_blend_pd(ge1, s1, x1)));
+            s0 = t0;
+            s1 = t1;
+        } else {
+            s0 = _mm512_add_pd(s0, x0);
+            s1 = _mm512_add_pd(s1, x1);
+        }
+    }
+    _mm512_storeu_pd(s, s0);
+    _mm512_storeu_pd(s + 8, s1);
+    _mm512_storeu_pd(c, c0);
+    _mm512_storeu_pd(c + 8, c1);
+    lanesScalar(p + i, n - i, lo, hi, mode, s, c);
+}
+
+__attribute__((target("avx512f")))
+static void lanesAvx512F(const float *p, size_t n, float lo, float hi, int mode, float *s, float *c) {
+    const __m512 vlo = _mm512_set1_ps(lo), vhi = _mm512_set1_ps(hi);
+    __m512 sv = _mm512_loadu_ps(s), cv = _mm512_loadu_ps(c);
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        __m512 x = _mm512_min_ps(vhi, _mm512_max_ps(vlo, _mm512_loadu_ps(p + i)));
+        if (mode == CLAMPSUM_NEUMAIER) {
+            __m512 t = _mm512_add_ps(sv, x);
+            __mmask16 ge = _mm512_cmp_ps_mask(_mm512_abs_ps(sv), _mm512_abs_ps(x), _CMP_GE_OQ);
+            cv = _mm512_add_ps(cv, _mm512_add_ps(_mm512_sub_ps(_mm512_mask_blend_ps(ge, x, sv), t),
+                                                 _mm512_mask_blend_ps(ge, sv, x)));
+            sv = t;
+        } else {
+            sv = _mm512_add_ps(sv, x);
+        }
+    }
+    _mm512_storeu_ps(s, sv);
+    _mm512_storeu_ps(c, cv);
+    lanesScalarF(p + i, n - i, lo, hi, mode, s, c);
+}
+
+// === Blocks ===
+static struct ClampSumPartial blockSum(lanes_d_t lanes, const double *p, size_t n,
+                                       double lo, double hi, int mode) {
+    double s[LANES] = {0}, c[LANES] = {0};
+    lanes(p, n, lo, hi, mode, s, c);
+    for (int w = LANES / 2; w >= 1; w /= 2)
+        for (int j = 0; j < w; ++j)
+            addPair(&s[j], &c[j], s[j + w], c[j + w], mode);
+    struct ClampSumPartial part = {s[0], c[0]};
+    return part;
+}
+
+static struct ClampSumPartialF blockSumF(lanes_f_t lanes, const float *p, size_t n,
+                                         float lo, float hi, int mode) {
+    float s[LANES] = {0}, c[LANES] = {0};
+    lanes(p, n, lo, hi, mode, s, c);
+    for (int w = LANES / 2; w >= 1; w /= 2)
+        for (int j = 0; j < w; ++j)
+            addPairF(&s[j], &c[j], s[j + w], c[j + w], mode);
+    struct ClampSumPartialF part = {s[0], c[0]};
+    return part;
+}
+
+static void blocks(lanes_d_t lanes, const double *data, size_t n, double lo, double hi, int mode,
+                   size_t firstBlock, size_t lastBlock, struct ClampSumPartial *out) {
+    for (size_t b = firstBlock; b < lastBlock; ++b) {
+        size_t start = b * CLAMPSUM_BLOCK;
+        size_t len = n - start < CLAMPSUM_BLOCK ? n - start : CLAMPSUM_BLOCK;
+        out[b - firstBlock] = blockSum(lanes, data + start, len, lo, hi, mode);
+    }
+}
+
+static void blocksF(lanes_f_t lanes, const float *data, size_t n, float lo, float hi, int mode,
+                    size_t firstBlock, size_t lastBlock, struct ClampSumPartialF *out) {
+    for (size_t b = firstBlock; b < lastBlock; ++b) {
+        size_t start = b * CLAMPSUM_BLOCK;
+        size_t len = n - start < CLAMPSUM_BLOCK ? n - start : CLAMPSUM_BLOCK;
+        out[b - firstBlock] = blockSumF(lanes, data + start, len, lo, hi, mode);
+    }
+}
+
+static double sumAll(lanes_d_t lanes, const double *data, size_t n, double lo, double hi, int mode) {
+    double s = 0.0, c = 0.0;
+    for (size_t start = 0; start < n; start += CLAMPSUM_BLOCK) {
+        size_t len = n - start < CLAMPSUM_BLOCK ? n - start : CLAMPSUM_BLOCK;
+        struct ClampSumPartial part = blockSum(lanes, data + start, len, lo, hi, mode);
+        addPair(&s, &c, part.sum, part.comp, mode);
+    }
+    return mode == CLAMPSUM_NEUMAIER ? s + c : s;
+}
+
+static float sumAllF(lanes_f_t lanes, const float *data, size_t n, float lo, float hi, int mode) {
+    float s = 0.0f, c = 0.0f;
+    for (size_t start = 0; start < n; start += CLAMPSUM_BLOCK) {
+        size_t len = n - start < CLAMPSUM_BLOCK ? n - start : CLAMPSUM_BLOCK;
+        struct ClampSumPartialF part = blockSumF(lanes, data + start, len, lo, hi, mode);
+        addPairF(&s, &c, part.sum, part.comp, mode);
+    }
+    return mode == CLAMPSUM_NEUMAIER ? s + c : s;
+}
+
+// === Whole-array kernels ===
+double clampSumScalar(const double *data, size_t n, double min, double max, int mode) {
+    return sumAll(lanesScalar, data, n, min, max, mode);
+}
+
+double clampSumAvx2(const double *data, size_t n, double min, double max, int mode) {
+    return sumAll(lanesAvx2, data, n, min, max, mode);
+}
+
+double clampSumAvx512(const double *data, size_t n, double min, double max, int mode) {
+    return sumAll(lanesAvx512, data, n, min, max, mode);
+}
+
+float clampSumFScalar(const float *data, size_t n, float min, float max, int mode) {
+    return sumAllF(lanesScalarF, data, n, min, max, mode);
+}
+
+float clampSumFAvx2(const float *data, size_t n, float min, float max, int mode) {
+    return sumAllF(lanesAvx2F, data, n, min, max, mode);
+}
+
+float clampSumFAvx512(const float *data, size_t n, float min, float max, int mode) {
+    return sumAllF(lanesAvx512F, data, n, min, max, mode);
+}
+
+// === Block API ===
+static void clampSumBlocksScalar(const double *data, size_t n, double min, double max, int mode,
+                                 size_t firstBlock, size_t lastBlock, struct ClampSumPartial *out) {
+    blocks(lanesScalar, data, n, min, max, mode, firstBlock, lastBlock, out);
+}
+
+static void clampSumBlocksAvx2(const double *data, size_t n, double min, double max, int mode,
+                               size_t firstBlock, size_t lastBlock, struct ClampSumPartial *out) {
+    blocks(lanesAvx2, data, n, min, max, mode, firstBlock, lastBlock, out);
+}
+
+static void clampSumBlocksAvx512(const double *data, size_t n, double min, double max, int mode,
+                                 size_t firstBlock, size_t lastBlock, struct ClampSumPartial *out) {
+    blocks(lanesAvx512, data, n, min, max, mode, firstBlock, lastBlock, out);
+}
+
+static void clampSumBlocksFScalar(const float *data, size_t n, float min, float max, int mode,
+                                  size_t firstBlock, size_t lastBlock, struct ClampSumPartialF *out) {
+    blocksF(lanesScalarF, data, n, min, max, mode, firstBlock, lastBlock, out);
+}
+
+static void clampSumBlocksFAvx2(const float *data, size_t n, float min, float max, int mode,
+                                size_t firstBlock, size_t lastBlock, struct ClampSumPartialF *out) {
+    blocksF(lanesAvx2F, data, n, min, max, mode, firstBlock, lastBlock, out);
+}
+
+static void clampSumBlocksFAvx512(const float *data, size_t n, float min, float max, int mode,
+                                  size_t firstBlock, size_t lastBlock, struct ClampSumPartialF *out) {
+    blocksF(lanesAvx512F, data, n, min, max, mode, firstBlock, lastBlock, out);
+}
+
+double clampSumCombine(const struct ClampSumPartial *parts, size_t count, int mode) {
+    double s = 0.0, c = 0.0;
+    for (size_t b = 0; b < count; ++b)
+        addPair(&s, &c, parts[b].sum, parts[b].comp, mode);
+    return mode == CLAMPSUM_NEUMAIER ? s + c : s;
+}
+
+float clampSumCombineF(const struct ClampSumPartialF *parts, size_t count, int mode) {
+    float s = 0.0f, c = 0.0f;
+    for (size_t b = 0; b < count; ++b)
+        addPairF(&s, &c, parts[b].sum, parts[b].comp, mode);
+    return mode == CLAMPSUM_NEUMAIER ? s + c : s;
+}
+
+// === Dispatch ===
+static double (*clampSum_resolve(void))(const double *, size_t, double, double, int) {
+    if (cpuHas(CPU_AVX512BW)) return clampSumAvx512;
+    if (cpuHas(CPU_AVX2)) return clampSumAvx2;
+    return clampSumScalar;
+}
+
+BL_DISPATCH(double, clampSum, (const double *data, size_t n, double min, double max, int mode),
+            (data, n, min, max, mode))
+
+static float (*clampSumF_resolve(void))(const float *, size_t, float, float, int) {
+    if (cpuHas(CPU_AVX512BW)) return clampSumFAvx512;
+    if (cpuHas(CPU_AVX2)) return clampSumFAvx2;
+    return clampSumFScalar;
+}
+
+BL_DISPATCH(float, clampSumF, (const float *data, size_t n, float min, float max, int mode),
+            (data, n, min, max, mode))
+
+static void (*clampSumBlocks_resolve(void))(const double *, size_t, double, double, int,
+                                            size_t, size_t, struct ClampSumPartial *) {
+    if (cpuHas(CPU_AVX512BW)) return clampSumBlocksAvx512;
+    if (cpuHas(CPU_AVX2)) return clampSumBlocksAvx2;
+    return clampSumBlocksScalar;
+}
+
+BL_DISPATCH_VOID(clampSumBlocks, (const double *data, size_t n, double min, double max, int mode,
+                                  size_t firstBlock, size_t lastBlock, struct ClampSumPartial *out),
+                 (data, n, min, max, mode, firstBlock, lastBlock, out))
+
+static void (*clampSumBlocksF_resolve(void))(const float *, size_t, float, float, int,
+                                             size_t, size_t, struct ClampSumPartialF *) {
+    if (cpuHas(CPU_AVX512BW)) return clampSumBlocksFAvx512;
+    if (cpuHas(CPU_AVX2)) return clampSumBlocksFAvx2;
+    return clampSumBlocksFScalar;
+}
+
+BL_DISPATCH_VOID(clampSumBlocksF, (const float *data, size_t n, float min, float max, int mode,
+                                   size_t firstBlock, size_t lastBlock, struct ClampSumPartialF *out),
+                 (data, n, min, max, mode, firstBlock, lastBlock, out))
@@ -0,0 +1,112 @@
+#ifndef BRANCHLESS_INTERNAL_H
+#define BRANCHLESS_INTERNAL_H
+
+#define BRANCHLESS_BUILD
+#include "branchless.h"
+#include "branchless_inline.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+// === Runtime dispatch ===
+// BL_DISPATCH(ret, name, params, args) defines the exported `name` so that
+// it forwards to whatever `name##_resolve()` returns; the resolver must be
+// defined (static) in the same file and return a function pointer.
+//
+// On ELF targets this is a GNU ifunc: the dynamic loader (or the static
+// startup code, for -static) calls the resolver once and binds the symbol
+// directly, so there is no per-call indirection. Elsewhere (PE, Mach-O)
+// the first call resolves through CPUID and caches the pointer.
+// Define BL_NO_IFUNC to force the pointer path on ELF as well.
+
+#if defined(__ELF__) && defined(__GNUC__) && !defined(BL_NO_IFUNC)
+
+#define BL_DISPATCH(ret, name, params, args)                        \
+    static ret (*name##_resolve(void)) params;                      \
+    ret name params __attribute__((ifunc(#name "_resolve")));
+
+#define BL_DISPATCH_VOID(name, params, args)                        \
+    BL_DISPATCH(void, name, params, args)
+
+#else
+
+#define BL_DISPATCH(ret, name, params, args)                        \
+    static ret (*name##_resolve(void)) params;                      \
+    static ret (*volatile name##_ptr) params;                       \
+    ret name params {                                               \
+        if (!name##_ptr) name##_ptr = name##_resolve();             \
+        return name##_ptr args;                                     \
+    }
+
+#define BL_DISPATCH_VOID(name, params, args)                        \
+    static void (*name##_resolve(void)) params;                     \
+    static void (*volatile name##_ptr) params;                      \
+    void name params {                                              \
+        if (!name##_ptr) name##_ptr = name##_resolve();             \
+        name##_ptr args;                                            \
+    }
+
+#endif
+
+// Feature test behind cpuSupports. Resolvers call this one rather than
+// the exported function: an ifunc resolver runs while the library is
+// still being relocated, so it must not go through the PLT, and it runs
+// before constructors, so it initialises the feature bits itself.
+static inline int cpuHas(int cpu) {
+    __builtin_cpu_init();
+    switch (cpu) {
+    case CPU_AVX2:
+        return __builtin_cpu_supports("avx2");
+    case CPU_AVX512BW:
+        return __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("bmi2");
+    case CPU_AVX512VBMI:
+        return __builtin_cpu_supports("avx512vbmi") && __builtin_cpu_supports("avx512bw") &&
+               __builtin_cpu_supports("bmi2");
+    default:
+        return 1;
+    }
+}
+
+// === Shared folding primitives ===
+static const uint64_t ONES = 0x0101010101010101ULL;
+
+static inline uint64_t load64(const char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store64(char *p, uint64_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+// Scalar fold: the branchlessUpperCase2 mask applied to a single byte.
+static inline unsigned char foldByte(unsigned char c) {
+    return c - 32 * (c >= 'a' && c <= 'z');
+}
+
+// SWAR fold of 8 bytes at once; the body lives in branchless_inline.h so
+// the header-only C++ layer can inline it too.
+static inline uint64_t foldWord(uint64_t x) {
+    return swarFoldInline(x);
+}
+
+// AVX2 fold of 32 bytes. Signed compares are fine here: bytes >= 0x80 are
+// negative and never pass the `> 'a' - 1` test.
+__attribute__((target("avx2")))
+static inline __m256i foldVec(__m256i v) {
+    __m256i geA = _mm256_cmpgt_epi8(v, _mm256_set1_epi8('a' - 1));
+    __m256i leZ = _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), v);
+    __m256i bit = _mm256_and_si256(_mm256_and_si256(geA, leZ), _mm256_set1_epi8(0x20));
+    return _mm256_sub_epi8(v, bit);
+}
+
+// AVX-512BW fold of 64 bytes: v - 'a' <= 25 (unsigned) marks lowercase.
+__attribute__((target("avx512bw")))
+static inline __mmask64 lowerMask512(__m512i v) {
+    return _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, _mm512_set1_epi8('a')),
+                                  _mm512_set1_epi8('z' - 'a'));
+}
+
+#endif // BRANCHLESS_INTERNAL_H
@@ -0,0 +1,163 @@
+#include "internal.h"
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// === Storage ===
+// Both layouts want their keys on a cache-line boundary. An empty
+// k-ary tree still gets one line, so NULL always means out of memory.
+static uint32_t *allocKeys(size_t count) {
+    size_t bytes = (count * sizeof(uint32_t) + 63) & ~(size_t)63;
+    if (bytes == 0) bytes = 64;
+#ifdef _WIN32
+    return _aligned_malloc(bytes, 64);
+#else
+    void *p;
+    return posix_memalign(&p, 64, bytes) == 0 ? p : NULL;
+#endif
+}
+
+static void freeKeys(uint32_t *keys) {
+#ifdef _WIN32
+    _aligned_free(keys);
+#else
+    free(keys);
+#endif
+}
+
+// === Sorted array ===
+size_t lowerBoundBranchy(const uint32_t *a, size_t n, uint32_t key) {
+    return lowerBoundBranchyInline(a, n, key);
+}
+
+size_t lowerBoundBranchless(const uint32_t *a, size_t n, uint32_t key) {
+    return lowerBoundBranchlessInline(a, n, key);
+}
+
+// === Eytzinger layout ===
+// In-order walk of the implicit tree, taking the sorted keys in order.
+// The depth is log2(n), so recursion is fine.
+static size_t eytzingerFill(uint32_t *keys, size_t n, const uint32_t *sorted, size_t i, size_t k) {
+    if (k <= n) {
+        i = eytzingerFill(keys, n, sorted, i, 2 * k);
+        keys[k] = sorted[i++];
+        i = eytzingerFill(keys, n, sorted, i, 2 * k + 1);
+    }
+    return i;
+}
+
+int eytzingerInit(struct Eytzinger *t, const uint32_t *sorted, size_t n) {
+    t->n = n;
+    t->keys = allocKeys(n + 1);
+    if (!t->keys) return -1;
+    t->keys[0] = 0;
+    eytzingerFill(t->keys, n, sorted, 0, 1);
+    return 0;
+}
+
+void eytzingerFree(struct Eytzinger *t) {
+    freeKeys(t->keys);
+    t->keys = NULL;
+    t->n = 0;
+}
+
+// Every step goes right when keys[k] < key, so the answer is the last
+// node where the walk went left: strip the trailing 1 bits (right turns)
+// and the 0 before them. k ends as 0 when it never went left. The
+// prefetch is for k's descendants four levels down, 16k .. 16k + 15;
+// past the end it is harmless and issued as an address, not a load.
+const uint32_t *eytzingerLowerBound(const struct Eytzinger *t, uint32_t key) {
+    const uint32_t *keys = t->keys;
+    size_t k = 1;
+    while (k <= t->n) {
+        __builtin_prefetch((const void *)((uintptr_t)keys + k * 16 * sizeof(uint32_t)));
+        k = 2 * k + (keys[k] < key);
+    }
+    k >>= __builtin_ctzll(~(unsigned long long)k) + 1;
+    return k ? keys + k : NULL;
+}
+
+// === K-ary tree ===
+static inline size_t karyChild(size_t k, size_t i) {
+    return k * (KARY_KEYS + 1) + i + 1;
+}
+
+// In-order walk again: child 0, key 0, child 1, key 1, ... child 16. The
+// slots left over once the keys run out are padding.
+static size_t karyFill(struct KaryTree *t, const uint32_t *sorted, size_t i, size_t k) {
+    if (k < t->nodes) {
+        for (size_t j = 0; j < KARY_KEYS; ++j) {
+            i = karyFill(t, sorted, i, karyChild(k, j));
+            t->keys[k * KARY_KEYS + j] = i < t->n ? sorted[i++] : UINT32_MAX;
+        }
+        i = karyFill(t, sorted, i, karyChild(k, KARY_KEYS));
+    }
+    return i;
+}
+
+int karyInit(struct KaryTree *t, const uint32_t *sorted, size_t n) {
+    t->n = n;
+    t->nodes = (n + KARY_KEYS - 1) / KARY_KEYS;
+    t->maxKey = n ? sorted[n - 1] : 0;
+    t->keys = allocKeys(t->nodes * KARY_KEYS);
+    if (!t->keys) return -1;
+    karyFill(t, sorted, 0, 0);
+    return 0;
+}
+
+void karyFree(struct KaryTree *t) {
+    freeKeys(t->keys);
+    t->keys = NULL;
+    t->n = t->nodes = 0;
+}
+
+// Per node: i = number of keys < key, which is both the slot of the
+// candidate answer and the child to descend into. The candidate is kept
+// only when i < KARY_KEYS; the padding is only ever a candidate when
+// every real key is smaller, which the final maxKey test catches.
+const uint32_t *karyLowerBoundScalar(const struct KaryTree *t, uint32_t key) {
+    const uint32_t *res = NULL;
+    size_t k = 0;
+    while (k < t->nodes) {
+        const uint32_t *node = t->keys + k * KARY_KEYS;
+        size_t i = 0;
+        for (int j = 0; j < KARY_KEYS; ++j)
+            i += node[j] < key;
+        res = i < KARY_KEYS ? node + i : res;
+        k = karyChild(k, i);
+    }
+    return key > t->maxKey ? NULL : res;
+}
+
+// a >= key is max(a, key) == a: AVX2 has no unsigned compare.
+__attribute__((target("avx2")))
+const uint32_t *karyLowerBoundAvx2(const struct KaryTree *t, uint32_t key) {
+    const __m256i x = _mm256_set1_epi32((int)key);
+    const uint32_t *res = NULL;
+    size_t k = 0;
+    while (k < t->nodes) {
+        const uint32_t *node = t->keys + k * KARY_KEYS;
+        __m256i lo = _mm256_load_si256((const __m256i *)node);
+        __m256i hi = _mm256_load_si256((const __m256i *)(node + 8));
+        __m256i geLo = _mm256_cmpeq_epi32(_mm256_max_epu32(lo, x), lo);
+        __m256i geHi = _mm256_cmpeq_epi32(_mm256_max_epu32(hi, x), hi);
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(geLo)) |
+                        (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(geHi)) << 8 |
+                        1u << KARY_KEYS;
+        size_t i = (size_t)__builtin_ctz(mask);
+        res = i < KARY_KEYS ? node + i : res;
+        k = karyChild(k, i);
+    }
+    return key > t->maxKey ? NULL : res;
+}
+
+// === Dispatch ===
+static const uint32_t *(*karyLowerBound_resolve(void))(const struct KaryTree *, uint32_t) {
+    if (cpuHas(CPU_AVX2)) return karyLowerBoundAvx2;
+    return karyLowerBoundScalar;
+}
+
+BL_DISPATCH(const uint32_t *, karyLowerBound, (const struct KaryTree *t, uint32_t key), (t, key))
@@ -0,0 +1,64 @@
+#include "internal.h"
+
+#include <stdlib.h>
+
+#define MAX_BLOB ((size_t)UINT32_MAX)
+
+// === Storage ===
+static int reserve(struct StrTable *t, size_t count, size_t bytes) {
+    if (bytes > MAX_BLOB) return -1;
+    if (count > t->capacity) {
+        uint32_t *offsets = realloc(t->offsets, (count + 1) * sizeof(uint32_t));
+        if (!offsets) return -1;
+        if (!t->offsets) offsets[0] = 0;
+        t->offsets = offsets;
+        t->capacity = count;
+    }
+    if (bytes > t->blobCapacity) {
+        char *blob = realloc(t->blob, bytes);
+        if (!blob) return -1;
+        t->blob = blob;
+        t->blobCapacity = bytes;
+    }
+    return 0;
+}
+
+int strTableInit(struct StrTable *t, size_t count, size_t bytes) {
+    memset(t, 0, sizeof(*t));
+    if (reserve(t, count ? count : 16, bytes ? bytes : 256) != 0) {
+        strTableFree(t);
+        return -1;
+    }
+    return 0;
+}
+
+// Doubling growth, capped at the 4 GiB offset range.
+int strTableAppend(struct StrTable *t, const char *s, size_t len) {
+    size_t used = t->offsets[t->count];
+    size_t need = used + len + 1;
+    if (need > MAX_BLOB) return -1;
+    size_t count = t->count + 1 > t->capacity ? t->capacity * 2 : t->capacity;
+    size_t bytes = need > t->blobCapacity ? t->blobCapacity * 2 : t->blobCapacity;
+    if (bytes < need) bytes = need;
+    if (bytes > MAX_BLOB) bytes = MAX_BLOB;
+    if (reserve(t, count, bytes) != 0) return -1;
+
+    memcpy(t->blob + used, s, len);
+    t->blob[used + len] = '\0';
+    t->offsets[++t->count] = (uint32_t)need;
+    return 0;
+}
+
+void strTableFree(struct StrTable *t) {
+    free(t->offsets);
+    free(t->blob);
+    memset(t, 0, sizeof(*t));
+}
+
+// === Batch kernels ===
+// Uppercasing leaves every byte outside 'a'..'z' alone, so the blob can
+// be treated as one string: the vector loop runs straight across the
+// boundaries and only the very end of the blob takes the tail path.
+void strTableUpperCase(struct StrTable *t) {
+    upperCase(t->blob, t->offsets[t->count]);
+}
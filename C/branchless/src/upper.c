@@ -0,0 +1,221 @@
+#include "internal.h"
+
+int branchlessVersion(void) {
+    return BRANCHLESS_VERSION;
+}
+
+// === CPU features ===
+int cpuSupports(int cpu) {
+    return cpuHas(cpu);
+}
+
+const char *cpuName(int cpu) {
+    switch (cpu) {
+    case CPU_AVX2:       return "avx2";
+    case CPU_AVX512BW:   return "avx512bw";
+    case CPU_AVX512VBMI: return "avx512vbmi";
+    default:             return "any";
+    }
+}
+
+// === NUL-terminated kernels ===
+void obviouseUpperCase(char *str) {
+    obviouseUpperCaseInline(str);
+}
+
+void branchlessUpperCase1(char *str) {
+    branchlessUpperCase1Inline(str);
+}
+
+void branchlessUpperCase2(char *str) {
+    branchlessUpperCase2Inline(str);
+}
+
+// === Length-based scalar kernels ===
+void obviouseUpperCaseN(char *str, size_t len) {
+    for (size_t i = 0; i < len; ++i)
+        if (str[i] >= 'a' && str[i] <= 'z')
+            str[i] -= 32;
+}
+
+void branchlessUpperCase1N(char *str, size_t len) {
+    for (size_t i = 0; i < len; ++i)
+        str[i] = (str[i] * !(str[i] >= 'a' && str[i] <= 'z')) +
+                 (str[i] - 32) * (str[i] >= 'a' && str[i] <= 'z');
+}
+
+void branchlessUpperCase2N(char *str, size_t len) {
+    branchlessUpperCase2NInline(str, len);
+}
+
+// 256 entries expanded by the preprocessor, so the table sits in .rodata
+// with no initialisation code and the compiler can see every value.
+#define UP(c)     ((c) >= 'a' && (c) <= 'z' ? (c) - 32 : (c))
+#define UP4(c)    UP(c), UP((c) + 1), UP((c) + 2), UP((c) + 3)
+#define UP16(c)   UP4(c), UP4((c) + 4), UP4((c) + 8), UP4((c) + 12)
+#define UP64(c)   UP16(c), UP16((c) + 16), UP16((c) + 32), UP16((c) + 48)
+
+static const unsigned char upperLut[256] __attribute__((aligned(64))) = {
+    UP64(0), UP64(64), UP64(128), UP64(192)
+};
+
+void lutUpperCase(char *str, size_t len) {
+    unsigned char *s = (unsigned char *)str;
+    for (size_t i = 0; i < len; ++i)
+        s[i] = upperLut[s[i]];
+}
+
+void swarUpperCase(char *str, size_t len) {
+    swarUpperCaseInline(str, len);
+}
+
+// === Vector kernels ===
+// Nibble tables for the vpshufb classifier, high nibble first, then low.
+// A byte is lowercase when (hi[c >> 4] & lo[c & 15]) != 0:
+//   bit 0: hi == 6 and lo in 1..F   ('a'..'o')
+//   bit 1: hi == 7 and lo in 0..A   ('p'..'z')
+static const unsigned char nibbleClass[32] __attribute__((aligned(32))) = {
+    0, 0, 0, 0, 0, 0, 1, 2, 0, 0, 0, 0, 0, 0, 0, 0,
+    2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 1, 1, 1, 1
+};
+
+__attribute__((target("avx2")))
+void pshufbUpperCase(char *str, size_t len) {
+    const __m256i hiTab = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)nibbleClass));
+    const __m256i loTab = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)(nibbleClass + 16)));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(str + i));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+        __m256i lo = _mm256_and_si256(v, nibble);
+        __m256i cls = _mm256_and_si256(_mm256_shuffle_epi8(hiTab, hi),
+                                       _mm256_shuffle_epi8(loTab, lo));
+        __m256i lower = _mm256_andnot_si256(_mm256_cmpeq_epi8(cls, zero), caseBit);
+        _mm256_storeu_si256((__m256i *)(str + i), _mm256_sub_epi8(v, lower));
+    }
+    lutUpperCase(str + i, len - i);
+}
+
+__attribute__((target("avx2")))
+void avx2UpperCase(char *str, size_t len) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(str + i));
+        _mm256_storeu_si256((__m256i *)(str + i), foldVec(v));
+    }
+    swarUpperCase(str + i, len - i);
+}
+
+// Masked loads/stores handle the tail without a scalar loop.
+__attribute__((target("avx512bw,bmi2")))
+void avx512UpperCase(char *str, size_t len) {
+    const __m512i caseBit = _mm512_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i v = _mm512_loadu_si512((const void *)(str + i));
+        _mm512_storeu_si512((void *)(str + i), _mm512_mask_sub_epi8(v, lowerMask512(v), v, caseBit));
+    }
+    if (i < len) {
+        __mmask64 m = _bzhi_u64(~0ULL, (unsigned)(len - i));
+        __m512i v = _mm512_maskz_loadu_epi8(m, str + i);
+        _mm512_mask_storeu_epi8(str + i, lowerMask512(v) & m, _mm512_sub_epi8(v, caseBit));
+    }
+}
+
+// vpermi2b indexes 128 bytes held in two registers by the low 7 bits of
+// each input byte; two of them cover the 256-entry table, and bit 7
+// picks the half.
+__attribute__((target("avx512bw,avx512vbmi,bmi2")))
+void vpermbUpperCase(char *str, size_t len) {
+    const __m512i t0 = _mm512_load_si512((const void *)(upperLut + 0));
+    const __m512i t1 = _mm512_load_si512((const void *)(upperLut + 64));
+    const __m512i t2 = _mm512_load_si512((const void *)(upperLut + 128));
+    const __m512i t3 = _mm512_load_si512((const void *)(upperLut + 192));
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i v = _mm512_loadu_si512((const void *)(str + i));
+        __m512i low = _mm512_permutex2var_epi8(t0, v, t1);
+        __m512i high = _mm512_permutex2var_epi8(t2, v, t3);
+        v = _mm512_mask_blend_epi8(_mm512_movepi8_mask(v), low, high);
+        _mm512_storeu_si512((void *)(str + i), v);
+    }
+    if (i < len) {
+        __mmask64 m = _bzhi_u64(~0ULL, (unsigned)(len - i));
+        __m512i v = _mm512_maskz_loadu_epi8(m, str + i);
+        __m512i low = _mm512_permutex2var_epi8(t0, v, t1);
+        __m512i high = _mm512_permutex2var_epi8(t2, v, t3);
+        v = _mm512_mask_blend_epi8(_mm512_movepi8_mask(v), low, high);
+        _mm512_mask_storeu_epi8(str + i, m, v);
+    }
+}
+
+// === Lowercase (1.1) ===
+// The same folds with the range moved to 'A'..'Z' and the case bit set
+// instead of cleared.
+static inline uint64_t unfoldWord(uint64_t x) {
+    uint64_t heptets = x & (0x7F * ONES);
+    uint64_t geA = heptets + ((0x80 - 'A') * ONES);
+    uint64_t gtZ = heptets + ((0x80 - 'Z' - 1) * ONES);
+    uint64_t upper = (geA ^ gtZ) & ~x & (0x80 * ONES);
+    return x | (upper >> 2);
+}
+
+void swarLowerCase(char *str, size_t len) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8)
+        store64(str + i, unfoldWord(load64(str + i)));
+    for (; i < len; ++i) {
+        unsigned char c = (unsigned char)str[i];
+        str[i] = (char)(c + 32 * (c >= 'A' && c <= 'Z'));
+    }
+}
+
+__attribute__((target("avx2")))
+void avx2LowerCase(char *str, size_t len) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(str + i));
+        __m256i geA = _mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1));
+        __m256i leZ = _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v);
+        __m256i bit = _mm256_and_si256(_mm256_and_si256(geA, leZ), _mm256_set1_epi8(0x20));
+        _mm256_storeu_si256((__m256i *)(str + i), _mm256_or_si256(v, bit));
+    }
+    swarLowerCase(str + i, len - i);
+}
+
+// === Dispatch ===
+static upper_func_t upperCase_resolve(void) {
+    if (cpuHas(CPU_AVX512BW)) return avx512UpperCase;
+    if (cpuHas(CPU_AVX2)) return avx2UpperCase;
+    return swarUpperCase;
+}
+
+BL_DISPATCH_VOID(upperCase, (char *str, size_t len), (str, len))
+
+static upper_func_t lowerCase_resolve(void) {
+    if (cpuHas(CPU_AVX2)) return avx2LowerCase;
+    return swarLowerCase;
+}
+
+BL_DISPATCH_VOID(lowerCase, (char *str, size_t len), (str, len))
+
+// === Registry ===
+static const struct UpperKernel registry[] = {
+    {"obviouse",    obviouseUpperCaseN,    CPU_ANY,        NULL,        0},
+    {"branchless1", branchlessUpperCase1N, CPU_ANY,        NULL,        0},
+    {"branchless2", branchlessUpperCase2N, CPU_ANY,        NULL,        0},
+    {"lut",         lutUpperCase,          CPU_ANY,        upperLut,    sizeof(upperLut)},
+    {"swar",        swarUpperCase,         CPU_ANY,        NULL,        0},
+    {"pshufb",      pshufbUpperCase,       CPU_AVX2,       nibbleClass, sizeof(nibbleClass)},
+    {"avx2",        avx2UpperCase,         CPU_AVX2,       NULL,        0},
+    {"avx512bw",    avx512UpperCase,       CPU_AVX512BW,   NULL,        0},
+    {"vpermb",      vpermbUpperCase,       CPU_AVX512VBMI, upperLut,    sizeof(upperLut)}
+};
+
+const struct UpperKernel *upperKernels(int *count) {
+    *count = (int)(sizeof(registry) / sizeof(registry[0]));
+    return registry;
+}
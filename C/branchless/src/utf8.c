@@ -0,0 +1,205 @@
+#include "internal.h"
+
+// === Simple case mapping ===
+// Lowercase -> uppercase for ASCII, Latin-1 Supplement, Latin Extended-A,
+// Greek and Cyrillic. Only mappings that keep the UTF-8 length are listed,
+// so the transform can run in place: U+00DF (sharp s), U+0131 (dotless i)
+// and U+017F (long s) uppercase into a different length and stay as-is.
+static uint32_t upperCodePoint(uint32_t c) {
+    if (c >= 'a' && c <= 'z') return c - 32;
+    if (c < 0x80) return c;
+    // Latin-1 Supplement
+    if (c == 0xB5) return 0x39C;
+    if (c >= 0xE0 && c <= 0xFE && c != 0xF7) return c - 32;
+    if (c == 0xFF) return 0x178;
+    // Latin Extended-A: alternating upper/lower pairs
+    if (c >= 0x100 && c <= 0x12F) return c & 1 ? c - 1 : c;
+    if (c >= 0x132 && c <= 0x137) return c & 1 ? c - 1 : c;   // not U+0131
+    if (c >= 0x139 && c <= 0x148) return c & 1 ? c : c - 1;
+    if (c >= 0x14A && c <= 0x177) return c & 1 ? c - 1 : c;
+    if (c >= 0x179 && c <= 0x17E) return c & 1 ? c : c - 1;
+    // Greek
+    if (c == 0x3AC) return 0x386;
+    if (c >= 0x3AD && c <= 0x3AF) return c - 37;
+    if (c == 0x3C2) return 0x3A3;
+    if (c >= 0x3B1 && c <= 0x3CB) return c - 32;
+    if (c == 0x3CC) return 0x38C;
+    if (c == 0x3CD || c == 0x3CE) return c - 63;
+    // Cyrillic
+    if (c >= 0x430 && c <= 0x44F) return c - 32;
+    if (c >= 0x450 && c <= 0x45F) return c - 80;
+    if (c >= 0x460 && c <= 0x481) return c & 1 ? c - 1 : c;
+    if (c >= 0x48A && c <= 0x4BF) return c & 1 ? c - 1 : c;
+    if (c >= 0x4C1 && c <= 0x4CE) return c & 1 ? c : c - 1;
+    if (c == 0x4CF) return 0x4C0;
+    if (c >= 0x4D0 && c <= 0x4FF) return c & 1 ? c - 1 : c;
+    return c;
+}
+
+// Every two-byte code point (U+0080..U+07FF) mapped once at startup, so
+// the multi-byte path is a load instead of the range chain above.
+static uint16_t upperTable2[0x800];
+
+// Length of the sequence a lead byte starts, 1 for continuation and
+// invalid bytes so that malformed input is passed through byte by byte.
+static uint8_t seqLen[256];
+
+// Runs at load time; the dispatch resolver never touches the tables.
+__attribute__((constructor))
+static void initTables(void) {
+    for (uint32_t c = 0; c < 0x800; ++c)
+        upperTable2[c] = (uint16_t)upperCodePoint(c);
+    for (int b = 0; b < 256; ++b)
+        seqLen[b] = b >= 0xF0 && b <= 0xF4 ? 4
+                  : b >= 0xE0 && b <= 0xEF ? 3
+                  : b >= 0xC2 && b <= 0xDF ? 2
+                  : 1;
+}
+
+static inline int isCont(unsigned char b) {
+    return (b & 0xC0) == 0x80;
+}
+
+// === Baseline ===
+// Decode every character, map it through the range chain, re-encode.
+void naiveUtf8UpperCase(char *str, size_t len) {
+    unsigned char *s = (unsigned char *)str;
+    size_t i = 0;
+    while (i < len) {
+        unsigned char b = s[i];
+        if (b < 0x80) {
+            s[i] = (unsigned char)upperCodePoint(b);
+            i += 1;
+        } else if (b >= 0xC2 && b <= 0xDF && i + 1 < len && isCont(s[i + 1])) {
+            uint32_t c = ((uint32_t)(b & 0x1F) << 6) | (s[i + 1] & 0x3F);
+            uint32_t u = upperCodePoint(c);
+            s[i] = (unsigned char)(0xC0 | (u >> 6));
+            s[i + 1] = (unsigned char)(0x80 | (u & 0x3F));
+            i += 2;
+        } else if (b >= 0xE0 && b <= 0xEF && i + 2 < len && isCont(s[i + 1]) && isCont(s[i + 2])) {
+            i += 3;
+        } else if (b >= 0xF0 && b <= 0xF4 && i + 3 < len && isCont(s[i + 1]) && isCont(s[i + 2]) && isCont(s[i + 3])) {
+            i += 4;
+        } else {
+            i += 1;
+        }
+    }
+}
+
+// === Table-driven engine ===
+// Multi-byte path: handles one character starting at s[i] (which may be
+// ASCII too) and returns the index just past it. Two-byte sequences are
+// rewritten unconditionally from the table; longer ones are skipped.
+static inline size_t upperOneChar(unsigned char *s, size_t i, size_t len) {
+    unsigned char b = s[i];
+    size_t n = seqLen[b];
+    if (n == 1) {
+        s[i] = b - 32 * (b >= 'a' && b <= 'z');
+        return i + 1;
+    }
+    if (i + n > len) return i + 1;
+    for (size_t k = 1; k < n; ++k)
+        if (!isCont(s[i + k])) return i + 1;
+    if (n == 2) {
+        uint32_t u = upperTable2[((uint32_t)(b & 0x1F) << 6) | (s[i + 1] & 0x3F)];
+        s[i] = (unsigned char)(0xC0 | (u >> 6));
+        s[i + 1] = (unsigned char)(0x80 | (u & 0x3F));
+    }
+    return i + n;
+}
+
+void tableUtf8UpperCase(char *str, size_t len) {
+    unsigned char *s = (unsigned char *)str;
+    size_t i = 0;
+    while (i < len)
+        i = upperOneChar(s, i, len);
+}
+
+// Multi-byte path for the block kernels: rewrites the two-byte character
+// whose lead byte sits at s[p], if there is one. Continuation bytes and
+// leads of longer sequences are left alone, which matches the decoder: a
+// valid two-byte lead can never be swallowed by another sequence, since
+// only 0x80..0xBF bytes are ever consumed as continuations.
+static inline void upperTwoByte(unsigned char *s, size_t p, size_t len) {
+    unsigned char b = s[p];
+    if (seqLen[b] == 2 && p + 1 < len && isCont(s[p + 1])) {
+        uint32_t u = upperTable2[((uint32_t)(b & 0x1F) << 6) | (s[p + 1] & 0x3F)];
+        s[p] = (unsigned char)(0xC0 | (u >> 6));
+        s[p + 1] = (unsigned char)(0x80 | (u & 0x3F));
+    }
+}
+
+// The fast paths below share one shape: every block goes through the
+// vector ASCII fold, which never touches bytes >= 0x80. Blocks with no
+// high bit set are done after that; otherwise only the positions in the
+// high-bit mask are walked with upperTwoByte. A character straddling the
+// block end is rewritten before the next block is loaded.
+void swarUtf8UpperCase(char *str, size_t len) {
+    unsigned char *s = (unsigned char *)str;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t x;
+        memcpy(&x, s + i, 8);
+        uint64_t high = x & 0x8080808080808080ULL;
+        x = foldWord(x);
+        memcpy(s + i, &x, 8);
+        while (high) {
+            upperTwoByte(s, i + (__builtin_ctzll(high) >> 3), len);
+            high &= high - 1;
+        }
+    }
+    while (i < len)
+        i = upperOneChar(s, i, len);
+}
+
+__attribute__((target("avx2")))
+void avx2Utf8UpperCase(char *str, size_t len) {
+    unsigned char *s = (unsigned char *)str;
+    const __m256i aMinus1 = _mm256_set1_epi8('a' - 1);
+    const __m256i zPlus1 = _mm256_set1_epi8('z' + 1);
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+        unsigned high = (unsigned)_mm256_movemask_epi8(v);
+        __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(v, aMinus1),
+                                         _mm256_cmpgt_epi8(zPlus1, v));
+        v = _mm256_sub_epi8(v, _mm256_and_si256(lower, caseBit));
+        _mm256_storeu_si256((__m256i *)(s + i), v);
+        while (high) {
+            upperTwoByte(s, i + __builtin_ctz(high), len);
+            high &= high - 1;
+        }
+    }
+    swarUtf8UpperCase((char *)s + i, len - i);
+}
+
+__attribute__((target("avx512bw")))
+void avx512Utf8UpperCase(char *str, size_t len) {
+    unsigned char *s = (unsigned char *)str;
+    const __m512i a = _mm512_set1_epi8('a');
+    const __m512i range = _mm512_set1_epi8('z' - 'a');
+    const __m512i caseBit = _mm512_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i v = _mm512_loadu_si512((const void *)(s + i));
+        uint64_t high = _mm512_movepi8_mask(v);
+        __mmask64 lower = _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, a), range);
+        v = _mm512_mask_sub_epi8(v, lower, v, caseBit);
+        _mm512_storeu_si512((void *)(s + i), v);
+        while (high) {
+            upperTwoByte(s, i + __builtin_ctzll(high), len);
+            high &= high - 1;
+        }
+    }
+    avx2Utf8UpperCase((char *)s + i, len - i);
+}
+
+// === Dispatch ===
+static upper_func_t utf8UpperCase_resolve(void) {
+    if (cpuHas(CPU_AVX512BW)) return avx512Utf8UpperCase;
+    if (cpuHas(CPU_AVX2)) return avx2Utf8UpperCase;
+    return swarUtf8UpperCase;
+}
+
+BL_DISPATCH_VOID(utf8UpperCase, (char *str, size_t len), (str, len))
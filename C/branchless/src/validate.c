@@ -0,0 +1,103 @@
+#include "internal.h"
+
+// === Check only ===
+int asciiCheckScalar(const char *str, size_t len) {
+    const unsigned char *s = (const unsigned char *)str;
+    unsigned high = 0, ctrl = 0;
+    for (size_t i = 0; i < len; ++i) {
+        high |= s[i];
+        ctrl |= (s[i] < 0x20) | (s[i] == 0x7F);
+    }
+    return (high >> 7) * ASCII_NON_ASCII | ctrl * ASCII_CONTROL;
+}
+
+// SWAR "has a byte less than n" / "has a zero byte" tests. They can flag
+// the wrong byte inside a word (borrows), but "any byte in the word" is
+// exact, which is all a validation flag needs.
+static inline uint64_t hasLess(uint64_t x, unsigned n) {
+    return (x - ONES * n) & ~x & (ONES * 0x80);
+}
+
+static inline uint64_t hasZero(uint64_t x) {
+    return (x - ONES) & ~x & (ONES * 0x80);
+}
+
+int asciiCheckSwar(const char *str, size_t len) {
+    uint64_t high = 0, ctrl = 0;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t x = load64(str + i);
+        high |= x;
+        ctrl |= hasLess(x, 0x20) | hasZero(x ^ (ONES * 0x7F));
+    }
+    int flags = ((high & ONES * 0x80) ? ASCII_NON_ASCII : 0) | (ctrl ? ASCII_CONTROL : 0);
+    return flags | asciiCheckScalar(str + i, len - i);
+}
+
+__attribute__((target("avx2")))
+int asciiCheckAvx2(const char *str, size_t len) {
+    const __m256i ctrlMax = _mm256_set1_epi8(0x1F);
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    __m256i high = _mm256_setzero_si256(), ctrl = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(str + i));
+        high = _mm256_or_si256(high, v);
+        ctrl = _mm256_or_si256(ctrl, _mm256_cmpeq_epi8(_mm256_min_epu8(v, ctrlMax), v));
+        ctrl = _mm256_or_si256(ctrl, _mm256_cmpeq_epi8(v, del));
+    }
+    int flags = (_mm256_movemask_epi8(high) ? ASCII_NON_ASCII : 0) |
+                (_mm256_movemask_epi8(ctrl) ? ASCII_CONTROL : 0);
+    return flags | asciiCheckScalar(str + i, len - i);
+}
+
+// === Fused single pass ===
+int upperValidateScalar(char *str, size_t len) {
+    unsigned char *s = (unsigned char *)str;
+    unsigned high = 0, ctrl = 0;
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = s[i];
+        high |= c;
+        ctrl |= (c < 0x20) | (c == 0x7F);
+        s[i] = c - 32 * (c >= 'a' && c <= 'z');
+    }
+    return (high >> 7) * ASCII_NON_ASCII | ctrl * ASCII_CONTROL;
+}
+
+int upperValidateSwar(char *str, size_t len) {
+    uint64_t high = 0, ctrl = 0;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t x = load64(str + i);
+        high |= x;
+        ctrl |= hasLess(x, 0x20) | hasZero(x ^ (ONES * 0x7F));
+        store64(str + i, foldWord(x));
+    }
+    int flags = ((high & ONES * 0x80) ? ASCII_NON_ASCII : 0) | (ctrl ? ASCII_CONTROL : 0);
+    return flags | upperValidateScalar(str + i, len - i);
+}
+
+__attribute__((target("avx2")))
+int upperValidateAvx2(char *str, size_t len) {
+    const __m256i ctrlMax = _mm256_set1_epi8(0x1F);
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    __m256i high = _mm256_setzero_si256(), ctrl = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(str + i));
+        high = _mm256_or_si256(high, v);
+        ctrl = _mm256_or_si256(ctrl, _mm256_cmpeq_epi8(_mm256_min_epu8(v, ctrlMax), v));
+        ctrl = _mm256_or_si256(ctrl, _mm256_cmpeq_epi8(v, del));
+        _mm256_storeu_si256((__m256i *)(str + i), foldVec(v));
+    }
+    int flags = (_mm256_movemask_epi8(high) ? ASCII_NON_ASCII : 0) |
+                (_mm256_movemask_epi8(ctrl) ? ASCII_CONTROL : 0);
+    return flags | upperValidateScalar(str + i, len - i);
+}
+
+// === Dispatch ===
+static int (*upperValidate_resolve(void))(char *, size_t) {
+    return cpuHas(CPU_AVX2) ? upperValidateAvx2 : upperValidateSwar;
+}
+
+BL_DISPATCH(int, upperValidate, (char *str, size_t len), (str, len))
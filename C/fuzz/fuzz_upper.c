@@ -0,0 +1,63 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "diffcheck.h"
+
+// Differential fuzz target for the case-mapping kernels (see
+// bench/diffcheck.h): the first input byte picks the alignment offset,
+// the rest is fed to every kernel, and any disagreement with the
+// reference kernels, write outside the input or read past a guard page
+// aborts.
+//
+//   libFuzzer:  make fuzz && build/fuzz_upper_libfuzzer corpus/
+//   AFL++:      CC=afl-clang-fast make build/fuzz_upper
+//               afl-fuzz -i seeds -o findings -- build/fuzz_upper @@
+//   replay:     build/fuzz_upper crash-1234 ...   (or input on stdin)
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    struct DiffFailure fail;
+    if (diffCheckFuzz(data, size, &fail)) {
+        diffPrintFailure(stderr, &fail);
+        abort();
+    }
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+static int runFile(FILE *f) {
+    size_t size = 0, cap = 4096;
+    uint8_t *data = malloc(cap);
+    size_t n;
+    while (data && (n = fread(data + size, 1, cap - size, f)) > 0) {
+        size += n;
+        if (size == cap) {
+            uint8_t *grown = realloc(data, cap *= 2);
+            if (!grown) break;
+            data = grown;
+        }
+    }
+    if (!data) return 1;
+    LLVMFuzzerTestOneInput(data, size);
+    free(data);
+    return 0;
+}
+
+// Usage: fuzz_upper [files...]
+//   Runs every file as one input (stdin without arguments); exits 0 when
+//   all agree, aborts on the first disagreement.
+int main(int argc, char **argv) {
+    if (argc < 2) return runFile(stdin);
+    for (int i = 1; i < argc; ++i) {
+        FILE *f = fopen(argv[i], "rb");
+        if (!f) {
+            perror(argv[i]);
+            return 1;
+        }
+        int rc = runFile(f);
+        fclose(f);
+        if (rc) return rc;
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "branchless.h"
+#include "tsc.h"
+
+// === Random string generation ===
+void randStr(char* s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        s[i] = (rand() % 2 == 0)
+            ? ('A' + rand() % 26)
+            : ('a' + rand() % 26);
+    }
+    s[len] = '\0';
+}
+
+// === Results printing ===
+void print_table(void) {
+    printf("\n=== DISPATCH TABLE ===\n");
+    for (int b = 0; b < AUTOTUNE_BUCKETS; ++b) {
+        size_t lo = b == 0 ? 0 : (size_t)1 << (2 * b + 2);
+        if (b == AUTOTUNE_BUCKETS - 1)
+            printf("len >= %-14zu -> %s\n", lo, autotuneChoice(b)->name);
+        else
+            printf("len %6zu .. %-6zu -> %s\n", lo, ((size_t)1 << (2 * b + 4)) - 1, autotuneChoice(b)->name);
+    }
+}
+
+// upper_auto against calling the bucket's winner directly: the difference
+// is the cost of the bucket lookup and the indirect call. Both are timed
+// with the tuner's own harness (autotuneMeasure).
+void print_overhead(void) {
+    printf("\n=== DISPATCH OVERHEAD ===\n");
+    printf("%-8s %-12s %-15s %-15s %-10s\n", "Length", "Winner", "Direct (ns)", "upper_auto (ns)", "Overhead");
+    printf("-------------------------------------------------------------\n");
+    for (int b = 0; b < AUTOTUNE_BUCKETS; ++b) {
+        size_t len = autotuneProbeLen(b);
+        const struct UpperKernel *winner = autotuneChoice(b);
+        double direct = autotuneMeasure(winner->func, len);
+        double viaAuto = autotuneMeasure(upper_auto, len);
+        if (direct < 0 || viaAuto < 0) return;
+        printf("%-8zu %-12s %-15.2f %-15.2f %+.2f ns/call\n",
+               len, winner->name, direct, viaAuto, viaAuto - direct);
+    }
+    printf("\n");
+}
+
+// === main ===
+// Usage: test_autotune [--retune]
+// The cache file defaults to ./branchless-autotune.txt and can be moved
+// with BRANCHLESS_TUNE_CACHE.
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    srand((unsigned)time(NULL));
+    int force = argc > 1 && strcmp(argv[1], "--retune") == 0;
+
+    long long start = nowNs();
+    int cached = autotuneInit(force);
+    long long end = nowNs();
+    printf("\n%s in %.2f ms\n", cached ? "Loaded tuning cache" : "Tuned all kernels", (end - start) / 1e6);
+
+    // Sanity: upper_auto must uppercase like the reference at every bucket.
+    for (int b = 0; b < AUTOTUNE_BUCKETS; ++b) {
+        size_t len = autotuneProbeLen(b) + (size_t)b;
+        char *s = malloc(len + 1), *r = malloc(len + 1);
+        if (!s || !r) return 1;
+        randStr(s, len);
+        memcpy(r, s, len + 1);
+        upper_auto(s, len);
+        branchlessUpperCase2N(r, len);
+        if (memcmp(s, r, len + 1) != 0) {
+            printf("MISMATCH: bucket %d (%s)\n", b, autotuneChoice(b)->name);
+            return 1;
+        }
+        free(s);
+        free(r);
+    }
+
+    print_table();
+    print_overhead();
+    return 0;
+}
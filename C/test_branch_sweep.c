@@ -0,0 +1,274 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "branchless.h"
+#include "pattern.h"
+#include "perfcount.h"
+#include "tsc.h"
+
+// Branch-predictability sweep. The Dart benchmarks compare ALL_BELOW,
+// ALL_INSIDE and ALL_ABOVE; here the inputs are generated so the kernels'
+// data-dependent branch is taken with an exact probability, in a random,
+// periodic or block pattern, and both C kernel families are timed across
+// that range. For the uppercase family "taken" means a lowercase letter
+// (the `if` in obviouseUpperCase), for the clamp family a value below min
+// (the first `if` in clampIf).
+
+const int STR_LEN = 4096;
+const int NUM_STRS = 16;        // 64 KB of text, resident in L2
+const int NUM_DOUBLES = 8192;   // 64 KB of doubles
+const int PASSES = 20;
+
+// === Utility structures ===
+typedef void (*upper_nul_t)(char *);
+typedef double (*clamp_t)(double, double, double);
+
+struct UpperCase {
+    const char *name;
+    upper_nul_t func;
+};
+
+struct ClampCase {
+    const char *name;
+    clamp_t func;
+};
+
+// One measured point: best of PASSES, with the counters of that pass.
+struct Point {
+    double nsPerElem;
+    double missPerElem;   // branch misses per byte / per double, -1 if unknown
+};
+
+static struct PerfCounters counters;
+
+// === Input generation ===
+// Taken bytes are random lowercase letters, the others random uppercase
+// letters; every string ends in NUL for the NUL-terminated kernels.
+void makeText(char *text, const unsigned char *mask) {
+    for (int s = 0; s < NUM_STRS; ++s) {
+        char *str = text + (size_t)s * (STR_LEN + 1);
+        const unsigned char *m = mask + (size_t)s * STR_LEN;
+        for (int i = 0; i < STR_LEN; ++i)
+            str[i] = m[i] ? (char)('a' + rand() % 26) : (char)('A' + rand() % 26);
+        str[STR_LEN] = '\0';
+    }
+}
+
+// Clamp range is [0, 1]: taken values are in [-2, -1), the others inside.
+void makeDoubles(double *data, const unsigned char *mask) {
+    for (int i = 0; i < NUM_DOUBLES; ++i) {
+        double r = (double)rand() / ((double)RAND_MAX + 1.0);
+        data[i] = mask[i] ? -2.0 + r : r;
+    }
+}
+
+// === Measurement ===
+struct Point measureUpper(upper_nul_t func, const char *master, char *work, size_t bytes) {
+    struct Point best = {-1.0, -1.0};
+    for (int p = 0; p < PASSES; ++p) {
+        uint64_t counts[PERF_COUNTERS];
+        memcpy(work, master, bytes);
+        perfStart(&counters);
+        long long start = nowNs();
+        for (int s = 0; s < NUM_STRS; ++s)
+            func(work + (size_t)s * (STR_LEN + 1));
+        long long end = nowNs();
+        perfStop(&counters, counts);
+
+        double ns = (double)(end - start) / ((double)NUM_STRS * STR_LEN);
+        if (best.nsPerElem < 0 || ns < best.nsPerElem) {
+            best.nsPerElem = ns;
+            best.missPerElem = counters.available
+                ? (double)counts[PERF_BRANCH_MISSES] / ((double)NUM_STRS * STR_LEN) : -1.0;
+        }
+    }
+    return best;
+}
+
+struct Point measureClamp(clamp_t func, const double *in, double *out) {
+    struct Point best = {-1.0, -1.0};
+    for (int p = 0; p < PASSES; ++p) {
+        uint64_t counts[PERF_COUNTERS];
+        perfStart(&counters);
+        long long start = nowNs();
+        for (int i = 0; i < NUM_DOUBLES; ++i)
+            out[i] = func(in[i], 0.0, 1.0);
+        long long end = nowNs();
+        perfStop(&counters, counts);
+
+        double ns = (double)(end - start) / NUM_DOUBLES;
+        if (best.nsPerElem < 0 || ns < best.nsPerElem) {
+            best.nsPerElem = ns;
+            best.missPerElem = counters.available
+                ? (double)counts[PERF_BRANCH_MISSES] / NUM_DOUBLES : -1.0;
+        }
+    }
+    return best;
+}
+
+// === Results printing ===
+void print_header(const char *family, const char *pattern, size_t period,
+                  const char *const *names, int num) {
+    printf("\n=== %s, %s", family, pattern);
+    if (period) printf(" (period %zu)", period);
+    printf(": ns/elem [misses/elem] ===\n");
+    printf("%-7s %-7s", "p", "model");
+    for (int k = 0; k < num; ++k) printf(" %-22s", names[k]);
+    printf("\n");
+}
+
+void print_row(double p, const struct Point *row, int num, double model) {
+    printf("%-7.3f %-7.3f", p, model);
+    for (int k = 0; k < num; ++k) {
+        char miss[16];
+        if (row[k].missPerElem >= 0) snprintf(miss, sizeof(miss), "%.3f", row[k].missPerElem);
+        else snprintf(miss, sizeof(miss), "n/a");
+        printf(" %-8.3f [%-6s]       ", row[k].nsPerElem, miss);
+    }
+    printf("\n");
+}
+
+// The taken probabilities where kernel 0 (the branchy one) beats every
+// other kernel in the family. Skipped rows (nsPerElem < 0) never count.
+void print_crossover(const char *name, const double *probs, int numProbs,
+                     struct Point (*rows)[8], int num) {
+    printf("%s wins at p =", name);
+    int any = 0;
+    for (int i = 0; i < numProbs; ++i) {
+        int wins = rows[i][0].nsPerElem >= 0;
+        for (int k = 1; k < num; ++k)
+            if (rows[i][k].nsPerElem <= rows[i][0].nsPerElem) wins = 0;
+        if (wins) {
+            printf(" %.3f", probs[i]);
+            any = 1;
+        }
+    }
+    printf("%s\n", any ? "" : " (never)");
+}
+
+// === main ===
+// Usage: test_branch_sweep [--period K] [--block B] [--csv FILE]
+// Sweeps p in 0..1 for a random pattern, a periodic one of period K
+// (default 32) and blocks of B outcomes (default 512). With --csv every
+// point is also written as
+//   family,kernel,pattern,period,p_taken,ns_per_elem,miss_per_elem,model_miss
+// for plotting ns/elem against the misprediction rate. miss_per_elem is
+// empty when hardware counters are unavailable; model_miss is what an
+// ideal predictor would achieve on the pattern.
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    size_t period = 32, block = 512;
+    const char *csvPath = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--period") == 0 && i + 1 < argc) period = (size_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--block") == 0 && i + 1 < argc) block = (size_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csvPath = argv[++i];
+    }
+    srand((unsigned)time(NULL));
+
+    static const double probs[] = {0.0, 0.01, 0.05, 0.1, 0.25, 0.5, 0.75, 0.9, 0.95, 0.99, 1.0};
+    const int numProbs = sizeof(probs) / sizeof(probs[0]);
+
+    struct UpperCase uppers[] = {
+        {"Obviouse", obviouseUpperCase},
+        {"Branchless 1", branchlessUpperCase1},
+        {"Branchless 2", branchlessUpperCase2}
+    };
+    struct ClampCase clamps[] = {
+        {"If", clampIf},
+        {"Ternary", clampTernary},
+        {"Switch", clampSwitch},
+        {"Branchless", clampBranchless},
+        {"Standard", clampStandard}
+    };
+    const int numUppers = sizeof(uppers) / sizeof(uppers[0]);
+    const int numClamps = sizeof(clamps) / sizeof(clamps[0]);
+    const char *upperNames[8], *clampNames[8];
+    for (int k = 0; k < numUppers; ++k) upperNames[k] = uppers[k].name;
+    for (int k = 0; k < numClamps; ++k) clampNames[k] = clamps[k].name;
+
+    size_t textBytes = (size_t)NUM_STRS * (STR_LEN + 1);
+    size_t maskLen = (size_t)NUM_STRS * STR_LEN;
+    unsigned char *mask = malloc(maskLen);
+    char *master = malloc(textBytes), *work = malloc(textBytes);
+    double *in = malloc(NUM_DOUBLES * sizeof(double)), *out = malloc(NUM_DOUBLES * sizeof(double));
+    if (!mask || !master || !work || !in || !out) return 1;
+
+    FILE *csv = NULL;
+    if (csvPath) {
+        csv = fopen(csvPath, "w");
+        if (!csv) {
+            printf("cannot write %s\n", csvPath);
+            return 1;
+        }
+        fprintf(csv, "family,kernel,pattern,period,p_taken,ns_per_elem,miss_per_elem,model_miss\n");
+    }
+
+    if (perfOpen(&counters))
+        printf("\nMisses from hardware counters (branch-misses, user space).\n");
+    else
+        printf("\nHardware counters unavailable: use the model column (ideal predictor's\n"
+               "misses per element on the branchy kernel) as the x axis.\n");
+
+    const int kinds[] = {PATTERN_RANDOM, PATTERN_PERIODIC, PATTERN_BLOCKS};
+    for (int f = 0; f < 2; ++f) {
+        int upper = f == 0;
+        int num = upper ? numUppers : numClamps;
+        for (int pk = 0; pk < 3; ++pk) {
+            int kind = kinds[pk];
+            size_t per = kind == PATTERN_PERIODIC ? period : kind == PATTERN_BLOCKS ? block : 0;
+            struct Point rows[16][8];
+
+            print_header(upper ? "UPPERCASE" : "CLAMP", patternName(kind), per,
+                         upper ? upperNames : clampNames, num);
+            for (int i = 0; i < numProbs; ++i) {
+                double model = patternModelMissRate(probs[i], kind, per);
+                if (makePattern(mask, upper ? maskLen : NUM_DOUBLES, probs[i], kind, per) != 0) {
+                    printf("%-7.3f (out of memory building the pattern, skipped)\n", probs[i]);
+                    for (int k = 0; k < num; ++k) rows[i][k].nsPerElem = rows[i][k].missPerElem = -1.0;
+                    continue;
+                }
+                if (upper) {
+                    makeText(master, mask);
+                    for (int k = 0; k < num; ++k)
+                        rows[i][k] = measureUpper(uppers[k].func, master, work, textBytes);
+                } else {
+                    makeDoubles(in, mask);
+                    for (int k = 0; k < num; ++k)
+                        rows[i][k] = measureClamp(clamps[k].func, in, out);
+                }
+                print_row(probs[i], rows[i], num, model);
+
+                for (int k = 0; csv && k < num; ++k) {
+                    fprintf(csv, "%s,%s,%s,%zu,%.4f,%.4f,", upper ? "upper" : "clamp",
+                            upper ? upperNames[k] : clampNames[k], patternName(kind), per,
+                            probs[i], rows[i][k].nsPerElem);
+                    if (rows[i][k].missPerElem >= 0) fprintf(csv, "%.5f", rows[i][k].missPerElem);
+                    fprintf(csv, ",%.5f\n", model);
+                }
+            }
+            print_crossover(upper ? "Obviouse" : "If", probs, numProbs, rows, num);
+        }
+    }
+
+    perfClose(&counters);
+    if (csv) {
+        fclose(csv);
+        printf("\nWrote %s\n", csvPath);
+    }
+    free(mask);
+    free(master);
+    free(work);
+    free(in);
+    free(out);
+    printf("\n");
+    return 0;
+}
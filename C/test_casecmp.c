@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define strcasecmp _stricmp
+#else
+#include <strings.h>
+#endif
+
+#include "branchless.h"
+#include "tsc.h"
+
+const int STR_LEN = 2048;
+
+// === Random string generation ===
+void randStr(char* s) {
+    for (int i = 0; i < STR_LEN; i++) {
+        s[i] = (rand() % 2 == 0)
+            ? ('A' + rand() % 26)
+            : ('a' + rand() % 26);
+    }
+    s[STR_LEN] = '\0';
+}
+
+// Same letters as src with the case of every letter flipped at random,
+// so the pair is equal case-insensitively and every kernel reads it whole.
+void randCaseFlip(char *dst, const char *src) {
+    for (int i = 0; i <= STR_LEN; i++)
+        dst[i] = (rand() % 2 == 0 && src[i] != '\0') ? (src[i] ^ 0x20) : src[i];
+}
+
+// === Benchmark adapters ===
+// Every comparison strategy behind one signature. Return value is only
+// used for its sign (or truth) and is accumulated to keep it live.
+typedef int (*test_cmp_t)(const char *, const char *, size_t);
+
+static char *scratchA;
+static char *scratchB;
+
+int cmpStrcasecmp(const char *a, const char *b, size_t n) {
+    (void)n;
+    return strcasecmp(a, b);
+}
+
+int cmpUpperThenMemcmp(const char *a, const char *b, size_t n) {
+    memcpy(scratchA, a, n + 1);
+    memcpy(scratchB, b, n + 1);
+    branchlessUpperCase2(scratchA);
+    branchlessUpperCase2(scratchB);
+    return memcmp(scratchA, scratchB, n);
+}
+
+int cmpScalar(const char *a, const char *b, size_t n) { return ascii_casecmp_scalar(a, n, b, n); }
+int cmpSwar(const char *a, const char *b, size_t n) { return ascii_casecmp_swar(a, n, b, n); }
+int cmpDispatch(const char *a, const char *b, size_t n) { return ascii_casecmp(a, n, b, n); }
+int eqSwar(const char *a, const char *b, size_t n) { return !ascii_caseeq_swar(a, b, n); }
+int eqDispatch(const char *a, const char *b, size_t n) { return !ascii_caseeq(a, b, n); }
+
+typedef uint64_t (*test_hash_t)(const char *, size_t);
+
+uint64_t hashUpperThenHash(const char *s, size_t n) {
+    memcpy(scratchA, s, n + 1);
+    branchlessUpperCase2(scratchA);
+    return ascii_hash(scratchA, n, 0);
+}
+
+uint64_t hashFused(const char *s, size_t n) {
+    return ascii_casehash(s, n, 0);
+}
+
+// === Utility structures ===
+struct TestCase {
+    const char *name;
+    test_cmp_t func;
+    long long cycles;
+};
+
+struct HashCase {
+    const char *name;
+    test_hash_t func;
+    long long cycles;
+};
+
+// === Helper functions ===
+char **makeList(int count) {
+    char **list = malloc(count * sizeof(char *));
+    if (!list) return NULL;
+
+    for (int i = 0; i < count; ++i) {
+        list[i] = malloc(STR_LEN + 1);
+        if (!list[i]) {
+            for (int j = 0; j < i; ++j) free(list[j]);
+            free(list);
+            return NULL;
+        }
+        randStr(list[i]);
+    }
+    return list;
+}
+
+// Case-flipped twin of every string in list.
+char **makeTwinList(char **list, int count) {
+    char **twins = malloc(count * sizeof(char *));
+    if (!twins) return NULL;
+
+    for (int i = 0; i < count; ++i) {
+        twins[i] = malloc(STR_LEN + 1);
+        if (!twins[i]) {
+            for (int j = 0; j < i; ++j) free(twins[j]);
+            free(twins);
+            return NULL;
+        }
+        randCaseFlip(twins[i], list[i]);
+    }
+    return twins;
+}
+
+void freeList(char **list, int count) {
+    for (int i = 0; i < count; ++i)
+        free(list[i]);
+    free(list);
+}
+
+// Cross-checks every strategy against uppercase-then-memcmp on equal,
+// case-flipped and single-byte-mismatch pairs before anything is timed.
+int verify(struct TestCase *tests, int num, struct HashCase *hashes, int numHashes) {
+    char *a = malloc(STR_LEN + 1);
+    char *b = malloc(STR_LEN + 1);
+    char *ua = malloc(STR_LEN + 1);
+    char *ub = malloc(STR_LEN + 1);
+    int ok = a && b && ua && ub;
+
+    for (int round = 0; ok && round < 200; ++round) {
+        size_t n = (size_t)(rand() % (STR_LEN + 1));
+        randStr(a);
+        randCaseFlip(b, a);
+        if (round % 2) {
+            // Anything from the whole byte range, including >= 0x80.
+            size_t k = (size_t)rand() % (n ? n : 1);
+            b[k] = (char)(1 + rand() % 255);
+        }
+        a[n] = b[n] = '\0';
+        memcpy(ua, a, n + 1);
+        memcpy(ub, b, n + 1);
+        branchlessUpperCase2(ua);
+        branchlessUpperCase2(ub);
+        int ref = memcmp(ua, ub, n);
+        int refSign = (ref > 0) - (ref < 0);
+
+        for (int i = 0; i < num; ++i) {
+            if (tests[i].func == cmpStrcasecmp) continue;
+            int r = tests[i].func(a, b, n);
+            int sign = (r > 0) - (r < 0);
+            int expect = (tests[i].func == eqSwar || tests[i].func == eqDispatch) ? (ref != 0) : refSign;
+            if (sign != expect) {
+                printf("MISMATCH: %s (len %zu)\n", tests[i].name, n);
+                ok = 0;
+            }
+        }
+        for (int i = 0; i < numHashes; ++i) {
+            if (hashes[i].func(a, n) != ascii_hash(ua, n, 0)) {
+                printf("MISMATCH: %s (len %zu)\n", hashes[i].name, n);
+                ok = 0;
+            }
+        }
+    }
+    free(a); free(b); free(ua); free(ub);
+    return ok;
+}
+
+// === Single function measurement ===
+static volatile uint64_t sink;
+
+void test_function(struct TestCase *test, char **listA, char **listB, int iterations) {
+    test_cmp_t func = test->func;
+    long long acc = 0;
+
+    long long start = nowNs();
+    for (int i = 0; i < iterations; ++i)
+        acc += func(listA[i], listB[i], STR_LEN) != 0;
+    long long end = nowNs();
+
+    test->cycles = end - start; // in nanoseconds
+    sink = (uint64_t)acc;
+}
+
+void test_hash(struct HashCase *test, char **list, int iterations) {
+    test_hash_t func = test->func;
+    uint64_t acc = 0;
+
+    long long start = nowNs();
+    for (int i = 0; i < iterations; ++i)
+        acc ^= func(list[i], STR_LEN);
+    long long end = nowNs();
+
+    test->cycles = end - start;
+    sink = acc;
+}
+
+// === Results printing ===
+void print_results(const char **names, const long long *cycles, int num, int iterations) {
+    printf("%-24s %-15s %-15s\n", "Function", "Time (nanosec)", "Time/call");
+    printf("-------------------------------------------------------\n");
+
+    long long min = cycles[0];
+    for (int i = 1; i < num; ++i)
+        if (cycles[i] < min)
+            min = cycles[i];
+
+    for (int i = 0; i < num; ++i) {
+        double per_call = (double)cycles[i] / iterations;
+        double rel = (double)cycles[i] / (min ? min : 1);
+        printf("%-24s %-15lld %-10.2f (x%.3f)\n", names[i], cycles[i], per_call, rel);
+    }
+    printf("\n");
+}
+
+// === main ===
+int main(void) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    srand((unsigned)time(NULL));
+
+    const int ITERATIONS = 1000;
+
+    struct TestCase tests[] = {
+        {"strcasecmp",          cmpStrcasecmp,      0},
+        {"upper + memcmp",      cmpUpperThenMemcmp, 0},
+        {"casecmp scalar",      cmpScalar,          0},
+        {"casecmp SWAR",        cmpSwar,            0},
+        {"casecmp dispatch",    cmpDispatch,        0},
+        {"caseeq SWAR",         eqSwar,             0},
+        {"caseeq dispatch",     eqDispatch,         0}
+    };
+    struct HashCase hashes[] = {
+        {"upper + hash",        hashUpperThenHash,  0},
+        {"casehash fused",      hashFused,          0}
+    };
+    int num_tests = sizeof(tests) / sizeof(tests[0]);
+    int num_hashes = sizeof(hashes) / sizeof(hashes[0]);
+
+    scratchA = malloc(STR_LEN + 1);
+    scratchB = malloc(STR_LEN + 1);
+    if (!scratchA || !scratchB) return 1;
+
+    printf("\nVerifying kernels...\n");
+    if (!verify(tests, num_tests, hashes, num_hashes)) return 1;
+
+    char **listA = makeList(ITERATIONS);
+    char **listB = listA ? makeTwinList(listA, ITERATIONS) : NULL;
+    if (!listB) return 1;
+
+    printf("Running tests (%d iterations)...\n", ITERATIONS);
+    for (int i = 0; i < num_tests; ++i)
+        test_function(&tests[i], listA, listB, ITERATIONS);
+    for (int i = 0; i < num_hashes; ++i)
+        test_hash(&hashes[i], listA, ITERATIONS);
+
+    const char *names[16];
+    long long cycles[16];
+
+    printf("\n=== COMPARISON (equal pairs, %d bytes) ===\n", STR_LEN);
+    for (int i = 0; i < num_tests; ++i) {
+        names[i] = tests[i].name;
+        cycles[i] = tests[i].cycles;
+    }
+    print_results(names, cycles, num_tests, ITERATIONS);
+
+    printf("=== HASHING (%d bytes) ===\n", STR_LEN);
+    for (int i = 0; i < num_hashes; ++i) {
+        names[i] = hashes[i].name;
+        cycles[i] = hashes[i].cycles;
+    }
+    print_results(names, cycles, num_hashes, ITERATIONS);
+
+    freeList(listB, ITERATIONS);
+    freeList(listA, ITERATIONS);
+    free(scratchA);
+    free(scratchB);
+    return 0;
+}
@@ -0,0 +1,290 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "branchless.h"
+#include "tsc.h"
+
+// Fused clamp + sum. The Dart benchmarks add up clamp(v, min, max) over
+// the data to check that the implementations agree ("Sums are equal");
+// here the same sum is computed by separate passes (clampArray, then a
+// sum loop) and by the fused clampSum kernels, which never write the
+// clamped values back. The fused sum is bit-identical across kernels and
+// thread counts; a naive threaded sum (each thread sums its chunk, the
+// chunk sums are added) is shown next to it for contrast.
+
+const int TRIALS = 5;
+const double MIN = -1.0, MAX = 1.0;
+
+// === Random generation ===
+// Same range as the Dart data: uniform in [-2, 2), half of it clamped.
+double randDouble(void) {
+    return (double)rand() / RAND_MAX * 4.0 - 2.0;
+}
+
+// === Sum variants ===
+// Every variant gets the pristine data and a scratch buffer of the same
+// size; the separate-pass variants clamp into the scratch copy.
+static const double *gData;
+static double *gWork;
+static float *gDataF;
+static size_t gN;
+
+static double sumSequential(const double *p, size_t n) {
+    double s = 0.0;
+    for (size_t i = 0; i < n; ++i) s += p[i];
+    return s;
+}
+
+double separateScalar(void) {
+    memcpy(gWork, gData, gN * sizeof(double));
+    clampArray(gWork, gN, MIN, MAX);
+    return sumSequential(gWork, gN);
+}
+
+// clampSum with infinite bounds is a plain vector sum.
+double separateVector(void) {
+    memcpy(gWork, gData, gN * sizeof(double));
+    clampArray(gWork, gN, MIN, MAX);
+    return clampSum(gWork, gN, -INFINITY, INFINITY, CLAMPSUM_PLAIN);
+}
+
+double dartLoop(void) {
+    double s = 0.0;
+    for (size_t i = 0; i < gN; ++i) s += clampTernary(gData[i], MIN, MAX);
+    return s;
+}
+
+double fusedScalar(void)    { return clampSumScalar(gData, gN, MIN, MAX, CLAMPSUM_PLAIN); }
+double fusedAvx2(void)      { return clampSumAvx2(gData, gN, MIN, MAX, CLAMPSUM_PLAIN); }
+double fusedAvx512(void)    { return clampSumAvx512(gData, gN, MIN, MAX, CLAMPSUM_PLAIN); }
+double fused(void)          { return clampSum(gData, gN, MIN, MAX, CLAMPSUM_PLAIN); }
+double fusedNeumaier(void)  { return clampSum(gData, gN, MIN, MAX, CLAMPSUM_NEUMAIER); }
+double fusedFloat(void)     { return clampSumF(gDataF, gN, (float)MIN, (float)MAX, CLAMPSUM_PLAIN); }
+double fusedFloatNeum(void) { return clampSumF(gDataF, gN, (float)MIN, (float)MAX, CLAMPSUM_NEUMAIER); }
+
+// === Utility structures ===
+typedef double (*sum_func_t)(void);
+struct TestCase {
+    const char *name;
+    sum_func_t func;
+    int cpu;
+    long long cycles;
+    double sum;
+};
+
+// The separate passes stream the data twice (plus the restoring copy,
+// which is timed too: it is what keeps the input intact, as the fused
+// kernels do for free).
+void test_function(struct TestCase *test) {
+    long long best = -1;
+    for (int t = 0; t < TRIALS; ++t) {
+        long long start = nowNs();
+        test->sum = test->func();
+        long long end = nowNs();
+        if (best < 0 || end - start < best) best = end - start;
+    }
+    test->cycles = best;
+}
+
+// === Results printing ===
+// `error` is against a long double sequential sum of the clamped values.
+void print_results(struct TestCase *tests, int num, long double exact) {
+    printf("%-28s %-15s %-11s %-24s %s\n", "Function", "Time (nanosec)", "ns/elem", "Sum", "Error");
+    printf("--------------------------------------------------------------------------------------------\n");
+
+    long long min = -1;
+    for (int i = 0; i < num; ++i)
+        if (cpuSupports(tests[i].cpu) && (min < 0 || tests[i].cycles < min))
+            min = tests[i].cycles;
+
+    for (int i = 0; i < num; ++i) {
+        if (!cpuSupports(tests[i].cpu)) {
+            printf("%-28s (skipped: no %s)\n", tests[i].name, cpuName(tests[i].cpu));
+            continue;
+        }
+        printf("%-28s %-15lld %-11.3f %-24.17g %-10.3Lg (x%.3f)\n",
+               tests[i].name,
+               tests[i].cycles,
+               (double)tests[i].cycles / gN,
+               tests[i].sum,
+               fabsl((long double)tests[i].sum - exact),
+               (double)tests[i].cycles / (min > 0 ? min : 1));
+    }
+}
+
+// === Threads ===
+// Each thread takes a contiguous run of blocks. The deterministic path
+// writes per-block partials and combines them in block order; the naive
+// path just returns one clampSum per thread chunk.
+struct Worker {
+    pthread_t tid;
+    size_t firstBlock, lastBlock;
+    int mode;
+    struct ClampSumPartial *parts;
+    double naive;
+};
+
+static void *workerMain(void *arg) {
+    struct Worker *w = arg;
+    size_t start = w->firstBlock * CLAMPSUM_BLOCK;
+    size_t end = w->lastBlock * CLAMPSUM_BLOCK < gN ? w->lastBlock * CLAMPSUM_BLOCK : gN;
+    if (w->parts)
+        clampSumBlocks(gData, gN, MIN, MAX, w->mode, w->firstBlock, w->lastBlock,
+                       w->parts + w->firstBlock);
+    else
+        w->naive = clampSum(gData + start, end - start, MIN, MAX, w->mode);
+    return NULL;
+}
+
+// Returns the sum over `threads` workers; `deterministic` picks the path.
+double threadedSum(int threads, int mode, int deterministic, struct ClampSumPartial *parts) {
+    size_t blocks = (gN + CLAMPSUM_BLOCK - 1) / CLAMPSUM_BLOCK;
+    struct Worker workers[64];
+    for (int t = 0; t < threads; ++t) {
+        workers[t].firstBlock = blocks * t / threads;
+        workers[t].lastBlock = blocks * (t + 1) / threads;
+        workers[t].mode = mode;
+        workers[t].parts = deterministic ? parts : NULL;
+        pthread_create(&workers[t].tid, NULL, workerMain, &workers[t]);
+    }
+    double naive = 0.0;
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(workers[t].tid, NULL);
+        naive += workers[t].naive;
+    }
+    return deterministic ? clampSumCombine(parts, blocks, mode) : naive;
+}
+
+int print_threads(int maxThreads, int mode, double reference) {
+    size_t blocks = (gN + CLAMPSUM_BLOCK - 1) / CLAMPSUM_BLOCK;
+    struct ClampSumPartial *parts = malloc(blocks * sizeof(*parts));
+    if (!parts) return 0;
+
+    printf("\n%-8s %-15s %-24s %-15s %-24s\n", "Threads", "Blocks (ns)", "Block-order sum", "Naive (ns)", "Naive sum");
+    printf("------------------------------------------------------------------------------------------\n");
+    int equal = 1;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        double det = 0.0, naive = 0.0;
+        long long bestDet = -1, bestNaive = -1;
+        for (int t = 0; t < TRIALS; ++t) {
+            long long start = nowNs();
+            det = threadedSum(threads, mode, 1, parts);
+            long long mid = nowNs();
+            naive = threadedSum(threads, mode, 0, parts);
+            long long end = nowNs();
+            if (bestDet < 0 || mid - start < bestDet) bestDet = mid - start;
+            if (bestNaive < 0 || end - mid < bestNaive) bestNaive = end - mid;
+        }
+        equal &= det == reference;
+        printf("%-8d %-15lld %-24.17g %-15lld %-24.17g%s\n",
+               threads, bestDet, det, bestNaive, naive, naive == reference ? "" : "  (differs)");
+    }
+    printf("Block-order sums equal clampSum at every thread count: %s\n", equal ? "YES" : "NO");
+    free(parts);
+    return equal;
+}
+
+// === main ===
+// Usage: test_clamp_sum [--threads N] [elements...]
+//   --threads N   largest thread count of the scaling table (powers of
+//                 two up to N, default 8)
+//   elements      array sizes to run, default 32768 (256 KB, L2) and
+//                 4194304 (32 MB, DRAM)
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    srand((unsigned)time(NULL));
+
+    int maxThreads = 8;
+    size_t sizes[16];
+    int numSizes = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            maxThreads = atoi(argv[++i]);
+            if (maxThreads < 1) maxThreads = 1;
+            if (maxThreads > 64) maxThreads = 64;
+        } else if (numSizes < 16) {
+            sizes[numSizes++] = (size_t)strtoull(argv[i], NULL, 10);
+        }
+    }
+    if (numSizes == 0) {
+        sizes[numSizes++] = 32768;
+        sizes[numSizes++] = 4194304;
+    }
+
+    struct TestCase tests[] = {
+        {"Dart loop (clampTernary)",  dartLoop,       CPU_ANY,      0, 0},
+        {"clampArray + scalar sum",   separateScalar, CPU_ANY,      0, 0},
+        {"clampArray + vector sum",   separateVector, CPU_ANY,      0, 0},
+        {"clampSumScalar",            fusedScalar,    CPU_ANY,      0, 0},
+        {"clampSumAvx2",              fusedAvx2,      CPU_AVX2,     0, 0},
+        {"clampSumAvx512",            fusedAvx512,    CPU_AVX512BW, 0, 0},
+        {"clampSum (dispatched)",     fused,          CPU_ANY,      0, 0},
+        {"clampSum Neumaier",         fusedNeumaier,  CPU_ANY,      0, 0},
+        {"clampSumF",                 fusedFloat,     CPU_ANY,      0, 0},
+        {"clampSumF Neumaier",        fusedFloatNeum, CPU_ANY,      0, 0}
+    };
+    int num_tests = sizeof(tests) / sizeof(tests[0]);
+
+    printf("\nlibbranchless %d, fused clamp + sum, clamp to [%g, %g]\n", branchlessVersion(), MIN, MAX);
+    int ok = 1;
+    for (int s = 0; s < numSizes; ++s) {
+        gN = sizes[s];
+        double *data = malloc(gN * sizeof(double));
+        gWork = malloc(gN * sizeof(double));
+        gDataF = malloc(gN * sizeof(float));
+        if (!data || !gWork || !gDataF) return 1;
+        long double exact = 0.0L;
+        for (size_t i = 0; i < gN; ++i) {
+            data[i] = randDouble();
+            gDataF[i] = (float)data[i];
+            exact += clampTernary(data[i], MIN, MAX);
+        }
+        gData = data;
+
+        printf("\n=== %zu elements (%zu KB) ===\n", gN, gN * sizeof(double) / 1024);
+        for (int i = 0; i < num_tests; ++i)
+            if (cpuSupports(tests[i].cpu))
+                test_function(&tests[i]);
+        print_results(tests, num_tests, exact);
+
+        // The fused double kernels must agree to the bit, as must the
+        // float kernels among themselves.
+        double ref = clampSumScalar(gData, gN, MIN, MAX, CLAMPSUM_PLAIN);
+        double refNeum = clampSumScalar(gData, gN, MIN, MAX, CLAMPSUM_NEUMAIER);
+        float refF = clampSumFScalar(gDataF, gN, (float)MIN, (float)MAX, CLAMPSUM_PLAIN);
+        float refFNeum = clampSumFScalar(gDataF, gN, (float)MIN, (float)MAX, CLAMPSUM_NEUMAIER);
+        int equal = 1;
+        for (int i = 3; i < 7; ++i)
+            if (cpuSupports(tests[i].cpu)) equal &= tests[i].sum == ref;
+        equal &= tests[7].sum == refNeum;
+        equal &= (float)tests[8].sum == refF && (float)tests[9].sum == refFNeum;
+        if (cpuSupports(CPU_AVX2))
+            equal &= clampSumAvx2(gData, gN, MIN, MAX, CLAMPSUM_NEUMAIER) == refNeum &&
+                     clampSumFAvx2(gDataF, gN, (float)MIN, (float)MAX, CLAMPSUM_NEUMAIER) == refFNeum &&
+                     clampSumFAvx2(gDataF, gN, (float)MIN, (float)MAX, CLAMPSUM_PLAIN) == refF;
+        if (cpuSupports(CPU_AVX512BW))
+            equal &= clampSumAvx512(gData, gN, MIN, MAX, CLAMPSUM_NEUMAIER) == refNeum &&
+                     clampSumFAvx512(gDataF, gN, (float)MIN, (float)MAX, CLAMPSUM_NEUMAIER) == refFNeum &&
+                     clampSumFAvx512(gDataF, gN, (float)MIN, (float)MAX, CLAMPSUM_PLAIN) == refF;
+        printf("Sums are equal: %s\n", equal ? "YES" : "NO");
+        ok &= equal;
+
+        ok &= print_threads(maxThreads, CLAMPSUM_PLAIN, ref);
+
+        free(data);
+        free(gWork);
+        free(gDataF);
+    }
+    printf("\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "branchless.h"
+#include "pagealloc.h"
+#include "perfcount.h"
+#include "tsc.h"
+
+// Page size and alignment of the corpus. The strings live in one buffer
+// from pageAlloc, STR_LEN letters each in a slot of `stride` bytes, and
+// are visited in a shuffled order like makeList's scattered heap, so
+// nearly every string starts on a page the previous one did not touch.
+// With 4 KB pages that is a dTLB miss (and often an STLB miss) per
+// string; with 2 MB or 1 GB pages the whole corpus fits the TLB reach.
+//
+// Part 1 runs every kernel in each page mode. Part 2 keeps 4 KB pages
+// and moves every string `offset` bytes (0..63) past a cache-line
+// boundary, which splits the vector kernels' loads and stores across
+// lines.
+
+const int TRIALS = 3;
+
+// === Random string generation ===
+void randStr(char *s, int len) {
+    for (int i = 0; i < len; i++) {
+        s[i] = (rand() % 2 == 0)
+            ? ('A' + rand() % 26)
+            : ('a' + rand() % 26);
+    }
+}
+
+// === Corpus ===
+// `master` holds the generated text once, compactly; before every pass
+// each slot is restored from it, so the branchy kernels see lowercase
+// letters every time.
+struct Corpus {
+    struct PageBuffer buf;
+    char **list;             // visiting order
+    const char *master;
+    int count, len;
+    size_t stride;
+    int offset;
+};
+
+static size_t slotStride(int len) {
+    return ((size_t)len + 1 + 63) / 64 * 64 + 64;   // room for offsets up to 63
+}
+
+int buildCorpus(struct Corpus *c, const char *master, const int *order, int count, int len,
+                int mode, int offset) {
+    c->master = master;
+    c->count = count;
+    c->len = len;
+    c->offset = offset;
+    c->stride = slotStride(len);
+    c->list = malloc(count * sizeof(char *));
+    if (!c->list) return 0;
+    if (pageAlloc(&c->buf, c->stride * count, mode) != 0) {
+        free(c->list);
+        c->list = NULL;
+        return 0;
+    }
+    char *base = c->buf.base;
+    for (int i = 0; i < count; ++i)
+        c->list[i] = base + (size_t)order[i] * c->stride + offset;
+    return 1;
+}
+
+void restoreCorpus(struct Corpus *c) {
+    for (int i = 0; i < c->count; ++i) {
+        char *slot = (char *)c->buf.base + (size_t)i * c->stride + c->offset;
+        memcpy(slot, c->master + (size_t)i * c->len, c->len);
+        slot[c->len] = '\0';
+    }
+}
+
+void freeCorpus(struct Corpus *c) {
+    pageFree(&c->buf);
+    free(c->list);
+    c->list = NULL;
+}
+
+// === Utility structures ===
+struct TestCase {
+    const struct UpperKernel *kernel;
+    long long cycles;
+    uint64_t loadMisses, storeMisses;
+};
+
+// === Single kernel measurement ===
+void test_function(struct TestCase *test, struct Corpus *c, struct PerfCounters *pc) {
+    upper_func_t func = test->kernel->func;
+    uint64_t counts[PERF_COUNTERS] = {0};
+    test->cycles = -1;
+    for (int t = 0; t < TRIALS; ++t) {
+        restoreCorpus(c);
+        perfStart(pc);
+        long long start = nowNs();
+        for (int i = 0; i < c->count; ++i)
+            func(c->list[i], (size_t)c->len);
+        long long end = nowNs();
+        perfStop(pc, counts);
+        if (test->cycles < 0 || end - start < test->cycles) {
+            test->cycles = end - start;
+            test->loadMisses = counts[PERF_DTLB_LOAD_MISSES];
+            test->storeMisses = counts[PERF_DTLB_STORE_MISSES];
+        }
+    }
+}
+
+// 0, step, 2 * step, ..., then 63 (the worst split) last.
+static int nextOffset(int offset, int step) {
+    if (offset == 63) return 64;
+    return offset + step < 63 ? offset + step : 63;
+}
+
+// === Results printing ===
+// base[i] is 0 when the 4K mode could not run; "vs 4K" is n/a then.
+void print_mode(int mode, struct TestCase *tests, const long long *base, int num,
+                const struct Corpus *c, int counters) {
+    long long thp = pageThpBytes(&c->buf);
+    printf("\n=== %s", pageModeName(mode));
+    if (mode == PAGES_THP && thp >= 0)
+        printf(", %.0f%% of the corpus on huge pages", 100.0 * (double)thp / (double)c->buf.size);
+    printf(" ===\n");
+    printf("%-14s %-15s %-12s %-10s %-14s %-14s\n",
+           "Kernel", "Time (nanosec)", "ns/string", "vs 4K", "dTLB ld/str", "dTLB st/str");
+    printf("------------------------------------------------------------------------------\n");
+    for (int i = 0; i < num; ++i) {
+        char ld[16] = "n/a", st[16] = "n/a", vs[16] = "n/a";
+        if (base[i] > 0)
+            snprintf(vs, sizeof(vs), "x%.3f", (double)base[i] / (tests[i].cycles > 0 ? tests[i].cycles : 1));
+        if (counters) {
+            snprintf(ld, sizeof(ld), "%.3f", (double)tests[i].loadMisses / c->count);
+            snprintf(st, sizeof(st), "%.3f", (double)tests[i].storeMisses / c->count);
+        }
+        printf("%-14s %-15lld %-12.2f %-10s %-14s %-14s\n",
+               tests[i].kernel->name,
+               tests[i].cycles,
+               (double)tests[i].cycles / c->count,
+               vs, ld, st);
+    }
+}
+
+// === main ===
+// Usage: test_hugepages [--len L] [--align-step S] [count]
+//   count           strings in the corpus (default 100000, 200+ MB)
+//   --len L         letters per string (default 2048, as STR_LEN)
+//   --align-step S  offsets 0, S, 2S, ... and 63 in part 2 (default 4;
+//                   1 runs all 64)
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    srand((unsigned)time(NULL));
+
+    int count = 100000, len = 2048, alignStep = 4;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--len") == 0 && i + 1 < argc) len = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--align-step") == 0 && i + 1 < argc) alignStep = atoi(argv[++i]);
+        else if (atoi(argv[i]) > 0) count = atoi(argv[i]);
+    }
+    if (len < 1) len = 1;
+    if (alignStep < 1) alignStep = 1;
+
+    int numKernels;
+    const struct UpperKernel *registry = upperKernels(&numKernels);
+    struct TestCase tests[32];
+    int num = 0;
+    for (int k = 0; k < numKernels && num < 32; ++k)
+        if (cpuSupports(registry[k].cpu))
+            tests[num++].kernel = &registry[k];
+
+    char *master = malloc((size_t)count * len);
+    int *order = malloc(count * sizeof(int));
+    if (!master || !order) return 1;
+    for (int i = 0; i < count; ++i) {
+        randStr(master + (size_t)i * len, len);
+        order[i] = i;
+    }
+    for (int i = count - 1; i > 0; --i) {
+        int j = (int)(((unsigned long long)rand() * RAND_MAX + rand()) % (unsigned)(i + 1));
+        int tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    struct PerfCounters pc;
+    int counters = perfOpenTlb(&pc);
+    printf("\nlibbranchless %d, corpus of %d strings x %d letters (%.0f MB), shuffled order\n",
+           branchlessVersion(), count, len, (double)slotStride(len) * count / 1048576.0);
+    if (!counters)
+        printf("dTLB counters unavailable (no PMU access); timing only\n");
+
+    // === Part 1: page modes ===
+    long long base[32] = {0};
+    for (int mode = 0; mode < PAGE_MODES; ++mode) {
+        struct Corpus c;
+        memset(&c, 0, sizeof(c));
+        if (!buildCorpus(&c, master, order, count, len, mode, 0)) {
+            printf("\n=== %s: not available here ===\n", pageModeName(mode));
+            continue;
+        }
+        for (int i = 0; i < num; ++i) {
+            test_function(&tests[i], &c, &pc);
+            if (mode == PAGES_4K) base[i] = tests[i].cycles;
+        }
+        print_mode(mode, tests, base, num, &c, counters);
+        freeCorpus(&c);
+    }
+
+    // === Part 2: alignment offsets, 4K pages ===
+    printf("\n=== Alignment offset, 4K pages (ns/string) ===\n%-8s", "Offset");
+    for (int i = 0; i < num; ++i) printf(" %-12s", tests[i].kernel->name);
+    printf("\n");
+    for (int offset = 0; offset < 64; offset = nextOffset(offset, alignStep)) {
+        struct Corpus c;
+        memset(&c, 0, sizeof(c));
+        if (!buildCorpus(&c, master, order, count, len, PAGES_4K, offset)) break;
+        printf("%-8d", offset);
+        for (int i = 0; i < num; ++i) {
+            test_function(&tests[i], &c, &pc);
+            printf(" %-12.2f", (double)tests[i].cycles / count);
+        }
+        printf("\n");
+        freeCorpus(&c);
+    }
+
+    perfClose(&pc);
+    free(master);
+    free(order);
+    printf("\n");
+    return 0;
+}
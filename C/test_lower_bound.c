@@ -0,0 +1,276 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "branchless.h"
+#include "tsc.h"
+
+// Sorted-array lookup, std::lower_bound on uint32_t keys, from 1K to 1G
+// elements:
+//   branchy      the textbook loop, one branch per level that a random
+//                query mispredicts half the time;
+//   branchless   the same halving with a cmov, a fixed log2(n) steps;
+//   Eytzinger    BFS layout, a cmov-free index update and a prefetch four
+//                levels ahead;
+//   k-ary        17-ary tree of cache-line nodes, two AVX2 compares and
+//                one line per level.
+//
+// The keys are 1, 3, 5, ..., 2n - 1, so a query is a hit when it is odd
+// and a miss (between two keys, or past the last one) when it is even.
+// Queries are uniform over the array and independent of each other: this
+// is throughput, with as many lookups in flight as the core can overlap,
+// not the latency of one.
+
+const int TRIALS = 3;
+static const int hitPercents[] = {100, 50, 0};
+#define NUM_MIXES ((int)(sizeof(hitPercents) / sizeof(hitPercents[0])))
+
+// The answer when every key is smaller, for the checksums.
+#define PAST_END ((uint64_t)1 << 32)
+
+// === Memory ===
+// Physical memory in bytes, 0 when unknown.
+static size_t physBytes(void) {
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+    long pages = sysconf(_SC_PHYS_PAGES), page = sysconf(_SC_PAGESIZE);
+    return pages > 0 && page > 0 ? (size_t)pages * (size_t)page : 0;
+#else
+    return 0;
+#endif
+}
+
+// === Data ===
+static uint64_t nextRand(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// hitPercent of the queries are keys, the rest the even numbers 0..2n
+// around them.
+static void makeQueries(uint32_t *queries, size_t count, size_t n, int hitPercent, uint64_t *state) {
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t r = nextRand(state);
+        int hit = (int)(r % 100) < hitPercent;
+        size_t pos = (size_t)((r >> 8) % (hit ? n : n + 1));
+        queries[i] = (uint32_t)(2 * pos + hit);
+    }
+}
+
+// === Tested functions ===
+// Each runs every query and returns the sum of the values found, so the
+// results of all kernels can be compared and none of the work is dead.
+struct Data {
+    const uint32_t *sorted;
+    size_t n;
+    struct Eytzinger eytz;
+    struct KaryTree kary;
+};
+
+typedef uint64_t (*test_func_t)(const struct Data *d, const uint32_t *queries, size_t count);
+
+static uint64_t found(const uint32_t *p) {
+    return p ? *p : PAST_END;
+}
+
+static uint64_t runBranchy(const struct Data *d, const uint32_t *queries, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t at = lowerBoundBranchy(d->sorted, d->n, queries[i]);
+        sum += at < d->n ? d->sorted[at] : PAST_END;
+    }
+    return sum;
+}
+
+static uint64_t runBranchless(const struct Data *d, const uint32_t *queries, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t at = lowerBoundBranchless(d->sorted, d->n, queries[i]);
+        sum += at < d->n ? d->sorted[at] : PAST_END;
+    }
+    return sum;
+}
+
+static uint64_t runEytzinger(const struct Data *d, const uint32_t *queries, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i)
+        sum += found(eytzingerLowerBound(&d->eytz, queries[i]));
+    return sum;
+}
+
+static uint64_t runKaryScalar(const struct Data *d, const uint32_t *queries, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i)
+        sum += found(karyLowerBoundScalar(&d->kary, queries[i]));
+    return sum;
+}
+
+static uint64_t runKaryAvx2(const struct Data *d, const uint32_t *queries, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i)
+        sum += found(karyLowerBoundAvx2(&d->kary, queries[i]));
+    return sum;
+}
+
+// === Utility structures ===
+struct TestCase {
+    const char *name;
+    test_func_t func;
+    int cpu;
+    long long ns[NUM_MIXES];
+    uint64_t sum[NUM_MIXES];
+};
+
+// The expected sum: the lower bound of q is key q / 2.
+static uint64_t expectedSum(const uint32_t *queries, size_t count, size_t n) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t at = queries[i] / 2;
+        sum += at < n ? 2 * (uint64_t)at + 1 : PAST_END;
+    }
+    return sum;
+}
+
+// === Test runner ===
+static void test_function(struct TestCase *test, const struct Data *d, const uint32_t *queries,
+                          size_t count, int mix) {
+    long long best = -1;
+    for (int t = 0; t < TRIALS; ++t) {
+        long long start = nowNs();
+        uint64_t sum = test->func(d, queries, count);
+        long long end = nowNs();
+        if (best < 0 || end - start < best) best = end - start;
+        test->sum[mix] = sum;
+    }
+    test->ns[mix] = best;
+}
+
+// === Results ===
+static void print_results(const struct TestCase *tests, int num_tests, size_t count) {
+    printf("%-22s", "Kernel (ns/query)");
+    for (int m = 0; m < NUM_MIXES; ++m) {
+        char head[32];
+        snprintf(head, sizeof(head), "%d%% hits", hitPercents[m]);
+        printf(" %-18s", head);
+    }
+    printf("\n----------------------------------------------------------------------------------\n");
+    for (int i = 0; i < num_tests; ++i) {
+        if (!cpuSupports(tests[i].cpu)) continue;
+        printf("%-22s", tests[i].name);
+        for (int m = 0; m < NUM_MIXES; ++m) {
+            char cell[32];
+            snprintf(cell, sizeof(cell), "%.1f (x%.2f)", (double)tests[i].ns[m] / count,
+                     (double)tests[0].ns[m] / tests[i].ns[m]);
+            printf(" %-18s", cell);
+        }
+        printf("\n");
+    }
+}
+
+// === main ===
+// Usage: test_lower_bound [--queries Q] [--max N] [elements...]
+//   elements      array sizes, default 1K, 4K, 16K, ... 1G (every 4x)
+//   --queries Q   lookups per kernel and hit mix (default 1000000)
+//   --max N       skip sizes above N elements; sizes whose arrays (about
+//                 12 bytes per element) do not fit in 3/4 of physical
+//                 memory are skipped either way
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    size_t sizes[32], maxN = ((size_t)1 << 31) - 1, count = 1000000;
+    int numSizes = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--queries") == 0 && i + 1 < argc)
+            count = (size_t)strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--max") == 0 && i + 1 < argc)
+            maxN = (size_t)strtoull(argv[++i], NULL, 10);
+        else if (numSizes < 32)
+            sizes[numSizes++] = (size_t)strtoull(argv[i], NULL, 10);
+    }
+    if (numSizes == 0)
+        for (size_t n = (size_t)1 << 10; n <= (size_t)1 << 30; n *= 4)
+            sizes[numSizes++] = n;
+    if (count == 0) count = 1;
+    // Keys are 2i + 1 and the past-the-end miss is 2n; both must fit in
+    // a uint32_t.
+    if (maxN > ((size_t)1 << 31) - 1) maxN = ((size_t)1 << 31) - 1;
+
+    struct TestCase tests[] = {
+        {"branchy",               runBranchy,    CPU_ANY,  {0}, {0}},
+        {"branchless (cmov)",     runBranchless, CPU_ANY,  {0}, {0}},
+        {"Eytzinger + prefetch",  runEytzinger,  CPU_ANY,  {0}, {0}},
+        {"k-ary, scalar",         runKaryScalar, CPU_ANY,  {0}, {0}},
+        {"k-ary, AVX2",           runKaryAvx2,   CPU_AVX2, {0}, {0}}
+    };
+    int num_tests = sizeof(tests) / sizeof(tests[0]);
+
+    size_t phys = physBytes();
+    uint64_t state = 0x9E3779B97F4A7C15ULL ^ (uint64_t)time(NULL);
+    printf("\nlibbranchless %d, lower_bound on uint32_t, %zu queries per cell\n",
+           branchlessVersion(), count);
+
+    uint32_t *queries[NUM_MIXES];
+    for (int m = 0; m < NUM_MIXES; ++m) {
+        queries[m] = malloc(count * sizeof(uint32_t));
+        if (!queries[m]) return 1;
+    }
+
+    int ok = 1;
+    for (int s = 0; s < numSizes; ++s) {
+        size_t n = sizes[s];
+        if (n == 0) continue;
+        size_t need = n * 12 + 2 * 64 * sizeof(uint32_t);
+        if (n > maxN || (phys && need > phys / 4 * 3)) {
+            printf("\n=== %zu elements: skipped (needs %.1f GB", n, need / 1e9);
+            if (phys) printf(", %.1f GB installed", phys / 1e9);
+            printf(") ===\n");
+            continue;
+        }
+
+        struct Data d;
+        memset(&d, 0, sizeof(d));
+        uint32_t *sorted = malloc(n * sizeof(uint32_t));
+        if (!sorted) return 1;
+        for (size_t i = 0; i < n; ++i)
+            sorted[i] = (uint32_t)(2 * i + 1);
+        d.sorted = sorted;
+        d.n = n;
+        long long start = nowNs();
+        if (eytzingerInit(&d.eytz, sorted, n) != 0) return 1;
+        long long mid = nowNs();
+        if (karyInit(&d.kary, sorted, n) != 0) return 1;
+        long long end = nowNs();
+
+        printf("\n=== %zu elements (%.1f MB) ===\n", n, n * sizeof(uint32_t) / 1048576.0);
+        printf("Layouts built: Eytzinger %.1f ms, k-ary %.1f ms\n", (mid - start) / 1e6, (end - mid) / 1e6);
+        int equal = 1;
+        for (int m = 0; m < NUM_MIXES; ++m) {
+            makeQueries(queries[m], count, n, hitPercents[m], &state);
+            uint64_t want = expectedSum(queries[m], count, n);
+            for (int i = 0; i < num_tests; ++i)
+                if (cpuSupports(tests[i].cpu)) {
+                    test_function(&tests[i], &d, queries[m], count, m);
+                    equal &= tests[i].sum[m] == want;
+                }
+        }
+        print_results(tests, num_tests, count);
+        printf("Results match: %s\n", equal ? "YES" : "NO");
+        ok &= equal;
+
+        karyFree(&d.kary);
+        eytzingerFree(&d.eytz);
+        free(sorted);
+    }
+    for (int m = 0; m < NUM_MIXES; ++m) free(queries[m]);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <immintrin.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "branchless.h"
+#include "tsc.h"
+
+const int STR_LEN = 2048;
+
+// === Random string generation ===
+void randStr(char* s) {
+    for (int i = 0; i < STR_LEN; i++) {
+        s[i] = (rand() % 2 == 0)
+            ? ('A' + rand() % 26)
+            : ('a' + rand() % 26);
+    }
+    s[STR_LEN] = '\0';
+}
+
+// === Utility structures ===
+struct TestCase {
+    const char *name;
+    const char *kernel;               // name in upperKernels()
+    const struct UpperKernel *k;      // looked up in main
+    long long warm;
+    long long cold;
+};
+
+static const struct UpperKernel *findKernel(const char *name) {
+    int count;
+    const struct UpperKernel *kernels = upperKernels(&count);
+    for (int i = 0; i < count; ++i)
+        if (strcmp(kernels[i].name, name) == 0)
+            return &kernels[i];
+    return NULL;
+}
+
+static int supported(const struct TestCase *test) {
+    return test->k && cpuSupports(test->k->cpu);
+}
+
+// === Helper functions ===
+char **makeList(int count) {
+    char **list = malloc(count * sizeof(char *));
+    if (!list) return NULL;
+
+    for (int i = 0; i < count; ++i) {
+        list[i] = malloc(STR_LEN + 1);
+        if (!list[i]) {
+            for (int j = 0; j < i; ++j) free(list[j]);
+            free(list);
+            return NULL;
+        }
+        randStr(list[i]);
+    }
+    return list;
+}
+
+void freeList(char **list, int count) {
+    for (int i = 0; i < count; ++i)
+        free(list[i]);
+    free(list);
+}
+
+// Copies the master strings back over the working list, as
+// test_without_inline does, so a timed pass never sees strings an
+// earlier pass already uppercased.
+void restoreList(char **list, char **master, int count) {
+    for (int i = 0; i < count; ++i)
+        memcpy(list[i], master[i], STR_LEN + 1);
+}
+
+// Evicts a range from every cache level.
+static void flushRange(const void *p, size_t len) {
+    const char *c = (const char *)p;
+    if (!len) return;
+    for (size_t off = 0; off < len; off += 64)
+        _mm_clflush(c + off);
+    _mm_clflush(c + len - 1);
+}
+
+// Cold-cache state for one call: the string and the kernel's lookup table
+// (from the registry) are flushed, then fenced so the flushes complete
+// before the timer starts.
+static void evictAll(const char *str, const struct UpperKernel *k) {
+    flushRange(str, STR_LEN + 1);
+    flushRange(k->table, k->tableSize);
+    _mm_mfence();
+}
+
+// All kernels must agree with branchlessUpperCase2N on the full byte
+// range and on every tail length.
+int verify(struct TestCase *tests, int num) {
+    unsigned char orig[300], ref[300], buf[300];
+    for (int round = 0; round < 2000; ++round) {
+        size_t len = (size_t)(round % 300);
+        for (size_t k = 0; k < sizeof(orig); ++k)
+            orig[k] = (unsigned char)rand();
+        memcpy(ref, orig, sizeof(orig));
+        branchlessUpperCase2N((char *)ref, len);
+        for (int i = 0; i < num; ++i) {
+            if (!supported(&tests[i])) continue;
+            memcpy(buf, orig, sizeof(orig));
+            tests[i].k->func((char *)buf, len);
+            if (memcmp(buf, ref, sizeof(ref)) != 0) {
+                printf("MISMATCH: %s (len %zu)\n", tests[i].name, len);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// === Measurements ===
+// Warm: the corpus is already resident (one untimed pass), and the whole
+// batch is timed at once, as in test_without_inline.c. The corpus is
+// restored from its master copy after the untimed pass, so the timed
+// pass maps the same mixed-case input the cold path does.
+void test_warm(struct TestCase *test, int iterations) {
+    char **master = makeList(iterations);
+    char **list = makeList(iterations);
+    if (!master || !list) {
+        if (master) freeList(master, iterations);
+        if (list) freeList(list, iterations);
+        return;
+    }
+
+    upper_func_t func = test->k->func;
+    restoreList(list, master, iterations);
+    for (int i = 0; i < iterations; ++i)
+        func(list[i], STR_LEN);
+    restoreList(list, master, iterations);
+
+    long long start = nowNs();
+    for (int i = 0; i < iterations; ++i)
+        func(list[i], STR_LEN);
+    long long end = nowNs();
+    freeList(list, iterations);
+    freeList(master, iterations);
+
+    test->warm = end - start; // in nanoseconds
+}
+
+// Cold: each call is timed on its own after evictAll, and the cost of an
+// empty timed region (measured the same way) is subtracted.
+void test_cold(struct TestCase *test, int iterations, long long timerOverhead) {
+    char **list = makeList(iterations);
+    if (!list) return;
+
+    upper_func_t func = test->k->func;
+    long long total = 0;
+    for (int i = 0; i < iterations; ++i) {
+        evictAll(list[i], test->k);
+        long long start = nowNs();
+        func(list[i], STR_LEN);
+        long long end = nowNs();
+        total += end - start - timerOverhead;
+    }
+    freeList(list, iterations);
+
+    test->cold = total > 0 ? total : 0;
+}
+
+long long calibrateTimer(void) {
+    long long best = -1;
+    for (int i = 0; i < 1000; ++i) {
+        long long start = nowNs();
+        long long end = nowNs();
+        if (best < 0 || end - start < best)
+            best = end - start;
+    }
+    return best;
+}
+
+// === Results printing ===
+void print_results(struct TestCase *tests, int num, int iterations) {
+    printf("\n=== TEST RESULTS ===\n");
+    printf("%-20s %-26s %-26s\n", "Function", "Warm: ns / per call", "Cold: ns / per call");
+    printf("--------------------------------------------------------------------------\n");
+
+    long long minWarm = -1, minCold = -1;
+    for (int i = 0; i < num; ++i) {
+        if (!supported(&tests[i])) continue;
+        if (minWarm < 0 || tests[i].warm < minWarm) minWarm = tests[i].warm;
+        if (minCold < 0 || tests[i].cold < minCold) minCold = tests[i].cold;
+    }
+
+    for (int i = 0; i < num; ++i) {
+        if (!supported(&tests[i])) {
+            printf("%-20s (skipped: no %s)\n", tests[i].name, tests[i].k ? cpuName(tests[i].k->cpu) : tests[i].kernel);
+            continue;
+        }
+        printf("%-20s %-10lld %-8.2f (x%.3f)  %-10lld %-8.2f (x%.3f)\n",
+               tests[i].name,
+               tests[i].warm, (double)tests[i].warm / iterations,
+               (double)tests[i].warm / (minWarm > 0 ? minWarm : 1),
+               tests[i].cold, (double)tests[i].cold / iterations,
+               (double)tests[i].cold / (minCold > 0 ? minCold : 1));
+    }
+    printf("\n");
+}
+
+// === main ===
+int main(void) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    srand((unsigned)time(NULL));
+
+    const int ITERATIONS = 1000;
+
+    struct TestCase tests[] = {
+        {"Branchless 2",     "branchless2", NULL, 0, 0},
+        {"LUT 256",          "lut",         NULL, 0, 0},
+        {"vpshufb nibble",   "pshufb",      NULL, 0, 0},
+        {"vpermb full-byte", "vpermb",      NULL, 0, 0}
+    };
+    int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; ++i)
+        tests[i].k = findKernel(tests[i].kernel);
+
+    printf("\nVerifying kernels...\n");
+    if (!verify(tests, num_tests)) return 1;
+
+    long long timerOverhead = calibrateTimer();
+    printf("Timer overhead: %lld ns per timed call\n", timerOverhead);
+    printf("Running tests (%d iterations)...\n", ITERATIONS);
+
+    for (int i = 0; i < num_tests; ++i) {
+        if (!supported(&tests[i])) continue;
+        test_warm(&tests[i], ITERATIONS);
+        test_cold(&tests[i], ITERATIONS, timerOverhead);
+    }
+
+    print_results(tests, num_tests, ITERATIONS);
+    return 0;
+}
@@ -0,0 +1,370 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "branchless.h"
+#include "numa.h"
+#include "tsc.h"
+
+// Parallel clamp over arrays of hundreds of MB. The array is split into
+// page-aligned chunks, one per thread; every thread is pinned to a CPU
+// (spread round-robin over the NUMA nodes) and runs clampArray on its own
+// chunk. What changes between modes is where the chunk's pages live:
+//
+//   serial       the main thread writes the whole array, so every page
+//                sits on the main thread's node;
+//   first-touch  each thread writes its own chunk first, so the kernel's
+//                default local policy puts it on that thread's node;
+//   mbind        (--mbind) each chunk is bound to its thread's node with
+//                mbind before the main thread writes it.
+//
+// The timed part is the clamp passes only; threads are created once per
+// row and wait on a barrier between commands.
+
+const double MIN = -1.0, MAX = 1.0;
+const int PASSES = 5;
+#define MAX_THREADS 256
+#define CHUNK_ALIGN 512   // doubles per 4 KB page
+
+enum { MODE_SERIAL, MODE_FIRST_TOUCH, MODE_MBIND, NUM_MODES };
+static const char *modeNames[NUM_MODES] = {"serial", "first-touch", "mbind"};
+
+// === Data ===
+// Element i is a function of i alone, so any partition writes the same
+// array and the result can be checked without keeping a copy. Uniform
+// in [-2, 2), like the Dart data.
+static double valueAt(size_t i) {
+    uint64_t x = (uint64_t)i * 0x9E3779B97F4A7C15ULL;
+    x ^= x >> 31;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 29;
+    return (double)(x >> 11) / 9007199254740992.0 * 4.0 - 2.0;
+}
+
+static void fill(double *p, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) p[i] = valueAt(i);
+}
+
+// === Thread pool ===
+enum { CMD_FILL, CMD_CLAMP, CMD_QUIT };
+
+struct Worker {
+    pthread_t tid;
+    int cpu, node;
+    size_t begin, end;
+};
+
+struct Pool {
+    struct Worker workers[MAX_THREADS];
+    int threads;
+    double *data;
+    int command;
+    pthread_barrier_t go, done;
+    pthread_mutex_t startLock;   // held until the barriers are set up
+};
+
+static void pinTo(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+struct WorkerArg {
+    struct Pool *pool;
+    int index;
+};
+
+static void *workerMain(void *arg) {
+    struct Pool *pool = ((struct WorkerArg *)arg)->pool;
+    struct Worker *w = &pool->workers[((struct WorkerArg *)arg)->index];
+    free(arg);
+    pinTo(w->cpu);
+    pthread_mutex_lock(&pool->startLock);
+    pthread_mutex_unlock(&pool->startLock);
+    for (;;) {
+        pthread_barrier_wait(&pool->go);
+        if (pool->command == CMD_QUIT) break;
+        if (pool->command == CMD_FILL)
+            fill(pool->data, w->begin, w->end);
+        else
+            clampArray(pool->data + w->begin, w->end - w->begin, MIN, MAX);
+        pthread_barrier_wait(&pool->done);
+    }
+    return NULL;
+}
+
+static void runCommand(struct Pool *pool, int command) {
+    pool->command = command;
+    pthread_barrier_wait(&pool->go);
+    if (command != CMD_QUIT) pthread_barrier_wait(&pool->done);
+}
+
+// CPUs in node round-robin order: node 0's first CPU, node 1's first,
+// ..., node 0's second, ... so that T threads cover min(T, nodes) nodes.
+static int spreadCpus(int *cpus, int *nodes, int max) {
+    int numNodes = numaNodeCount();
+    static int perNode[NUMA_MAX_NODES][MAX_THREADS];
+    int counts[NUMA_MAX_NODES] = {0};
+    int node = 0, found = 0;
+    for (; node < NUMA_MAX_NODES && found < numNodes; ++node) {
+        counts[node] = numaNodeCpus(node, perNode[node], MAX_THREADS);
+        if (counts[node] > 0) ++found;
+    }
+    int n = 0;
+    for (int round = 0; n < max; ++round) {
+        int added = 0;
+        for (int k = 0; k < node && n < max; ++k) {
+            if (round >= counts[k]) continue;
+            cpus[n] = perNode[k][round];
+            nodes[n++] = k;
+            added = 1;
+        }
+        if (!added) break;
+    }
+    return n;
+}
+
+// Returns 0, or -1 when a worker could not be started. Either way the
+// pool holds only the workers that did start, and stopPool ends them.
+static int startPool(struct Pool *pool, int threads, double *data, size_t n,
+                     const int *cpus, const int *nodes, int numCpus) {
+    pool->data = data;
+    pthread_mutex_init(&pool->startLock, NULL);
+    pthread_mutex_lock(&pool->startLock);
+    int started = 0;
+    size_t pages = (n + CHUNK_ALIGN - 1) / CHUNK_ALIGN;
+    for (int t = 0; t < threads; ++t) {
+        struct Worker *w = &pool->workers[t];
+        w->cpu = cpus[t % numCpus];
+        w->node = nodes[t % numCpus];
+        w->begin = pages * t / threads * CHUNK_ALIGN;
+        w->end = pages * (t + 1) / threads * CHUNK_ALIGN;
+        if (w->begin > n) w->begin = n;
+        if (w->end > n) w->end = n;
+        struct WorkerArg *arg = malloc(sizeof(*arg));
+        if (!arg) break;
+        arg->pool = pool;
+        arg->index = t;
+        if (pthread_create(&w->tid, NULL, workerMain, arg) != 0) {
+            free(arg);
+            break;
+        }
+        ++started;
+    }
+    // The barriers count only the workers that exist.
+    pool->threads = started;
+    pthread_barrier_init(&pool->go, NULL, (unsigned)started + 1);
+    pthread_barrier_init(&pool->done, NULL, (unsigned)started + 1);
+    pthread_mutex_unlock(&pool->startLock);
+    return started < threads ? -1 : 0;
+}
+
+static void stopPool(struct Pool *pool) {
+    runCommand(pool, CMD_QUIT);
+    for (int t = 0; t < pool->threads; ++t)
+        pthread_join(pool->workers[t].tid, NULL);
+    pthread_barrier_destroy(&pool->go);
+    pthread_barrier_destroy(&pool->done);
+    pthread_mutex_destroy(&pool->startLock);
+}
+
+// === Memory ===
+// Anonymous mappings are untouched until written, so the first write
+// (or an mbind beforehand) decides placement.
+static double *mapArray(size_t n) {
+#ifdef _WIN32
+    return VirtualAlloc(NULL, n * sizeof(double), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    void *p = mmap(NULL, n * sizeof(double), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+#endif
+}
+
+static void unmapArray(double *p, size_t n) {
+#ifdef _WIN32
+    (void)n;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, n * sizeof(double));
+#endif
+}
+
+// Fraction of sampled pages that sit on their worker's node; -1 when the
+// kernel does not report placement.
+static double localFraction(struct Pool *pool) {
+    int local = 0, known = 0;
+    for (int t = 0; t < pool->threads; ++t) {
+        struct Worker *w = &pool->workers[t];
+        size_t span = w->end - w->begin;
+        for (int s = 0; s < 64 && span; ++s) {
+            int node = numaNodeOfAddr(pool->data + w->begin + span * s / 64);
+            if (node < 0) continue;
+            ++known;
+            local += node == w->node;
+        }
+    }
+    return known ? (double)local / known : -1.0;
+}
+
+// === Single row ===
+struct Row {
+    long long ns;        // best pass
+    double local;        // localFraction
+    int placed;          // 0 when mbind failed
+    int ok;              // every element equals clampTernary(valueAt(i))
+};
+
+static struct Row runRow(int mode, int threads, size_t n, const int *cpus, const int *nodes, int numCpus) {
+    struct Row row = {0, -1.0, 1, 0};
+    double *data = mapArray(n);
+    if (!data) return row;
+
+    struct Pool *pool = calloc(1, sizeof(*pool));
+    if (!pool || startPool(pool, threads, data, n, cpus, nodes, numCpus) != 0) {
+        if (pool) stopPool(pool);
+        free(pool);
+        unmapArray(data, n);
+        return row;
+    }
+    if (mode == MODE_MBIND)
+        for (int t = 0; t < threads; ++t) {
+            struct Worker *w = &pool->workers[t];
+            if (w->end > w->begin &&
+                numaBind(data + w->begin, (w->end - w->begin) * sizeof(double), w->node) != 0)
+                row.placed = 0;
+        }
+    if (mode == MODE_FIRST_TOUCH)
+        runCommand(pool, CMD_FILL);
+    else
+        fill(data, 0, n);
+    row.local = localFraction(pool);
+
+    for (int p = 0; p < PASSES; ++p) {
+        long long start = nowNs();
+        runCommand(pool, CMD_CLAMP);
+        long long end = nowNs();
+        if (row.ns == 0 || end - start < row.ns) row.ns = end - start;
+    }
+    stopPool(pool);
+    free(pool);
+
+    row.ok = 1;
+    for (size_t i = 0; i < n && row.ok; ++i)
+        row.ok = data[i] == clampTernary(valueAt(i), MIN, MAX);
+    unmapArray(data, n);
+    return row;
+}
+
+// === Results printing ===
+// GB/s counts the read and the write of every element.
+void print_mode(int mode, const int *threadCounts, int numCounts, size_t n,
+                const int *cpus, const int *nodes, int numCpus, int *allOk) {
+    printf("\n=== %s ===\n", modeNames[mode]);
+    printf("%-8s %-15s %-10s %-10s %-10s %s\n", "Threads", "Time (nanosec)", "GB/s", "Speedup", "Local", "Nodes");
+    printf("----------------------------------------------------------------\n");
+    long long base = 0;
+    for (int c = 0; c < numCounts; ++c) {
+        int threads = threadCounts[c];
+        struct Row row = runRow(mode, threads, n, cpus, nodes, numCpus);
+        if (row.ns == 0) {
+            printf("%-8d (allocation or thread start failed)\n", threads);
+            *allOk = 0;
+            continue;
+        }
+        if (!base) base = row.ns;
+        char local[16];
+        if (row.local < 0) snprintf(local, sizeof(local), "n/a");
+        else snprintf(local, sizeof(local), "%.0f%%", row.local * 100.0);
+        int used = threads < numCpus ? threads : numCpus;
+        int usedNodes = 0;
+        for (int k = 0; k < used; ++k) {
+            int seen = 0;
+            for (int j = 0; j < k; ++j) seen |= nodes[j] == nodes[k];
+            usedNodes += !seen;
+        }
+        printf("%-8d %-15lld %-10.2f %-10.2f %-10s %d%s%s\n",
+               threads, row.ns,
+               2.0 * (double)n * sizeof(double) / (double)row.ns,
+               (double)base / (double)row.ns,
+               local, usedNodes,
+               row.placed ? "" : "  (mbind failed)",
+               row.ok ? "" : "  MISMATCH");
+        *allOk &= row.ok;
+    }
+}
+
+// === main ===
+// Usage: test_parallel_clamp [--mb M] [--threads N] [--mbind]
+//   --mb M        array size in MB (default 512)
+//   --threads N   largest thread count; rows are 1, 2, 4, ... and N
+//                 (default: online CPUs)
+//   --mbind       add the mbind placement mode
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    size_t mb = 512;
+    int maxThreads = 0, useMbind = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--mb") == 0 && i + 1 < argc)
+            mb = (size_t)strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            maxThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--mbind") == 0)
+            useMbind = 1;
+    }
+
+    static int cpus[MAX_THREADS], nodes[MAX_THREADS];
+    int numCpus = spreadCpus(cpus, nodes, MAX_THREADS);
+    if (numCpus == 0) {
+        cpus[0] = 0;
+        nodes[0] = 0;
+        numCpus = 1;
+    }
+    pinTo(cpus[0]);   // the serial mode's pages land on node 0
+    if (maxThreads <= 0) maxThreads = numCpus;
+    if (maxThreads > MAX_THREADS) maxThreads = MAX_THREADS;
+
+    int threadCounts[16], numCounts = 0;
+    for (int t = 1; t < maxThreads && numCounts < 15; t *= 2)
+        threadCounts[numCounts++] = t;
+    threadCounts[numCounts++] = maxThreads;
+
+    size_t n = mb * 1024 * 1024 / sizeof(double);
+    int numNodes = numaNodeCount();
+    printf("\nlibbranchless %d, parallel clamp over %zu MB (%zu doubles)\n", branchlessVersion(), mb, n);
+    printf("NUMA nodes: %d, CPUs: %d, best of %d passes\n", numNodes, numCpus, PASSES);
+    if (numNodes == 1)
+        printf("Single NUMA node: every page is local whatever the mode, so placement has\n"
+               "no effect on this machine; the modes should agree within noise.\n");
+    if (maxThreads > numCpus)
+        printf("WARNING: %d threads on %d CPUs, rows above %d are oversubscribed\n",
+               maxThreads, numCpus, numCpus);
+
+    int ok = 1;
+    for (int mode = 0; mode < NUM_MODES; ++mode) {
+        if (mode == MODE_MBIND && !useMbind) continue;
+        print_mode(mode, threadCounts, numCounts, n, cpus, nodes, numCpus, &ok);
+    }
+    printf("\nResults match clampTernary: %s\n\n", ok ? "YES" : "NO");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,568 @@
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "branchless.h"
+#include "tsc.h"
+
+// A record-processing stage chain, read -> uppercase -> validate -> hash
+// -> write, over a file of newline-separated records:
+//
+//   read      fill a batch buffer from the input file and cut it at the
+//             last newline (the partial record is carried over);
+//   upper     upperCase over the whole batch in one call;
+//   validate  asciiCheck per record, counting records that are not clean
+//             printable ASCII;
+//   hash      ascii_hash per record into one running, order-dependent
+//             hash of the whole file;
+//   write     write the batch to the output file.
+//
+// Serially every batch goes through all five stages before the next one
+// is read. In the pipeline every stage is a C++20 coroutine on a small
+// thread pool; stages hand batches on through bounded channels, as
+// unique_ptrs, so a batch buffer is filled once by read() and never
+// copied. Up to POOL_BATCHES batches are in flight; write returns them to
+// the free list that read takes from.
+//
+// Cold rows evict both files from the page cache first (fadvise), so
+// reads and write-back hit the disk and there is I/O to overlap. Both
+// paths must produce the same hash and the same number of bad records.
+
+const int TRIALS = 3;
+const size_t BATCH_BYTES = 1 << 20;
+const int POOL_BATCHES = 8;
+const int CHANNEL_DEPTH = 2;
+
+// === Executor ===
+// A fixed pool of threads resuming coroutine handles in FIFO order.
+class Executor {
+public:
+    explicit Executor(int threads) {
+        for (int i = 0; i < threads; ++i)
+            workers.emplace_back([this] { run(); });
+    }
+
+    ~Executor() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &t : workers) t.join();
+    }
+
+    void post(std::coroutine_handle<> h) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(h);
+        }
+        wake.notify_one();
+    }
+
+    // co_await ex.schedule() continues the coroutine on a pool thread.
+    auto schedule() {
+        struct Awaiter {
+            Executor *ex;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { ex->post(h); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{this};
+    }
+
+private:
+    void run() {
+        for (;;) {
+            std::coroutine_handle<> h;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !ready.empty(); });
+                if (ready.empty()) return;
+                h = ready.front();
+                ready.pop_front();
+            }
+            h.resume();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::coroutine_handle<>> ready;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+};
+
+// === Task ===
+// Fire-and-forget coroutine: starts running on the caller's thread and
+// frees itself when it returns. Stages signal completion through a latch.
+struct Task {
+    struct promise_type {
+        Task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// === Channel ===
+// Bounded multi-producer multi-consumer queue between coroutines. send
+// suspends while the channel is full; recv suspends while it is empty and
+// yields std::nullopt once it is closed and drained. A suspended side is
+// resumed through the executor, never inline on the other side's thread
+// of control.
+template <class T>
+class Channel {
+public:
+    Channel(Executor &ex, size_t capacity) : ex(ex), capacity(capacity) {}
+
+    struct SendAwaiter {
+        Channel *ch;
+        T value;
+        std::coroutine_handle<> handle;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h) {
+            std::lock_guard<std::mutex> lock(ch->mutex);
+            if (!ch->receivers.empty()) {
+                auto *r = ch->receivers.front();
+                ch->receivers.pop_front();
+                r->result = std::move(value);
+                ch->ex.post(r->handle);
+                return false;
+            }
+            if (ch->items.size() < ch->capacity) {
+                ch->items.push_back(std::move(value));
+                return false;
+            }
+            handle = h;
+            ch->senders.push_back(this);
+            return true;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    struct RecvAwaiter {
+        Channel *ch;
+        std::optional<T> result;
+        std::coroutine_handle<> handle;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h) {
+            std::lock_guard<std::mutex> lock(ch->mutex);
+            if (!ch->items.empty()) {
+                result = std::move(ch->items.front());
+                ch->items.pop_front();
+                if (!ch->senders.empty()) {
+                    auto *s = ch->senders.front();
+                    ch->senders.pop_front();
+                    ch->items.push_back(std::move(s->value));
+                    ch->ex.post(s->handle);
+                }
+                return false;
+            }
+            if (ch->closed) return false;
+            handle = h;
+            ch->receivers.push_back(this);
+            return true;
+        }
+        std::optional<T> await_resume() { return std::move(result); }
+    };
+
+    SendAwaiter send(T value) { return SendAwaiter{this, std::move(value), {}}; }
+    RecvAwaiter recv() { return RecvAwaiter{this, std::nullopt, {}}; }
+
+    // Only after the last send; pending receivers get std::nullopt.
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        for (auto *r : receivers) ex.post(r->handle);
+        receivers.clear();
+    }
+
+private:
+    Executor &ex;
+    size_t capacity;
+    std::mutex mutex;
+    std::deque<T> items;
+    std::deque<SendAwaiter *> senders;
+    std::deque<RecvAwaiter *> receivers;
+    bool closed = false;
+};
+
+// === Batches and stage bodies ===
+// The stage bodies are plain functions; the serial driver calls them in
+// a loop and the pipeline wraps each one in a coroutine.
+struct Batch {
+    std::unique_ptr<char[]> data{new char[BATCH_BYTES]};
+    size_t len = 0;
+    std::vector<uint32_t> starts;    // record i is [starts[i], starts[i + 1] - 1)
+};
+using BatchPtr = std::unique_ptr<Batch>;
+
+struct Job {
+    int in = -1, out = -1;
+    off_t readAt = 0;
+    std::vector<char> carry;         // partial record from the previous read
+    int (*check)(const char *, size_t) = asciiCheckScalar;
+    uint64_t hash = 0;
+    uint64_t bad = 0, records = 0;
+    long long stageNs[5] = {0, 0, 0, 0, 0};
+    bool tooLong = false;            // stopped at a record longer than a batch
+};
+
+enum { ST_READ, ST_UPPER, ST_VALIDATE, ST_HASH, ST_WRITE, NUM_STAGES };
+static const char *stageNames[NUM_STAGES] = {"read", "upper", "validate", "hash", "write"};
+
+// Returns false at end of input. Records are cut at '\n'; a final record
+// without one is completed at end of file. Records must be shorter than
+// a batch: one that is not stops the run with job.tooLong set, rather
+// than passing for the end of the input.
+static bool readBatch(Job &job, Batch &b) {
+    b.len = job.carry.size();
+    memcpy(b.data.get(), job.carry.data(), b.len);
+    job.carry.clear();
+    bool eof = false;
+    while (b.len < BATCH_BYTES) {
+        ssize_t n = pread(job.in, b.data.get() + b.len, BATCH_BYTES - b.len, job.readAt);
+        if (n <= 0) {
+            eof = true;
+            break;
+        }
+        b.len += (size_t)n;
+        job.readAt += n;
+    }
+    size_t end = b.len;
+    if (b.len == BATCH_BYTES && b.data[end - 1] != '\n' &&
+        (eof || !memchr(b.data.get(), '\n', b.len))) {
+        job.tooLong = true;
+        return false;
+    }
+    if (!eof) {
+        while (end > 0 && b.data[end - 1] != '\n') --end;
+        job.carry.assign(b.data.get() + end, b.data.get() + b.len);
+        b.len = end;
+    } else if (end > 0 && b.data[end - 1] != '\n') {
+        b.data[b.len++] = '\n';
+    }
+    b.starts.clear();
+    for (size_t at = 0; at < b.len;) {
+        b.starts.push_back((uint32_t)at);
+        const char *nl = (const char *)memchr(b.data.get() + at, '\n', b.len - at);
+        at = nl ? (size_t)(nl - b.data.get()) + 1 : b.len;
+    }
+    b.starts.push_back((uint32_t)b.len);
+    return b.len > 0;
+}
+
+static void upperBatch(Job &, Batch &b) {
+    upperCase(b.data.get(), b.len);
+}
+
+static void validateBatch(Job &job, Batch &b) {
+    uint64_t bad = 0;
+    for (size_t i = 0; i + 1 < b.starts.size(); ++i)
+        bad += job.check(b.data.get() + b.starts[i], b.starts[i + 1] - b.starts[i] - 1) != 0;
+    job.bad += bad;
+}
+
+static void hashBatch(Job &job, Batch &b) {
+    uint64_t h = job.hash;
+    for (size_t i = 0; i + 1 < b.starts.size(); ++i)
+        h = h * 0x100000001B3ULL ^ ascii_hash(b.data.get() + b.starts[i], b.starts[i + 1] - b.starts[i] - 1, 0);
+    job.hash = h;
+    job.records += b.starts.size() - 1;
+}
+
+static bool writeBatch(Job &job, Batch &b) {
+    for (size_t done = 0; done < b.len;) {
+        ssize_t n = write(job.out, b.data.get() + done, b.len - done);
+        if (n <= 0) return false;
+        done += (size_t)n;
+    }
+    return true;
+}
+
+// === Serial driver ===
+static void runSerial(Job &job) {
+    Batch b;
+    for (;;) {
+        long long t0 = nowNs();
+        if (!readBatch(job, b)) break;
+        long long t1 = nowNs();
+        upperBatch(job, b);
+        long long t2 = nowNs();
+        validateBatch(job, b);
+        long long t3 = nowNs();
+        hashBatch(job, b);
+        long long t4 = nowNs();
+        writeBatch(job, b);
+        long long t5 = nowNs();
+        job.stageNs[ST_READ] += t1 - t0;
+        job.stageNs[ST_UPPER] += t2 - t1;
+        job.stageNs[ST_VALIDATE] += t3 - t2;
+        job.stageNs[ST_HASH] += t4 - t3;
+        job.stageNs[ST_WRITE] += t5 - t4;
+    }
+}
+
+// === Pipeline driver ===
+static Task readStage(Executor &ex, Job &job, Channel<BatchPtr> &freeList, Channel<BatchPtr> &out, std::latch &done) {
+    co_await ex.schedule();
+    for (;;) {
+        BatchPtr b = std::move(*co_await freeList.recv());
+        if (!readBatch(job, *b)) break;
+        co_await out.send(std::move(b));
+    }
+    out.close();
+    done.count_down();
+}
+
+static Task transformStage(Executor &ex, Job &job, void (*body)(Job &, Batch &),
+                           Channel<BatchPtr> &in, Channel<BatchPtr> &out, std::latch &done) {
+    co_await ex.schedule();
+    while (std::optional<BatchPtr> b = co_await in.recv()) {
+        body(job, **b);
+        co_await out.send(std::move(*b));
+    }
+    out.close();
+    done.count_down();
+}
+
+static Task writeStage(Executor &ex, Job &job, Channel<BatchPtr> &in, Channel<BatchPtr> &freeList, std::latch &done) {
+    co_await ex.schedule();
+    while (std::optional<BatchPtr> b = co_await in.recv()) {
+        writeBatch(job, **b);
+        co_await freeList.send(std::move(*b));
+    }
+    done.count_down();
+}
+
+static void runPipeline(Job &job, int threads) {
+    // Declared before the executor, so it outlives the pool threads: a
+    // stage may still be inside count_down when wait() returns.
+    std::latch done(NUM_STAGES);
+    Executor ex(threads);
+    Channel<BatchPtr> freeList(ex, POOL_BATCHES);
+    Channel<BatchPtr> toUpper(ex, CHANNEL_DEPTH), toValidate(ex, CHANNEL_DEPTH);
+    Channel<BatchPtr> toHash(ex, CHANNEL_DEPTH), toWrite(ex, CHANNEL_DEPTH);
+    // Filling the free list never suspends: it has room for every batch.
+    auto fill = [&]() -> Task {
+        for (int i = 0; i < POOL_BATCHES; ++i) co_await freeList.send(std::make_unique<Batch>());
+    };
+    fill();
+
+    readStage(ex, job, freeList, toUpper, done);
+    transformStage(ex, job, upperBatch, toUpper, toValidate, done);
+    transformStage(ex, job, validateBatch, toValidate, toHash, done);
+    transformStage(ex, job, hashBatch, toHash, toWrite, done);
+    writeStage(ex, job, toWrite, freeList, done);
+    done.wait();
+}
+
+// === Files ===
+// Records of 8..80 mixed-case letters; about one in 64 carries a Latin-1
+// byte, which the validate stage flags.
+static bool generateInput(const char *path, size_t bytes) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    std::vector<char> buf(1 << 16);
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    auto next = [&state] {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    size_t written = 0;
+    while (written < bytes) {
+        size_t n = 0;
+        while (n + 82 < buf.size()) {
+            size_t len = 8 + next() % 73;
+            for (size_t i = 0; i < len; ++i) {
+                uint64_t r = next();
+                buf[n + i] = (char)((r & 1 ? 'A' : 'a') + (r >> 1) % 26);
+            }
+            if (next() % 64 == 0) buf[n + next() % len] = (char)0xE9;
+            n += len;
+            buf[n++] = '\n';
+        }
+        if (fwrite(buf.data(), 1, n, f) != n) {
+            fclose(f);
+            return false;
+        }
+        written += n;
+    }
+    return fclose(f) == 0;
+}
+
+static void evict(int fd) {
+#ifdef POSIX_FADV_DONTNEED
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#else
+    (void)fd;
+#endif
+}
+
+struct Result {
+    long long ns = -1;
+    uint64_t hash = 0, bad = 0, records = 0;
+    long long stageNs[NUM_STAGES] = {0, 0, 0, 0, 0};
+    bool tooLong = false;
+};
+
+// threads == 0: serial. Best of TRIALS; the output is truncated and, for
+// cold runs, both files are evicted before every trial.
+static Result timeRun(const char *inPath, const char *outPath, int threads, bool cold) {
+    Result best;
+    for (int t = 0; t < TRIALS; ++t) {
+        Job job;
+        job.in = open(inPath, O_RDONLY);
+        job.out = open(outPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (job.in < 0 || job.out < 0) {
+            if (job.in >= 0) close(job.in);
+            if (job.out >= 0) close(job.out);
+            return best;
+        }
+        if (cpuSupports(CPU_AVX2)) job.check = asciiCheckAvx2;
+        else job.check = asciiCheckSwar;
+        if (cold) {
+            evict(job.in);
+            evict(job.out);
+        }
+        long long start = nowNs();
+        if (threads == 0) runSerial(job);
+        else runPipeline(job, threads);
+        long long ns = nowNs() - start;
+        close(job.in);
+        close(job.out);
+        if (job.tooLong) {
+            best.tooLong = true;
+            return best;
+        }
+        if (best.ns < 0 || ns < best.ns) {
+            best.ns = ns;
+            best.hash = job.hash;
+            best.bad = job.bad;
+            best.records = job.records;
+            memcpy(best.stageNs, job.stageNs, sizeof(best.stageNs));
+        }
+    }
+    return best;
+}
+
+// === Results printing ===
+void print_row(const char *name, const Result &r, const Result &serial, size_t bytes) {
+    printf("%-22s %-12.1f %-12.1f x%-9.3f %016llx\n",
+           name,
+           r.ns / 1e6,
+           (double)bytes / 1048576.0 / (r.ns / 1e9),
+           (double)serial.ns / (r.ns > 0 ? r.ns : 1),
+           (unsigned long long)r.hash);
+}
+
+// The serial run's time per stage. With perfect overlap the pipeline
+// can get no faster than its slowest stage.
+void print_stages(const Result &serial) {
+    long long total = 0, slowest = 0;
+    for (int s = 0; s < NUM_STAGES; ++s) {
+        total += serial.stageNs[s];
+        if (serial.stageNs[s] > slowest) slowest = serial.stageNs[s];
+    }
+    printf("Serial stage times:");
+    for (int s = 0; s < NUM_STAGES; ++s)
+        printf(" %s %.1f ms%s", stageNames[s], serial.stageNs[s] / 1e6, s + 1 < NUM_STAGES ? "," : "");
+    printf("\nOverlap bound: x%.3f (total / slowest stage)\n", (double)total / (slowest > 0 ? slowest : 1));
+}
+
+// === main ===
+// Usage: test_pipeline [--mb M] [--threads N] [--dir D]
+//   --mb M        input size in MB (default 256)
+//   --threads N   largest pool size; rows are 1, 2, 4, ... and N
+//                 (default 4)
+//   --dir D       where the input and output files go (default /tmp)
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    size_t mb = 256;
+    int maxThreads = 4;
+    const char *dir = "/tmp";
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--mb") == 0 && i + 1 < argc) mb = (size_t)strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) maxThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) dir = argv[++i];
+    }
+    if (mb < 1) mb = 1;
+    if (maxThreads < 1) maxThreads = 1;
+
+    char inPath[4096], outPath[4096];
+    snprintf(inPath, sizeof(inPath), "%s/branchless-pipeline-%d.in", dir, (int)getpid());
+    snprintf(outPath, sizeof(outPath), "%s/branchless-pipeline-%d.out", dir, (int)getpid());
+    size_t bytes = mb << 20;
+    if (!generateInput(inPath, bytes)) {
+        perror(inPath);
+        return 1;
+    }
+
+    printf("\nlibbranchless %d, read -> upper -> validate -> hash -> write, %zu MB, %zu KB batches\n",
+           branchlessVersion(), mb, BATCH_BYTES >> 10);
+    int ok = 1;
+    for (int cold = 0; cold < 2; ++cold) {
+        Result serial = timeRun(inPath, outPath, 0, cold);
+        if (serial.tooLong) {
+            printf("ERROR: %s has a record longer than a %zu KB batch\n", inPath, BATCH_BYTES >> 10);
+            ok = 0;
+            break;
+        }
+        if (serial.ns < 0) {
+            perror(outPath);
+            ok = 0;
+            break;
+        }
+        printf("\n=== %s page cache ===\n", cold ? "Cold" : "Warm");
+        printf("%-22s %-12s %-12s %-10s %s\n", "Driver", "Time (ms)", "MB/s", "Speedup", "Hash");
+        printf("------------------------------------------------------------------------\n");
+        print_row("serial", serial, serial, bytes);
+        for (int threads = 1;; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads) {
+            Result r = timeRun(inPath, outPath, threads, cold);
+            if (r.tooLong) {
+                printf("ERROR: pipeline, %d threads: a record longer than a batch\n", threads);
+                ok = 0;
+                break;
+            }
+            char name[32];
+            snprintf(name, sizeof(name), "pipeline, %d thread%s", threads, threads > 1 ? "s" : "");
+            print_row(name, r, serial, bytes);
+            ok &= r.hash == serial.hash && r.bad == serial.bad && r.records == serial.records;
+            if (threads == maxThreads) break;
+        }
+        print_stages(serial);
+        printf("Records: %llu, not clean ASCII: %llu\n",
+               (unsigned long long)serial.records, (unsigned long long)serial.bad);
+    }
+    unlink(inPath);
+    unlink(outPath);
+    printf("\nPipeline matches serial: %s\n\n", ok ? "YES" : "NO");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "branchless.h"
+#include "pool.h"
+#include "tsc.h"
+
+// Allocation throughput for fixed-size string buffers: glibc malloc/free
+// against a BufPool, with 1..N threads allocating and freeing at the same
+// time. Every thread repeats: allocate a batch, write the first byte of
+// each buffer, free the batch. A batch of 1 stays inside the thread
+// cache; a batch larger than the cache spills to and refills from the
+// shared stack, which is where threads contend. In the handoff pattern
+// the threads form a ring: each leaves its batch for the next thread and
+// frees the batch the previous thread allocated, so every buffer crosses
+// threads. A slot holds one batch, so that pattern also pays for waiting
+// on the neighbours, and it needs at least two threads.
+
+const int TRIALS = 3;
+const size_t BUF_SIZE = 2049;       // STR_LEN + 1
+const int OPS_PER_THREAD = 1 << 20;
+#define MAX_THREADS 64
+
+// === Allocators ===
+static struct BufPool *pool;
+
+static void *mallocAlloc(void) { return malloc(BUF_SIZE); }
+static void mallocFree(void *p) { free(p); }
+static void *poolAllocBuf(void) { return poolAlloc(pool); }
+static void poolFreeBuf(void *p) { poolFree(pool, p); }
+
+struct Allocator {
+    const char *name;
+    void *(*alloc)(void);
+    void (*free)(void *);
+};
+
+static const struct Allocator allocators[] = {
+    {"malloc", mallocAlloc, mallocFree},
+    {"BufPool", poolAllocBuf, poolFreeBuf}
+};
+
+// === Workers ===
+struct Run {
+    const struct Allocator *alloc;
+    int threads, batch, handoff;
+    pthread_barrier_t start;
+    void **slots[MAX_THREADS];       // handoff: batch left for thread i by i - 1
+    pthread_mutex_t slotLock[MAX_THREADS];
+    pthread_cond_t slotCond[MAX_THREADS];
+};
+
+struct WorkerArg {
+    struct Run *run;
+    int index;
+    long long ownFrees;              // handoff: buffers this thread allocated
+};
+
+static void *worker(void *arg) {
+    struct WorkerArg *self = arg;
+    struct Run *run = self->run;
+    int index = self->index;
+    int batch = run->batch;
+    void **mine = malloc(batch * sizeof(void *));
+    int next = (index + 1) % run->threads;
+
+    pthread_barrier_wait(&run->start);
+    for (int done = 0; done < OPS_PER_THREAD; done += batch) {
+        for (int i = 0; i < batch; ++i) {
+            mine[i] = run->alloc->alloc();
+            *(volatile char *)mine[i] = (char)index;   // the owner, for the check below
+        }
+        if (!run->handoff) {
+            for (int i = 0; i < batch; ++i) run->alloc->free(mine[i]);
+            continue;
+        }
+        // Leave our batch in the next thread's slot once it has taken the
+        // last one, then free the batch the previous thread left in ours.
+        // Every thread runs the same number of rounds, so all slots are
+        // empty again at the end.
+        pthread_mutex_lock(&run->slotLock[next]);
+        while (run->slots[next]) pthread_cond_wait(&run->slotCond[next], &run->slotLock[next]);
+        run->slots[next] = mine;
+        pthread_cond_signal(&run->slotCond[next]);
+        pthread_mutex_unlock(&run->slotLock[next]);
+
+        pthread_mutex_lock(&run->slotLock[index]);
+        while (!run->slots[index]) pthread_cond_wait(&run->slotCond[index], &run->slotLock[index]);
+        mine = run->slots[index];
+        run->slots[index] = NULL;
+        pthread_cond_signal(&run->slotCond[index]);
+        pthread_mutex_unlock(&run->slotLock[index]);
+        for (int i = 0; i < batch; ++i) {
+            self->ownFrees += *(volatile char *)mine[i] == (char)index;
+            run->alloc->free(mine[i]);
+        }
+    }
+    free(mine);
+    if (run->alloc->alloc == poolAllocBuf) poolFlush(pool);
+    return NULL;
+}
+
+// Best of TRIALS, in ns for threads * OPS_PER_THREAD alloc/free pairs.
+// *ownFrees counts handoff buffers freed by the thread that allocated
+// them, which must stay 0.
+long long timeRun(const struct Allocator *alloc, int threads, int batch, int handoff,
+                  long long *ownFrees) {
+    long long best = -1;
+    for (int t = 0; t < TRIALS; ++t) {
+        struct Run run;
+        memset(&run, 0, sizeof(run));
+        run.alloc = alloc;
+        run.threads = threads;
+        run.batch = batch;
+        run.handoff = handoff;
+        pthread_barrier_init(&run.start, NULL, (unsigned)threads + 1);
+        for (int i = 0; i < threads; ++i) {
+            pthread_mutex_init(&run.slotLock[i], NULL);
+            pthread_cond_init(&run.slotCond[i], NULL);
+        }
+
+        pthread_t tids[MAX_THREADS];
+        struct WorkerArg args[MAX_THREADS];
+        for (int i = 0; i < threads; ++i) {
+            args[i].run = &run;
+            args[i].index = i;
+            args[i].ownFrees = 0;
+            pthread_create(&tids[i], NULL, worker, &args[i]);
+        }
+        pthread_barrier_wait(&run.start);
+        long long start = nowNs();
+        for (int i = 0; i < threads; ++i) pthread_join(tids[i], NULL);
+        long long end = nowNs();
+
+        for (int i = 0; i < threads; ++i) {
+            *ownFrees += args[i].ownFrees;
+            pthread_cond_destroy(&run.slotCond[i]);
+            pthread_mutex_destroy(&run.slotLock[i]);
+        }
+        pthread_barrier_destroy(&run.start);
+        if (best < 0 || end - start < best) best = end - start;
+    }
+    return best;
+}
+
+// === Results printing ===
+// Returns 0, or 1 when a handoff buffer was freed by its own thread.
+int print_table(int batch, int handoff, const int *threadCounts, int numCounts) {
+    printf("\n=== batch %d, %s ===\n", batch, handoff ? "handoff (free on another thread)" : "local");
+    printf("%-8s %-18s %-18s %-10s %s\n", "Threads", "malloc (Mops/s)", "BufPool (Mops/s)", "Speedup", "Pool hit rate");
+    printf("------------------------------------------------------------------------\n");
+    long long ownFrees = 0;
+    for (int c = 0; c < numCounts; ++c) {
+        int threads = threadCounts[c];
+        if (handoff && threads < 2) {
+            printf("%-8d (needs two threads)\n", threads);
+            continue;
+        }
+        double ops = (double)threads * OPS_PER_THREAD;
+        struct PoolStats before, after;
+        long long m = timeRun(&allocators[0], threads, batch, handoff, &ownFrees);
+        poolStats(pool, &before);
+        long long p = timeRun(&allocators[1], threads, batch, handoff, &ownFrees);
+        poolStats(pool, &after);
+        uint64_t allocs = after.allocs - before.allocs;
+        uint64_t hits = after.cacheHits + after.sharedHits - before.cacheHits - before.sharedHits;
+        printf("%-8d %-18.1f %-18.1f x%-9.2f %.2f%% (%.2f%% shared)\n",
+               threads, ops * 1e3 / m, ops * 1e3 / p, (double)m / p,
+               100.0 * (double)hits / (allocs ? allocs : 1),
+               100.0 * (double)(after.sharedHits - before.sharedHits) / (allocs ? allocs : 1));
+    }
+    if (ownFrees) {
+        printf("MISMATCH: %lld buffers freed by the thread that allocated them\n", ownFrees);
+        return 1;
+    }
+    return 0;
+}
+
+// === main ===
+// Usage: test_pool [--threads N]
+//   --threads N   largest thread count; rows are 1, 2, 4, ... and N
+//                 (default 8)
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    int maxThreads = 8;
+    for (int i = 1; i < argc; ++i)
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) maxThreads = atoi(argv[++i]);
+    if (maxThreads < 1) maxThreads = 1;
+    if (maxThreads > MAX_THREADS) maxThreads = MAX_THREADS;
+
+    int threadCounts[16], numCounts = 0;
+    for (int t = 1; t < maxThreads && numCounts < 15; t *= 2)
+        threadCounts[numCounts++] = t;
+    threadCounts[numCounts++] = maxThreads;
+
+    pool = poolCreate(BUF_SIZE, 0);
+    if (!pool) return 1;
+
+    printf("\nlibbranchless %d, %zu-byte buffers, %d alloc/free pairs per thread, best of %d\n",
+           branchlessVersion(), BUF_SIZE, OPS_PER_THREAD, TRIALS);
+    int failed = print_table(1, 0, threadCounts, numCounts);
+    failed |= print_table(256, 0, threadCounts, numCounts);
+    failed |= print_table(256, 1, threadCounts, numCounts);
+
+    struct PoolStats st;
+    poolStats(pool, &st);
+    printf("\nBufPool: %llu slabs, %.1f KB held at the end\n\n",
+           (unsigned long long)st.slabs, st.bytesHeld / 1024.0);
+    poolDestroy(pool);
+    return failed;
+}
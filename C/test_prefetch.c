@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "branchless.h"
+#include "tsc.h"
+
+// Software prefetch for the `for i: func(list[i])` loop of
+// test_without_inline. Once the corpus is larger than the last-level
+// cache every string's first line is a miss the loop waits for; the
+// batch driver below asks for list[i + d] while list[i] is processed,
+// and optionally for the pointer array itself further ahead.
+//
+// Two corpus layouts:
+//   arena      one block, strings back to back in list order; the
+//              hardware prefetcher already follows it;
+//   scattered  one malloc per string, visited in a shuffled order, so
+//              consecutive strings are unrelated addresses, as in a
+//              long-lived heap.
+//
+// Strings are short by default (--len), where the first-line miss is
+// most of the cost of a call.
+
+const int TRIALS = 3;
+static const int distances[] = {0, 1, 2, 4, 8, 16, 32, 64, 128};
+#define NUM_DISTANCES ((int)(sizeof(distances) / sizeof(distances[0])))
+
+// === Random string generation ===
+void randStr(char *s, int len) {
+    for (int i = 0; i < len; i++) {
+        s[i] = (rand() % 2 == 0)
+            ? ('A' + rand() % 26)
+            : ('a' + rand() % 26);
+    }
+    s[len] = '\0';
+}
+
+// === Layouts ===
+struct Layout {
+    const char *name;
+    char **list;
+    char *arena;            // NULL for the scattered layout
+    int count;
+};
+
+int makeArena(struct Layout *layout, int count, int len) {
+    layout->name = "arena";
+    layout->count = count;
+    layout->list = malloc(count * sizeof(char *));
+    layout->arena = malloc((size_t)count * (len + 1));
+    if (!layout->list || !layout->arena) {
+        // Left empty, so freeLayout does not mistake it for a scattered one.
+        free(layout->list);
+        free(layout->arena);
+        layout->list = NULL;
+        layout->arena = NULL;
+        layout->count = 0;
+        return 0;
+    }
+    for (int i = 0; i < count; ++i) {
+        layout->list[i] = layout->arena + (size_t)i * (len + 1);
+        randStr(layout->list[i], len);
+    }
+    return 1;
+}
+
+int makeScattered(struct Layout *layout, int count, int len) {
+    layout->name = "scattered";
+    layout->count = count;
+    layout->arena = NULL;
+    layout->list = malloc(count * sizeof(char *));
+    if (!layout->list) return 0;
+    for (int i = 0; i < count; ++i) {
+        layout->list[i] = malloc(len + 1);
+        if (!layout->list[i]) {
+            layout->count = i;
+            return 0;
+        }
+        randStr(layout->list[i], len);
+    }
+    for (int i = count - 1; i > 0; --i) {
+        int j = (int)(((unsigned long long)rand() * RAND_MAX + rand()) % (unsigned)(i + 1));
+        char *tmp = layout->list[i];
+        layout->list[i] = layout->list[j];
+        layout->list[j] = tmp;
+    }
+    return 1;
+}
+
+void freeLayout(struct Layout *layout) {
+    if (layout->arena) free(layout->arena);
+    else if (layout->list)
+        for (int i = 0; i < layout->count; ++i) free(layout->list[i]);
+    free(layout->list);
+}
+
+// === Batch driver ===
+// d == 0 is the plain loop. With prefetchList, the pointer array is
+// requested twice as far ahead as the strings, so list[i + d] is cached
+// by the time its string is prefetched.
+typedef void (*test_func_t)(char *);
+
+static void runBatch(test_func_t func, char **list, int count, int d, int prefetchList) {
+    int i = 0;
+    if (d > 0) {
+        for (; i + 2 * d < count; ++i) {
+            if (prefetchList) __builtin_prefetch(&list[i + 2 * d], 0, 3);
+            __builtin_prefetch(list[i + d], 1, 3);
+            func(list[i]);
+        }
+        for (; i + d < count; ++i) {
+            __builtin_prefetch(list[i + d], 1, 3);
+            func(list[i]);
+        }
+    }
+    for (; i < count; ++i)
+        func(list[i]);
+}
+
+static long long timeBatch(test_func_t func, struct Layout *layout, int d, int prefetchList) {
+    long long best = -1;
+    for (int t = 0; t < TRIALS; ++t) {
+        long long start = nowNs();
+        runBatch(func, layout->list, layout->count, d, prefetchList);
+        long long end = nowNs();
+        if (best < 0 || end - start < best) best = end - start;
+    }
+    return best;
+}
+
+// === Utility structures ===
+struct TestCase {
+    const char *name;
+    test_func_t func;
+};
+
+// === Sweep ===
+// Every distance with and without the pointer-array prefetch; the best
+// (d, list) pair is the tuned setting for that layout and kernel.
+void sweep(struct TestCase *test, struct Layout *layout) {
+    long long ns[NUM_DISTANCES][2];
+    int bestD = 0, bestP = 0;
+    for (int k = 0; k < NUM_DISTANCES; ++k)
+        for (int p = 0; p < 2; ++p) {
+            ns[k][p] = (k == 0 && p == 1) ? ns[0][0] : timeBatch(test->func, layout, distances[k], p);
+            if (ns[k][p] < ns[bestD][bestP]) {
+                bestD = k;
+                bestP = p;
+            }
+        }
+
+    printf("\n=== %s, %s ===\n", test->name, layout->name);
+    printf("%-10s %-15s %-15s %-15s %-15s\n", "Distance", "ns/string", "Speedup", "+list ns/str", "Speedup");
+    printf("------------------------------------------------------------------------\n");
+    double base = (double)ns[0][0];
+    for (int k = 0; k < NUM_DISTANCES; ++k) {
+        printf("%-10d %-15.2f x%-14.3f %-15.2f x%-14.3f%s\n",
+               distances[k],
+               (double)ns[k][0] / layout->count, base / ns[k][0],
+               (double)ns[k][1] / layout->count, base / ns[k][1],
+               k == bestD ? (bestP ? "  <- best (+list)" : "  <- best") : "");
+    }
+    printf("Tuned: d = %d%s, x%.3f over the plain loop\n",
+           distances[bestD], bestP ? " with list prefetch" : "", base / ns[bestD][bestP]);
+}
+
+// === main ===
+// Usage: test_prefetch [--len L] [count]
+//   count     strings per corpus (default 4000000, well past the LLC)
+//   --len L   letters per string (default 32)
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    srand((unsigned)time(NULL));
+
+    int count = 4000000, len = 32;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--len") == 0 && i + 1 < argc) len = atoi(argv[++i]);
+        else if (atoi(argv[i]) > 0) count = atoi(argv[i]);
+    }
+    if (len < 1) len = 1;
+
+    struct TestCase tests[] = {
+        {"Branchless 1", branchlessUpperCase1},
+        {"Branchless 2", branchlessUpperCase2}
+    };
+    int num_tests = sizeof(tests) / sizeof(tests[0]);
+
+    printf("\nlibbranchless %d, prefetch distance sweep, %d strings of %d letters\n",
+           branchlessVersion(), count, len);
+    for (int l = 0; l < 2; ++l) {
+        struct Layout layout = {0, 0, 0, 0};
+        int ok = l == 0 ? makeArena(&layout, count, len) : makeScattered(&layout, count, len);
+        if (!ok) {
+            printf("\n%s: out of memory\n", l == 0 ? "arena" : "scattered");
+            freeLayout(&layout);
+            continue;
+        }
+        for (int i = 0; i < num_tests; ++i)
+            sweep(&tests[i], &layout);
+        freeLayout(&layout);
+    }
+    printf("\n");
+    return 0;
+}
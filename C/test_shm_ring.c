@@ -0,0 +1,396 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "branchless.h"
+#include "histogram.h"
+#include "service.h"
+#include "shmring.h"
+#include "tsc.h"
+
+// Three ways for a process to get strings uppercased:
+//
+//   in-process  copy the string into a buffer and call upperCase;
+//   socket      the bench/service.h daemon (batch limit 256): the
+//               request is copied into the socket and out of it, the
+//               reply likewise;
+//   ring        a bench/shmring.h ring shared with a worker process:
+//               the producer writes the string into a slot, the worker
+//               uppercases it in place, the producer reads it there.
+//
+// Both out-of-process transports are driven the same way: 1, 2, 4 .. N
+// producer threads, each keeping `depth` requests in flight and timing
+// every one from submit to result. The ring runs once as SPSC (one
+// producer only) and once as MPSC. Every 16th result is checked.
+
+#define MAX_PRODUCERS 64
+#define MAX_DEPTH 1024
+#define STRINGS 256          // distinct payloads per producer
+#define SERVICE_BATCH 256
+
+enum { T_SOCKET, T_RING_SPSC, T_RING_MPSC, NUM_TRANSPORTS };
+static const char *transportNames[NUM_TRANSPORTS] = {"socket", "ring SPSC", "ring MPSC"};
+
+// === Random string generation ===
+static void randStr(char *s, int len, uint64_t *state) {
+    for (int i = 0; i < len; i++) {
+        *state ^= *state << 13;
+        *state ^= *state >> 7;
+        *state ^= *state << 17;
+        s[i] = (char)((*state & 1 ? 'A' : 'a') + (*state >> 1) % 26);
+    }
+}
+
+static char *makeStrings(int len, int seed) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL * (uint64_t)(seed + 1);
+    char *strings = malloc((size_t)STRINGS * len);
+    if (strings)
+        for (int i = 0; i < STRINGS; ++i) randStr(strings + (size_t)i * len, len, &state);
+    return strings;
+}
+
+static int checkResult(const char *input, const char *result, int len) {
+    char expect[4096];
+    int n = len < (int)sizeof(expect) ? len : (int)sizeof(expect);
+    memcpy(expect, input, n);
+    upperCase(expect, n);
+    return memcmp(expect, result, n) == 0;
+}
+
+// === In-process reference ===
+static volatile unsigned sink;
+
+static void runInProcess(int requests, int len, struct Histogram *latency, long long *ns) {
+    char *strings = makeStrings(len, 0);
+    char *buf = malloc(len);
+    histInit(latency);
+    if (!strings || !buf) {
+        free(strings);
+        free(buf);
+        *ns = 0;
+        return;
+    }
+    long long start = nowNs();
+    for (int i = 0; i < requests; ++i) {
+        long long t0 = nowNs();
+        memcpy(buf, strings + (size_t)(i % STRINGS) * len, len);
+        upperCase(buf, len);
+        sink = (unsigned char)buf[0];
+        histRecord(latency, (uint64_t)(nowNs() - t0));
+    }
+    *ns = nowNs() - start;
+    free(strings);
+    free(buf);
+}
+
+#ifndef _WIN32
+
+// === Producers ===
+struct Load {
+    int transport, depth, requests, len;
+    const char *path;
+    struct ShmRing *ring;
+    pthread_barrier_t start;
+};
+
+struct Producer {
+    struct Load *load;
+    int index;
+    struct Histogram latency;
+    int errors, mismatches;
+};
+
+static void socketProducer(struct Producer *p, const char *strings) {
+    struct Load *load = p->load;
+    int len = load->len, depth = load->depth;
+    long long sentAt[MAX_DEPTH];
+    char *reply = malloc(len);
+    int fd = svcConnect(load->path);
+    pthread_barrier_wait(&load->start);
+    if (fd < 0 || !reply) {
+        p->errors++;
+        goto out;
+    }
+    uint32_t sent = 0, received = 0, total = (uint32_t)load->requests;
+    while (received < total) {
+        while (sent < total && sent - received < (uint32_t)depth) {
+            sentAt[sent % depth] = nowNs();
+            if (svcSend(fd, sent, SVC_UPPER, strings + (size_t)(sent % STRINGS) * len, len) != 0) {
+                p->errors++;
+                goto out;
+            }
+            ++sent;
+        }
+        struct SvcHeader h;
+        if (svcRecv(fd, &h, reply, len) != 0 || h.id != received || h.len != (uint32_t)len) {
+            p->errors++;
+            goto out;
+        }
+        histRecord(&p->latency, (uint64_t)(nowNs() - sentAt[received % depth]));
+        if (received % 16 == 0)
+            p->mismatches += !checkResult(strings + (size_t)(received % STRINGS) * len, reply, len);
+        ++received;
+    }
+out:
+    if (fd >= 0) close(fd);
+    free(reply);
+}
+
+static void ringProducer(struct Producer *p, const char *strings) {
+    struct Load *load = p->load;
+    struct ShmRing *r = load->ring;
+    int len = load->len, depth = load->depth;
+    long long sentAt[MAX_DEPTH];
+    uint32_t tickets[MAX_DEPTH];
+    pthread_barrier_wait(&load->start);
+    int sent = 0, received = 0, total = load->requests;
+    while (received < total) {
+        while (sent < total && sent - received < depth) {
+            int k = sent % depth;
+            sentAt[k] = nowNs();
+            tickets[k] = ringClaim(r);
+            memcpy(ringData(r, tickets[k]), strings + (size_t)(sent % STRINGS) * len, len);
+            if (ringSubmit(r, tickets[k], (uint32_t)len) != 0) {
+                p->errors++;
+                ringSubmit(r, tickets[k], 0);
+            }
+            ++sent;
+        }
+        int k = received % depth;
+        if (ringWait(r, tickets[k]) != (uint32_t)len) p->errors++;
+        histRecord(&p->latency, (uint64_t)(nowNs() - sentAt[k]));
+        if (received % 16 == 0)
+            p->mismatches += !checkResult(strings + (size_t)(received % STRINGS) * len,
+                                          ringData(r, tickets[k]), len);
+        ringRelease(r, tickets[k]);
+        ++received;
+    }
+}
+
+static void *producer(void *arg) {
+    struct Producer *p = arg;
+    char *strings = makeStrings(p->load->len, p->index);
+    histInit(&p->latency);
+    if (!strings) {
+        p->errors++;
+        pthread_barrier_wait(&p->load->start);
+        return NULL;
+    }
+    if (p->load->transport == T_SOCKET) socketProducer(p, strings);
+    else ringProducer(p, strings);
+    free(strings);
+    return NULL;
+}
+
+struct Row {
+    long long ns;
+    struct Histogram latency;
+    int errors, mismatches;
+};
+
+static void runLoad(struct Load *load, int producers, struct Row *row) {
+    static struct Producer ps[MAX_PRODUCERS];
+    pthread_t tids[MAX_PRODUCERS];
+    memset(row, 0, sizeof(*row));
+    histInit(&row->latency);
+    pthread_barrier_init(&load->start, NULL, (unsigned)producers + 1);
+    for (int i = 0; i < producers; ++i) {
+        memset(&ps[i], 0, sizeof(ps[i]));
+        ps[i].load = load;
+        ps[i].index = i;
+        pthread_create(&tids[i], NULL, producer, &ps[i]);
+    }
+    pthread_barrier_wait(&load->start);
+    long long start = nowNs();
+    for (int i = 0; i < producers; ++i) pthread_join(tids[i], NULL);
+    row->ns = nowNs() - start;
+    pthread_barrier_destroy(&load->start);
+    for (int i = 0; i < producers; ++i) {
+        histMerge(&row->latency, &ps[i].latency);
+        row->errors += ps[i].errors;
+        row->mismatches += ps[i].mismatches;
+    }
+}
+
+// === Worker processes ===
+static volatile sig_atomic_t stopServer;
+
+static void onStop(int sig) {
+    (void)sig;
+    stopServer = 1;
+}
+
+static pid_t forkService(const char *path) {
+    int fd = svcListen(path);
+    if (fd < 0) return -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = onStop;
+        sigaction(SIGTERM, &sa, NULL);
+        _exit(svcServe(fd, SERVICE_BATCH, &stopServer) == 0 ? 0 : 1);
+    }
+    close(fd);
+    return pid;
+}
+
+// The child inherits the shared mapping; no need to pass the memfd.
+static pid_t forkRingWorker(struct ShmRing *r) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        ringServe(r, upperCase);
+        _exit(0);
+    }
+    return pid;
+}
+
+#endif // !_WIN32
+
+// === Results printing ===
+void print_header(void) {
+    printf("%-12s %-10s %-12s %-10s %-10s %-10s %-10s %s\n",
+           "Transport", "Producers", "Mmsg/s", "MB/s", "p50 (us)", "p99 (us)", "vs in-proc", "Notes");
+    printf("----------------------------------------------------------------------------------------------\n");
+}
+
+void print_row(const char *name, int producers, long long ns, const struct Histogram *latency,
+               int len, double inProcRate, const char *notes) {
+    double secs = (double)(ns > 0 ? ns : 1) / 1e9;
+    double msgs = (double)latency->total;
+    printf("%-12s %-10d %-12.3f %-10.1f %-10.2f %-10.2f x%-9.4f %s\n",
+           name, producers,
+           msgs / secs / 1e6,
+           msgs * len / secs / 1048576.0,
+           histPercentile(latency, 50.0) / 1e3,
+           histPercentile(latency, 99.0) / 1e3,
+           msgs / secs / (inProcRate > 0 ? inProcRate : 1),
+           notes);
+}
+
+// === main ===
+// Usage: test_shm_ring [--producers N] [--depth D] [--requests R] [--len L]
+//   --producers N  largest producer count; rows are 1, 2, 4, ... and N
+//                  (default 4)
+//   --depth D      requests in flight per producer (default 16)
+//   --requests R   requests per producer per row (default 50000)
+//   --len L        bytes per string (default 64)
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+    (void)argc;
+    (void)argv;
+    printf("test_shm_ring needs fork(), memfd and futexes\n");
+    return 0;
+#else
+    int maxProducers = 4, depth = 16, requests = 50000, len = 64;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--producers") == 0 && i + 1 < argc) maxProducers = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) depth = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--requests") == 0 && i + 1 < argc) requests = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--len") == 0 && i + 1 < argc) len = atoi(argv[++i]);
+    }
+    if (maxProducers < 1) maxProducers = 1;
+    if (maxProducers > MAX_PRODUCERS) maxProducers = MAX_PRODUCERS;
+    if (depth < 1) depth = 1;
+    if (depth > MAX_DEPTH) depth = MAX_DEPTH;
+    if (requests < 1) requests = 1;
+    if (len < 1) len = 1;
+    if (len > (int)SVC_MAX_PAYLOAD) len = (int)SVC_MAX_PAYLOAD;
+
+    int counts[16], numCounts = 0;
+    for (int c = 1; c < maxProducers && numCounts < 15; c *= 2)
+        counts[numCounts++] = c;
+    counts[numCounts++] = maxProducers;
+
+    printf("\nlibbranchless %d, uppercase transports, %d-byte strings, %d in flight per producer, %d requests per producer\n\n",
+           branchlessVersion(), len, depth, requests);
+    print_header();
+
+    struct Histogram inProc;
+    long long inProcNs;
+    runInProcess(requests * 4, len, &inProc, &inProcNs);
+    double inProcRate = (double)inProc.total / ((double)(inProcNs > 0 ? inProcNs : 1) / 1e9);
+    print_row("in-process", 1, inProcNs, &inProc, len, inProcRate, "memcpy + upperCase, timer per call");
+
+    char path[108];
+    snprintf(path, sizeof(path), "/tmp/branchless-ring-%d.sock", (int)getpid());
+    int ok = 1;
+    struct Load load;
+    memset(&load, 0, sizeof(load));
+    load.path = path;
+    load.depth = depth;
+    load.requests = requests;
+    load.len = len;
+
+    for (int t = 0; t < NUM_TRANSPORTS; ++t) {
+        pid_t pid;
+        struct ShmRing *ring = NULL;
+        load.transport = t;
+        if (t == T_SOCKET) {
+            pid = forkService(path);
+        } else {
+            // Room for every ticket the producers can hold at once.
+            uint32_t slots = (uint32_t)(maxProducers * depth) + 1;
+            ring = ringCreate(slots < 1024 ? 1024 : slots, (uint32_t)len,
+                              t == T_RING_SPSC ? RING_SPSC : RING_MPSC, NULL);
+            if (!ring) {
+                perror("ringCreate");
+                return 1;
+            }
+            load.ring = ring;
+            pid = forkRingWorker(ring);
+        }
+        if (pid < 0) {
+            perror(transportNames[t]);
+            return 1;
+        }
+
+        for (int c = 0; c < numCounts; ++c) {
+            if (t == T_RING_SPSC && counts[c] > 1) break;
+            struct RingStats before, after;
+            if (ring) ringStats(ring, &before);
+            struct Row row;
+            runLoad(&load, counts[c], &row);
+            char notes[64] = "";
+            if (ring) {
+                ringStats(ring, &after);
+                uint64_t msgs = after.processed - before.processed;
+                snprintf(notes, sizeof(notes), "%.1f msgs/sweep, %.3f sleeps/msg",
+                         (double)msgs / (double)(after.sweeps - before.sweeps ? after.sweeps - before.sweeps : 1),
+                         (double)(after.workerSleeps + after.producerSleeps - before.workerSleeps - before.producerSleeps) /
+                             (double)(msgs ? msgs : 1));
+            }
+            if (row.errors) snprintf(notes, sizeof(notes), "%d errors", row.errors);
+            print_row(transportNames[t], counts[c], row.ns, &row.latency, len, inProcRate, notes);
+            ok &= row.errors == 0 && row.mismatches == 0;
+        }
+
+        if (ring) {
+            ringStop(ring);
+            waitpid(pid, NULL, 0);
+            ringUnmap(ring);
+        } else {
+            kill(pid, SIGTERM);
+            waitpid(pid, NULL, 0);
+            unlink(path);
+        }
+    }
+    printf("\nResults verified: %s\n\n", ok ? "YES" : "NO");
+    return ok ? 0 : 1;
+#endif
+}
@@ -0,0 +1,390 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "branchless.h"
+#include "histogram.h"
+#include "service.h"
+#include "tsc.h"
+
+// The case-mapping service (bench/service.h) under load. For every batch
+// limit a fresh server is forked onto a Unix domain socket; then 1, 2,
+// 4 .. N client threads, each on its own connection, keep `depth`
+// requests in flight (upper, lower and fold in turn) and time every one
+// from its send to its reply. Rows report the request rate, the p50 and
+// p99 latency and the batch size the server actually reached, which is
+// bounded by the limit and by how many requests arrive in one epoll
+// round.
+//
+// Every 16th reply is checked against the kernel run locally, and after
+// the rows non-ASCII fold requests check that requests sharing a batch
+// do not change each other's bytes. The
+// in-process line is the same work with no socket: copy the payload,
+// call the kernel.
+//
+// With --serve the binary is just the daemon, for use by other programs.
+
+#define MAX_CLIENTS 64
+#define MAX_DEPTH 1024
+#define STRINGS 256          // distinct payloads per client
+
+static const int batchLimits[] = {1, 16, 256};
+#define NUM_LIMITS ((int)(sizeof(batchLimits) / sizeof(batchLimits[0])))
+
+static const upper_func_t localKernels[SVC_OPS] = {
+    NULL, upperCase, lowerCase, utf8UpperCase
+};
+
+// === Random string generation ===
+static void randStr(char *s, int len, uint64_t *state) {
+    for (int i = 0; i < len; i++) {
+        *state ^= *state << 13;
+        *state ^= *state >> 7;
+        *state ^= *state << 17;
+        s[i] = (char)((*state & 1 ? 'A' : 'a') + (*state >> 1) % 26);
+    }
+}
+
+#ifndef _WIN32
+
+// === Load generator ===
+struct Load {
+    const char *path;
+    int clients, depth, requests, len;
+    pthread_barrier_t start;
+};
+
+struct Client {
+    struct Load *load;
+    int index;
+    struct Histogram latency;
+    int errors, mismatches;
+};
+
+static int opOf(uint32_t id) {
+    return 1 + (int)(id % 3);
+}
+
+static void *client(void *arg) {
+    struct Client *cl = arg;
+    struct Load *load = cl->load;
+    int len = load->len, depth = load->depth;
+    uint64_t state = 0x9E3779B97F4A7C15ULL * (uint64_t)(cl->index + 1);
+    char *strings = malloc((size_t)STRINGS * len);
+    char *reply = malloc(len);
+    char *expect = malloc(len);
+    long long sentAt[MAX_DEPTH];
+    histInit(&cl->latency);
+    int fd = svcConnect(load->path);
+    pthread_barrier_wait(&load->start);
+    if (fd < 0 || !strings || !reply || !expect) {
+        cl->errors++;
+        goto out;
+    }
+    for (int i = 0; i < STRINGS; ++i) randStr(strings + (size_t)i * len, len, &state);
+
+    uint32_t sent = 0, received = 0, total = (uint32_t)load->requests;
+    while (received < total) {
+        while (sent < total && sent - received < (uint32_t)depth) {
+            sentAt[sent % depth] = nowNs();
+            if (svcSend(fd, sent, opOf(sent), strings + (size_t)(sent % STRINGS) * len, len) != 0) {
+                cl->errors++;
+                goto out;
+            }
+            ++sent;
+        }
+        struct SvcHeader h;
+        if (svcRecv(fd, &h, reply, len) != 0 || h.id != received || h.status != SVC_OK ||
+            h.len != (uint32_t)len) {
+            cl->errors++;
+            goto out;
+        }
+        histRecord(&cl->latency, (uint64_t)(nowNs() - sentAt[received % depth]));
+        if (received % 16 == 0) {
+            memcpy(expect, strings + (size_t)(received % STRINGS) * len, len);
+            localKernels[opOf(received)](expect, len);
+            cl->mismatches += memcmp(expect, reply, len) != 0;
+        }
+        ++received;
+    }
+
+out:
+    if (fd >= 0) close(fd);
+    free(strings);
+    free(reply);
+    free(expect);
+    return NULL;
+}
+
+static int fetchStats(const char *path, struct SvcStats *out) {
+    struct SvcHeader h;
+    int fd = svcConnect(path);
+    int ok = fd >= 0 && svcSend(fd, 0, SVC_STATS, NULL, 0) == 0 &&
+             svcRecv(fd, &h, (char *)out, sizeof(*out)) == 0 && h.len == sizeof(*out);
+    if (fd >= 0) close(fd);
+    return ok;
+}
+
+// Fold requests pipelined on one connection so they share batches:
+// payloads ending in a truncated UTF-8 sequence, followed by payloads
+// that start with its continuation bytes. Each reply must be what
+// utf8UpperCase makes of that payload alone.
+static int checkSplitSequences(const char *path) {
+    static const char *const payloads[] = {
+        "ab\xC3", "\xA9" "cd", "\xC3\xA9\xC4\xB1", "x\xCF", "\x82\xD1\x8F",
+        "\xCE", "\xB1\xCE\xB1", "\xC5\xBF\xC3\xBF", "\xD0", "\xB0" "z"
+    };
+    const int n = (int)(sizeof(payloads) / sizeof(payloads[0]));
+    char reply[16], expect[16];
+    int fd = svcConnect(path);
+    int ok = fd >= 0;
+    for (int round = 0; ok && round < 16; ++round) {
+        for (int i = 0; ok && i < n; ++i)
+            ok = svcSend(fd, (uint32_t)i, SVC_FOLD, payloads[i], (uint32_t)strlen(payloads[i])) == 0;
+        for (int i = 0; ok && i < n; ++i) {
+            struct SvcHeader h;
+            size_t len = strlen(payloads[i]);
+            memcpy(expect, payloads[i], len);
+            utf8UpperCase(expect, len);
+            ok = svcRecv(fd, &h, reply, sizeof(reply)) == 0 && h.id == (uint32_t)i &&
+                 h.status == SVC_OK && h.len == len && memcmp(reply, expect, len) == 0;
+        }
+    }
+    if (fd >= 0) close(fd);
+    return ok;
+}
+
+// One row: all clients against the running server.
+struct Row {
+    long long ns;
+    struct Histogram latency;
+    struct SvcStats stats;
+    int errors, mismatches;
+};
+
+static void runLoad(struct Load *load, struct Row *row) {
+    static struct Client clients[MAX_CLIENTS];
+    pthread_t tids[MAX_CLIENTS];
+    struct SvcStats before, after;
+    memset(row, 0, sizeof(*row));
+    histInit(&row->latency);
+    if (!fetchStats(load->path, &before)) {
+        row->errors = 1;
+        return;
+    }
+    pthread_barrier_init(&load->start, NULL, (unsigned)load->clients + 1);
+    for (int i = 0; i < load->clients; ++i) {
+        memset(&clients[i], 0, sizeof(clients[i]));
+        clients[i].load = load;
+        clients[i].index = i;
+        pthread_create(&tids[i], NULL, client, &clients[i]);
+    }
+    pthread_barrier_wait(&load->start);
+    long long start = nowNs();
+    for (int i = 0; i < load->clients; ++i) pthread_join(tids[i], NULL);
+    row->ns = nowNs() - start;
+    pthread_barrier_destroy(&load->start);
+
+    for (int i = 0; i < load->clients; ++i) {
+        histMerge(&row->latency, &clients[i].latency);
+        row->errors += clients[i].errors;
+        row->mismatches += clients[i].mismatches;
+    }
+    if (!fetchStats(load->path, &after)) {
+        row->errors++;
+        return;
+    }
+    row->stats.requests = after.requests - before.requests - 1;   // minus our stats call
+    row->stats.batches = after.batches - before.batches - 1;
+    row->stats.passes = after.passes - before.passes;
+    row->stats.queued = after.queued - before.queued;
+}
+
+// === In-process reference ===
+static volatile unsigned sink;
+
+static double inProcessRate(int requests, int len) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    char *strings = malloc((size_t)STRINGS * len);
+    char *buf = malloc(len);
+    if (!strings || !buf) return 0.0;
+    for (int i = 0; i < STRINGS; ++i) randStr(strings + (size_t)i * len, len, &state);
+    long long start = nowNs();
+    for (int i = 0; i < requests; ++i) {
+        memcpy(buf, strings + (size_t)(i % STRINGS) * len, len);
+        localKernels[opOf((uint32_t)i)](buf, len);
+        sink = (unsigned char)buf[0];
+    }
+    long long ns = nowNs() - start;
+    free(strings);
+    free(buf);
+    return (double)requests / (double)(ns > 0 ? ns : 1) * 1e9;
+}
+
+// === Server process ===
+static volatile sig_atomic_t stopServer;
+
+static void onStop(int sig) {
+    (void)sig;
+    stopServer = 1;
+}
+
+static void catchStop(void) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onStop;
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+}
+
+static pid_t forkServer(const char *path, int maxBatch) {
+    int fd = svcListen(path);
+    if (fd < 0) return -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        catchStop();
+        _exit(svcServe(fd, maxBatch, &stopServer) == 0 ? 0 : 1);
+    }
+    close(fd);
+    return pid;
+}
+
+static void stopChild(pid_t pid) {
+    int status;
+    kill(pid, SIGTERM);
+    waitpid(pid, &status, 0);
+}
+
+#endif // !_WIN32
+
+// === Results printing ===
+#ifndef _WIN32
+void print_row(int clients, const struct Row *row, int len) {
+    if (row->errors) {
+        printf("%-8d (%d client errors)\n", clients, row->errors);
+        return;
+    }
+    double secs = (double)row->ns / 1e9;
+    double reqs = (double)row->latency.total;
+    printf("%-8d %-12.1f %-10.1f %-10.1f %-10.1f %-10.1f %-10.2f\n",
+           clients,
+           reqs / secs / 1e3,
+           reqs * len / secs / 1048576.0,
+           histPercentile(&row->latency, 50.0) / 1e3,
+           histPercentile(&row->latency, 99.0) / 1e3,
+           (double)row->stats.requests / (double)(row->stats.batches ? row->stats.batches : 1),
+           100.0 * (double)row->stats.queued / (double)(row->stats.requests ? row->stats.requests : 1));
+}
+#endif
+
+// === main ===
+// Usage: test_socket_service [--clients N] [--depth D] [--requests R]
+//                            [--len L] [--socket PATH]
+//        test_socket_service --serve PATH [--batch B]
+//   --clients N    largest client count; rows are 1, 2, 4, ... and N
+//                  (default 8)
+//   --depth D      requests in flight per client (default 16)
+//   --requests R   requests per client per row (default 20000)
+//   --len L        payload bytes per request (default 64)
+//   --socket PATH  socket for the forked servers (default under /tmp)
+//   --serve PATH   run only the daemon on PATH until SIGINT/SIGTERM,
+//                  batching up to B requests (default 256)
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+    (void)argc;
+    (void)argv;
+    printf("test_socket_service needs Unix domain sockets and fork()\n");
+    return 0;
+#else
+    int maxClients = 8, depth = 16, requests = 20000, len = 64, serveBatch = 256;
+    const char *servePath = NULL;
+    char path[108];
+    snprintf(path, sizeof(path), "/tmp/branchless-svc-%d.sock", (int)getpid());
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--clients") == 0 && i + 1 < argc) maxClients = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) depth = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--requests") == 0 && i + 1 < argc) requests = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--len") == 0 && i + 1 < argc) len = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) snprintf(path, sizeof(path), "%s", argv[++i]);
+        else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) servePath = argv[++i];
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) serveBatch = atoi(argv[++i]);
+    }
+    if (maxClients < 1) maxClients = 1;
+    if (maxClients > MAX_CLIENTS) maxClients = MAX_CLIENTS;
+    if (depth < 1) depth = 1;
+    if (depth > MAX_DEPTH) depth = MAX_DEPTH;
+    if (requests < 1) requests = 1;
+    if (len < 1) len = 1;
+
+    if (servePath) {
+        int fd = svcListen(servePath);
+        if (fd < 0) {
+            perror(servePath);
+            return 1;
+        }
+        catchStop();
+        printf("serving on %s, batches of up to %d\n", servePath, serveBatch);
+        int rc = svcServe(fd, serveBatch, &stopServer);
+        close(fd);
+        unlink(servePath);
+        return rc == 0 ? 0 : 1;
+    }
+
+    int clientCounts[16], numCounts = 0;
+    for (int c = 1; c < maxClients && numCounts < 15; c *= 2)
+        clientCounts[numCounts++] = c;
+    clientCounts[numCounts++] = maxClients;
+
+    printf("\nlibbranchless %d, Unix socket service, %d-byte payloads, %d in flight per client, %d requests per client\n",
+           branchlessVersion(), len, depth, requests);
+    printf("In-process (memcpy + kernel): %.1f kreq/s\n", inProcessRate(requests * 10, len) / 1e3);
+
+    int ok = 1;
+    struct Load load;
+    memset(&load, 0, sizeof(load));
+    load.path = path;
+    load.depth = depth;
+    load.requests = requests;
+    load.len = len;
+    for (int b = 0; b < NUM_LIMITS; ++b) {
+        pid_t pid = forkServer(path, batchLimits[b]);
+        if (pid < 0) {
+            perror(path);
+            return 1;
+        }
+        printf("\n=== batch limit %d ===\n", batchLimits[b]);
+        printf("%-8s %-12s %-10s %-10s %-10s %-10s %-10s\n",
+               "Clients", "kreq/s", "MB/s", "p50 (us)", "p99 (us)", "Avg batch", "Queued %");
+        printf("------------------------------------------------------------------------------\n");
+        for (int c = 0; c < numCounts; ++c) {
+            struct Row row;
+            load.clients = clientCounts[c];
+            runLoad(&load, &row);
+            print_row(clientCounts[c], &row, len);
+            ok &= row.errors == 0 && row.mismatches == 0;
+        }
+        int split = checkSplitSequences(path);
+        printf("Split UTF-8 sequences across requests: %s\n", split ? "OK" : "MISMATCH");
+        ok &= split;
+        stopChild(pid);
+    }
+    unlink(path);
+    printf("\nReplies verified: %s\n\n", ok ? "YES" : "NO");
+    return ok ? 0 : 1;
+#endif
+}
@@ -0,0 +1,300 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "branchless.h"
+#include "tsc.h"
+
+// Corpus layouts: the char ** list the other benchmarks build with
+// makeList (one malloc per string, a pointer load before every string)
+// against a StrTable (one offset array, one blob). Strings are short,
+// 8..23 letters, which is where the per-string overhead matters and what
+// lets 100M of them fit in memory at all.
+//
+// The two layouts are never alive at the same time: each is built from
+// the same seeded generator, measured, hashed and freed, and the hashes
+// of the uppercased corpora must match.
+
+const int TRIALS = 3;
+const int MIN_LEN = 8, MAX_LEN = 23;
+
+// === Memory ===
+// Resident set size in bytes, 0 when unknown.
+static size_t rssBytes(void) {
+#ifdef __linux__
+    long pages = 0, resident = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    fclose(f);
+    return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+static size_t rssGrowth(size_t before) {
+    size_t now = rssBytes();
+    return now > before ? now - before : 0;
+}
+
+// Bytes the allocator really hands out for malloc(n): glibc reports the
+// usable size, plus 8 bytes of chunk header. Elsewhere assume the same
+// 16-byte granularity and 32-byte minimum.
+static size_t mallocCost(void *p, size_t n) {
+#ifdef __GLIBC__
+    (void)n;
+    return malloc_usable_size(p) + 8;
+#else
+    (void)p;
+    size_t chunk = (n + 8 + 15) & ~(size_t)15;
+    return chunk < 32 ? 32 : chunk;
+#endif
+}
+
+// === Random string generation ===
+// xorshift64, so both layouts see the same strings without storing them.
+static uint64_t rngState;
+
+static uint64_t nextRand(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+static size_t randStr(char *s) {
+    size_t len = MIN_LEN + nextRand() % (MAX_LEN - MIN_LEN + 1);
+    for (size_t i = 0; i < len; i++) {
+        uint64_t r = nextRand();
+        s[i] = (char)((r & 1 ? 'A' : 'a') + (r >> 1) % 26);
+    }
+    s[len] = '\0';
+    return len;
+}
+
+// Order-dependent hash of the whole corpus.
+static uint64_t mixHash(uint64_t h, const char *s, size_t len) {
+    return h * 0x100000001B3ULL ^ ascii_hash(s, len, 0);
+}
+
+// === Utility structures ===
+struct Layout {
+    const char *name;
+    size_t heap;             // bytes allocated, allocator overhead included
+    size_t footprint;        // RSS growth while building
+    size_t payload;          // bytes of text including NULs
+    long long buildNs;
+    uint64_t hash;
+    int failed;
+};
+
+struct TestCase {
+    const char *name;
+    long long cycles;
+};
+
+// === char ** ===
+void runList(size_t count, uint64_t seed, struct Layout *layout, struct TestCase *tests) {
+    char buf[64];
+    rngState = seed;
+    size_t rss0 = rssBytes();
+    long long start = nowNs();
+    char **list = malloc(count * sizeof(char *));
+    size_t i = 0;
+    if (list) {
+        layout->heap = mallocCost(list, count * sizeof(char *));
+        for (; i < count; ++i) {
+            size_t len = randStr(buf);
+            list[i] = malloc(len + 1);
+            if (!list[i]) break;
+            memcpy(list[i], buf, len + 1);
+            layout->payload += len + 1;
+            layout->heap += mallocCost(list[i], len + 1);
+        }
+    }
+    layout->buildNs = nowNs() - start;
+    layout->footprint = rssGrowth(rss0);
+    if (!list || i < count) {
+        layout->failed = 1;
+        if (list) for (size_t j = 0; j < i; ++j) free(list[j]);
+        free(list);
+        return;
+    }
+
+    // NUL-terminated kernel, as test_with_inline uses the list, then the
+    // length-based dispatched kernel, which needs a strlen per string
+    // because the layout keeps no lengths.
+    for (int t = 0; t < TRIALS; ++t) {
+        start = nowNs();
+        for (i = 0; i < count; ++i) branchlessUpperCase2(list[i]);
+        long long mid = nowNs();
+        for (i = 0; i < count; ++i) upperCase(list[i], strlen(list[i]));
+        long long end = nowNs();
+        if (t == 0 || mid - start < tests[0].cycles) tests[0].cycles = mid - start;
+        if (t == 0 || end - mid < tests[1].cycles) tests[1].cycles = end - mid;
+    }
+
+    uint64_t h = 0;
+    for (i = 0; i < count; ++i) {
+        h = mixHash(h, list[i], strlen(list[i]));
+        free(list[i]);
+    }
+    free(list);
+    layout->hash = h;
+}
+
+// === StrTable ===
+void runTable(size_t count, uint64_t seed, struct Layout *layout, struct TestCase *tests) {
+    char buf[64];
+    struct StrTable table;
+    rngState = seed;
+    size_t rss0 = rssBytes();
+    long long start = nowNs();
+    int ok = strTableInit(&table, count, count * ((MIN_LEN + MAX_LEN) / 2 + 2)) == 0;
+    for (size_t i = 0; ok && i < count; ++i) {
+        size_t len = randStr(buf);
+        ok = strTableAppend(&table, buf, len) == 0;
+    }
+    layout->buildNs = nowNs() - start;
+    layout->footprint = rssGrowth(rss0);
+    if (!ok) {
+        layout->failed = 1;
+        strTableFree(&table);
+        return;
+    }
+    layout->payload = table.offsets[table.count];
+    layout->heap = mallocCost(table.offsets, (table.capacity + 1) * sizeof(uint32_t)) +
+                   mallocCost(table.blob, table.blobCapacity);
+
+    for (int t = 0; t < TRIALS; ++t) {
+        start = nowNs();
+        for (size_t i = 0; i < count; ++i)
+            upperCase(table.blob + table.offsets[i], strTableLen(&table, i));
+        long long mid = nowNs();
+        strTableUpperCase(&table);
+        long long end = nowNs();
+        if (t == 0 || mid - start < tests[0].cycles) tests[0].cycles = mid - start;
+        if (t == 0 || end - mid < tests[1].cycles) tests[1].cycles = end - mid;
+    }
+
+    uint64_t h = 0;
+    for (size_t i = 0; i < count; ++i)
+        h = mixHash(h, strTableAt(&table, i), strTableLen(&table, i));
+    layout->hash = h;
+    strTableFree(&table);
+}
+
+// === Results printing ===
+// Overhead is heap bytes per byte of text (NULs included). RSS growth
+// only means something for the large sizes; small corpora fit in pages
+// the process already had.
+void print_layouts(struct Layout *layouts, int num, size_t count) {
+    printf("%-12s %-12s %-12s %-14s %-12s %-12s\n", "Layout", "Heap (MB)", "RSS (MB)", "Bytes/string", "Overhead", "Build (ms)");
+    printf("----------------------------------------------------------------------------\n");
+    for (int i = 0; i < num; ++i) {
+        if (layouts[i].failed) {
+            printf("%-12s (out of memory)\n", layouts[i].name);
+            continue;
+        }
+        double perString = (double)layouts[i].heap / count;
+        double overhead = (double)layouts[i].heap / (layouts[i].payload ? layouts[i].payload : 1);
+        printf("%-12s %-12.2f %-12.2f %-14.1f x%-11.2f %-12.1f\n",
+               layouts[i].name,
+               layouts[i].heap / 1048576.0,
+               layouts[i].footprint / 1048576.0,
+               perString,
+               overhead,
+               layouts[i].buildNs / 1e6);
+    }
+}
+
+void print_results(struct TestCase *tests, int num, size_t count, size_t payload) {
+    printf("\n%-34s %-15s %-12s %-10s\n", "Function", "Time (nanosec)", "ns/string", "GB/s");
+    printf("------------------------------------------------------------------------------\n");
+
+    long long min = -1;
+    for (int i = 0; i < num; ++i)
+        if (tests[i].cycles > 0 && (min < 0 || tests[i].cycles < min))
+            min = tests[i].cycles;
+
+    for (int i = 0; i < num; ++i) {
+        if (tests[i].cycles <= 0) {
+            printf("%-34s (not run)\n", tests[i].name);
+            continue;
+        }
+        printf("%-34s %-15lld %-12.2f %-10.2f (x%.3f)\n",
+               tests[i].name,
+               tests[i].cycles,
+               (double)tests[i].cycles / count,
+               (double)payload / tests[i].cycles,
+               (double)tests[i].cycles / (min > 0 ? min : 1));
+    }
+}
+
+// === main ===
+// Usage: test_string_table [--max N] [counts...]
+//   counts    corpus sizes in strings (default 1000, 1000000, 100000000)
+//   --max N   skip sizes above N strings (the 100M char ** list needs
+//             about 4 GB)
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    size_t counts[16], maxCount = (size_t)-1;
+    int numCounts = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--max") == 0 && i + 1 < argc)
+            maxCount = (size_t)strtoull(argv[++i], NULL, 10);
+        else if (numCounts < 16)
+            counts[numCounts++] = (size_t)strtoull(argv[i], NULL, 10);
+    }
+    if (numCounts == 0) {
+        counts[numCounts++] = 1000;
+        counts[numCounts++] = 1000000;
+        counts[numCounts++] = 100000000;
+    }
+
+    printf("\nlibbranchless %d, char ** vs packed string table, %d..%d letters per string\n",
+           branchlessVersion(), MIN_LEN, MAX_LEN);
+    int ok = 1;
+    for (int c = 0; c < numCounts; ++c) {
+        size_t count = counts[c];
+        if (count == 0 || count > maxCount) continue;
+        uint64_t seed = 0x9E3779B97F4A7C15ULL ^ (uint64_t)time(NULL) ^ count;
+
+        struct Layout layouts[2] = {{"char **", 0, 0, 0, 0, 0, 0}, {"StrTable", 0, 0, 0, 0, 0, 0}};
+        struct TestCase tests[] = {
+            {"char **, branchlessUpperCase2", 0},
+            {"char **, strlen + upperCase", 0},
+            {"StrTable, upperCase per string", 0},
+            {"StrTable, strTableUpperCase", 0}
+        };
+        // The table first: its two large blocks go back to the system on
+        // free, so the list's RSS growth is not hidden by reused pages.
+        runTable(count, seed, &layouts[1], &tests[2]);
+        runList(count, seed, &layouts[0], &tests[0]);
+
+        printf("\n=== %zu strings ===\n", count);
+        print_layouts(layouts, 2, count);
+        print_results(tests, 4, count, layouts[1].payload);
+        if (!layouts[0].failed && !layouts[1].failed) {
+            int equal = layouts[0].hash == layouts[1].hash;
+            printf("Corpora are equal: %s\n", equal ? "YES" : "NO");
+            ok &= equal;
+        }
+    }
+    printf("\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <array>
+#include <span>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "branchless.hpp"
+#include "tsc.h"
+
+// Fixed-width fields through branchless.hpp: the same kernels with the
+// length baked in at compile time (span<char, N>) against the
+// runtime-length C entry points and the dynamic-extent span.
+
+// === Compile-time checks ===
+static_assert(branchless::toUpper('q') == 'Q');
+static_assert(branchless::toUpper(u'z') == u'Z');
+static_assert(branchless::upperCopy("aZ{`9") == std::array<char, 6>{'A', 'Z', '{', '`', '9', '\0'});
+static_assert(branchless::clamp(5.0, 0.0, 1.0) == 1.0);
+
+constexpr std::array<int, 4> clampedAtCompileTime() {
+    std::array<int, 4> a{-3, 0, 7, 12};
+    branchless::clamp(a, 0, 10);
+    return a;
+}
+static_assert(clampedAtCompileTime() == std::array<int, 4>{0, 0, 7, 10});
+
+// === Random generation ===
+void randStr(char *s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        s[i] = (rand() % 2 == 0)
+            ? ('A' + rand() % 26)
+            : ('a' + rand() % 26);
+    }
+}
+
+double randDouble(void) {
+    return (double)rand() / RAND_MAX * 4.0 - 2.0;
+}
+
+// === Field pool ===
+// COUNT fields of N characters (or doubles) back to back; the master copy
+// is restored before every trial and the best of TRIALS is kept.
+const int TRIALS = 5;
+const size_t POOL_BYTES = 256 * 1024;
+
+// The runtime length goes through a volatile so the compiler cannot turn
+// the "runtime" calls into fixed-N ones.
+static volatile size_t runtimeLen;
+
+template <class T>
+struct Pool {
+    std::vector<T> master, work;
+    size_t width, count;
+};
+
+template <class T>
+Pool<T> makePool(size_t width) {
+    Pool<T> pool;
+    pool.width = width;
+    pool.count = POOL_BYTES / (width * sizeof(T));
+    pool.master.resize(pool.width * pool.count);
+    if constexpr (std::is_same_v<T, char>)
+        randStr(pool.master.data(), pool.master.size());
+    else
+        for (T &x : pool.master) x = randDouble();
+    pool.work = pool.master;
+    return pool;
+}
+
+template <class T, class Body>
+long long timePool(Pool<T> &pool, Body body) {
+    long long best = -1;
+    for (int t = 0; t < TRIALS; ++t) {
+        pool.work = pool.master;
+        long long start = nowNs();
+        for (size_t i = 0; i < pool.count; ++i)
+            body(pool.work.data() + i * pool.width);
+        long long end = nowNs();
+        if (best < 0 || end - start < best)
+            best = end - start;
+    }
+    return best;
+}
+
+// === Utility structures ===
+struct TestCase {
+    const char *name;
+    long long cycles;
+};
+
+// === Uppercase at width N ===
+// Every variant must leave the pool exactly as branchlessUpperCase2N does.
+template <size_t N>
+int runUpper(struct TestCase *tests, size_t *count) {
+    Pool<char> pool = makePool<char>(N);
+    std::vector<char> ref = pool.master;
+    branchlessUpperCase2N(ref.data(), ref.size());
+    int ok = 1;
+    auto check = [&](const char *name) {
+        if (memcmp(pool.work.data(), ref.data(), ref.size()) != 0) {
+            printf("MISMATCH: %s (N = %zu)\n", name, N);
+            ok = 0;
+        }
+    };
+
+    runtimeLen = N;
+    tests[0] = {"span<char, N>", timePool(pool, [](char *f) {
+        branchless::upperCase(std::span<char, N>(f, N));
+    })};
+    check(tests[0].name);
+    tests[1] = {"span<char>", timePool(pool, [](char *f) {
+        branchless::upperCase(std::span<char>(f, runtimeLen));
+    })};
+    check(tests[1].name);
+    tests[2] = {"branchlessUpperCase2N", timePool(pool, [](char *f) {
+        branchlessUpperCase2N(f, runtimeLen);
+    })};
+    check(tests[2].name);
+    tests[3] = {"upperCase (dispatched)", timePool(pool, [](char *f) {
+        upperCase(f, runtimeLen);
+    })};
+    check(tests[3].name);
+    *count = pool.count;
+    return ok;
+}
+
+// === Clamp at width N ===
+template <size_t N>
+int runClamp(struct TestCase *tests, size_t *count) {
+    Pool<double> pool = makePool<double>(N);
+    std::vector<double> ref = pool.master;
+    clampArrayScalar(ref.data(), ref.size(), -1.0, 1.0);
+    int ok = 1;
+    auto check = [&](const char *name) {
+        if (memcmp(pool.work.data(), ref.data(), ref.size() * sizeof(double)) != 0) {
+            printf("MISMATCH: %s (N = %zu)\n", name, N);
+            ok = 0;
+        }
+    };
+
+    runtimeLen = N;
+    tests[0] = {"span<double, N>", timePool(pool, [](double *f) {
+        branchless::clamp(std::span<double, N>(f, N), -1.0, 1.0);
+    })};
+    check(tests[0].name);
+    tests[1] = {"span<double>", timePool(pool, [](double *f) {
+        branchless::clamp(std::span<double>(f, runtimeLen), -1.0, 1.0);
+    })};
+    check(tests[1].name);
+    tests[2] = {"clampArrayScalar", timePool(pool, [](double *f) {
+        clampArrayScalar(f, runtimeLen, -1.0, 1.0);
+    })};
+    check(tests[2].name);
+    tests[3] = {"clampArray (dispatched)", timePool(pool, [](double *f) {
+        clampArray(f, runtimeLen, -1.0, 1.0);
+    })};
+    check(tests[3].name);
+    *count = pool.count;
+    return ok;
+}
+
+// === Results printing ===
+void print_results(const char *title, size_t width, struct TestCase *tests, int num, size_t count) {
+    printf("\n=== %s, N = %zu (%zu fields) ===\n", title, width, count);
+    printf("%-26s %-15s %-15s\n", "Function", "Time (nanosec)", "Time/field");
+    printf("-------------------------------------------------------\n");
+
+    long long min = tests[0].cycles;
+    for (int i = 1; i < num; ++i)
+        if (tests[i].cycles < min) min = tests[i].cycles;
+
+    for (int i = 0; i < num; ++i) {
+        double per_field = (double)tests[i].cycles / count;
+        double rel = (double)tests[i].cycles / (min > 0 ? min : 1);
+        printf("%-26s %-15lld %-10.2f (x%.3f)\n",
+               tests[i].name,
+               tests[i].cycles,
+               per_field,
+               rel);
+    }
+}
+
+template <size_t... Widths>
+int runAll(void) {
+    struct TestCase tests[4];
+    size_t count;
+    int ok = 1;
+    ((ok &= runUpper<Widths>(tests, &count),
+      print_results("UPPERCASE", Widths, tests, 4, count)), ...);
+    ((ok &= runClamp<Widths>(tests, &count),
+      print_results("CLAMP [-1, 1]", Widths, tests, 4, count)), ...);
+    return ok;
+}
+
+// === main ===
+int main(void) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    srand((unsigned)time(NULL));
+
+    printf("\nlibbranchless %d, fixed-N templates vs runtime length\n", branchlessVersion());
+    int ok = runAll<4, 8, 16, 32, 64, 256, 2048>();
+    printf("\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "branchless.h"
+#include "diffcheck.h"
+#include "tsc.h"
+
+const int STR_LEN = 2048;
+
+// === Random UTF-8 string generation ===
+// Writes exactly STR_LEN bytes of valid UTF-8. `density` is the percentage
+// of two-byte characters, drawn with equal odds from four blocks:
+// Latin-1 Supplement (U+00A0..U+00FF), Latin Extended-A (U+0100..U+017F),
+// Greek (U+0370..U+03FF) and Cyrillic (U+0400..U+04FF). The rest are ASCII
+// letters as in randStr. A two-byte character that would not fit at the
+// very end is replaced by a letter.
+void randUtf8Str(char *s, int density) {
+    int i = 0;
+    while (i < STR_LEN) {
+        if (rand() % 100 < density && i + 2 <= STR_LEN) {
+            static const unsigned first[] = {0xA0, 0x100, 0x370, 0x400};
+            static const unsigned size[] = {0x60, 0x80, 0x90, 0x100};
+            int block = rand() % 4;
+            unsigned cp = first[block] + rand() % size[block];
+            s[i++] = (char)(0xC0 | (cp >> 6));
+            s[i++] = (char)(0x80 | (cp & 0x3F));
+        } else {
+            s[i++] = (rand() % 2 == 0)
+                ? ('A' + rand() % 26)
+                : ('a' + rand() % 26);
+        }
+    }
+    s[STR_LEN] = '\0';
+}
+
+// === Utility structures ===
+typedef void (*test_func_t)(char *, size_t);
+struct TestCase {
+    const char *name;
+    test_func_t func;
+    int cpu;  // instruction set the kernel needs
+    long long cycles;
+};
+
+// === Helper functions ===
+char **makeList(int count, int density) {
+    char **list = malloc(count * sizeof(char *));
+    if (!list) return NULL;
+
+    for (int i = 0; i < count; ++i) {
+        list[i] = malloc(STR_LEN + 1);
+        if (!list[i]) {
+            for (int j = 0; j < i; ++j) free(list[j]);
+            free(list);
+            return NULL;
+        }
+        randUtf8Str(list[i], density);
+    }
+    return list;
+}
+
+void freeList(char **list, int count) {
+    for (int i = 0; i < count; ++i)
+        free(list[i]);
+    free(list);
+}
+
+static int supported(const struct TestCase *test) {
+    return cpuSupports(test->cpu);
+}
+
+// Every kernel except the ASCII-only one must produce exactly what the
+// naive decoder does, on every density and on truncated lengths that cut
+// sequences in half. The naive decoder shares its mapping with the other
+// kernels, so the known answers of bench/diffcheck.h come first.
+int verify(struct TestCase *tests, int num) {
+    struct DiffFailure fail;
+    if (diffKnownUtf8(&fail) < 0) {
+        diffPrintFailure(stdout, &fail);
+        return 0;
+    }
+
+    char *orig = malloc(STR_LEN + 1);
+    char *ref = malloc(STR_LEN + 1);
+    char *buf = malloc(STR_LEN + 1);
+    int ok = orig && ref && buf;
+
+    for (int round = 0; ok && round < 300; ++round) {
+        randUtf8Str(orig, round % 101);
+        size_t len = (size_t)(rand() % (STR_LEN + 1));
+        memcpy(ref, orig, STR_LEN + 1);
+        naiveUtf8UpperCase(ref, len);
+        for (int i = 0; i < num; ++i) {
+            if (tests[i].func == obviouseUpperCaseN || !supported(&tests[i])) continue;
+            memcpy(buf, orig, STR_LEN + 1);
+            tests[i].func(buf, len);
+            if (memcmp(buf, ref, STR_LEN + 1) != 0) {
+                printf("MISMATCH: %s (density %d%%, len %zu)\n", tests[i].name, round % 101, len);
+                ok = 0;
+            }
+        }
+    }
+    free(orig); free(ref); free(buf);
+    return ok;
+}
+
+// === Single function measurement ===
+// Every kernel gets a freshly generated corpus from the same seed, so all
+// of them transform identical bytes.
+void test_function(struct TestCase *test, int iterations, int density, unsigned seed) {
+    srand(seed);
+    char **list = makeList(iterations, density);
+    if (!list) return;
+
+    test_func_t func = test->func;
+    long long start = nowNs();
+    for (int i = 0; i < iterations; ++i)
+        func(list[i], STR_LEN);
+    long long end = nowNs();
+    freeList(list, iterations);
+
+    test->cycles = end - start; // in nanoseconds
+}
+
+// === Results printing ===
+void print_results(struct TestCase *tests, int num, int iterations) {
+    printf("%-20s %-15s %-15s\n", "Function", "Time (nanosec)", "Time/call");
+    printf("-----------------------------------------------\n");
+
+    long long min = -1;
+    for (int i = 0; i < num; ++i)
+        if (supported(&tests[i]) && (min < 0 || tests[i].cycles < min))
+            min = tests[i].cycles;
+
+    for (int i = 0; i < num; ++i) {
+        if (!supported(&tests[i])) {
+            printf("%-20s (skipped: no %s)\n", tests[i].name, cpuName(tests[i].cpu));
+            continue;
+        }
+        double per_call = (double)tests[i].cycles / iterations;
+        double rel = (double)tests[i].cycles / (min > 0 ? min : 1);
+        printf("%-20s %-15lld %-10.2f (x%.3f)\n",
+               tests[i].name,
+               tests[i].cycles,
+               per_call,
+               rel);
+    }
+    printf("\n");
+}
+
+// === main ===
+// Usage: test_utf8_upper [density% ...]   (default: 0 1 5 25 50 100)
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    unsigned seed = (unsigned)time(NULL);
+    srand(seed);
+
+    const int ITERATIONS = 1000;
+
+    struct TestCase tests[] = {
+        {"ASCII only (ref)", obviouseUpperCaseN,   CPU_ANY,      0},
+        {"Naive decode",     naiveUtf8UpperCase,  CPU_ANY,      0},
+        {"Table scalar",     tableUtf8UpperCase,  CPU_ANY,      0},
+        {"Table + SWAR",     swarUtf8UpperCase,   CPU_ANY,      0},
+        {"Table + AVX2",     avx2Utf8UpperCase,   CPU_AVX2,     0},
+        {"Table + AVX-512",  avx512Utf8UpperCase, CPU_AVX512BW, 0}
+    };
+    int num_tests = sizeof(tests) / sizeof(tests[0]);
+
+    int defaultDensities[] = {0, 1, 5, 25, 50, 100};
+    int numDensities = argc > 1 ? argc - 1 : (int)(sizeof(defaultDensities) / sizeof(defaultDensities[0]));
+
+    printf("\nVerifying kernels...\n");
+    if (!verify(tests, num_tests)) return 1;
+
+    for (int d = 0; d < numDensities; ++d) {
+        int density = argc > 1 ? atoi(argv[d + 1]) : defaultDensities[d];
+        if (density < 0) density = 0;
+        if (density > 100) density = 100;
+
+        printf("\n=== NON-ASCII DENSITY %d%% (%d iterations) ===\n", density, ITERATIONS);
+        for (int i = 0; i < num_tests; ++i)
+            if (supported(&tests[i]))
+                test_function(&tests[i], ITERATIONS, density, seed + (unsigned)d);
+        print_results(tests, num_tests, ITERATIONS);
+    }
+    return 0;
+}
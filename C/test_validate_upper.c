@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "branchless.h"
+#include "tsc.h"
+
+const int STR_LEN = 2048;
+
+// === Random string generation ===
+void randStr(char* s) {
+    for (int i = 0; i < STR_LEN; i++) {
+        s[i] = (rand() % 2 == 0)
+            ? ('A' + rand() % 26)
+            : ('a' + rand() % 26);
+    }
+    s[STR_LEN] = '\0';
+}
+
+// === Two-pass wrappers (check, then uppercase) ===
+int twoPassScalar(char *str, size_t len) {
+    int flags = asciiCheckScalar(str, len);
+    branchlessUpperCase2N(str, len);
+    return flags;
+}
+
+int twoPassSwar(char *str, size_t len) {
+    int flags = asciiCheckSwar(str, len);
+    swarUpperCase(str, len);
+    return flags;
+}
+
+int twoPassAvx2(char *str, size_t len) {
+    int flags = asciiCheckAvx2(str, len);
+    avx2UpperCase(str, len);
+    return flags;
+}
+
+// === Utility structures ===
+typedef int (*test_func_t)(char *, size_t);
+struct TestCase {
+    const char *name;
+    test_func_t func;
+    int needsAvx2;
+    long long cycles;
+};
+
+static int supported(const struct TestCase *test) {
+    return !test->needsAvx2 || cpuSupports(CPU_AVX2);
+}
+
+// === Helper functions ===
+char **makeList(int count) {
+    char **list = malloc(count * sizeof(char *));
+    if (!list) return NULL;
+
+    for (int i = 0; i < count; ++i) {
+        list[i] = malloc(STR_LEN + 1);
+        if (!list[i]) {
+            for (int j = 0; j < i; ++j) free(list[j]);
+            free(list);
+            return NULL;
+        }
+        randStr(list[i]);
+    }
+    return list;
+}
+
+void freeList(char **list, int count) {
+    for (int i = 0; i < count; ++i)
+        free(list[i]);
+    free(list);
+}
+
+// Every kernel must transform like branchlessUpperCase2N and report the
+// same flags as the scalar check, on clean letters and on fields with a
+// planted high or control byte at every position class.
+int verify(struct TestCase *tests, int num) {
+    char orig[STR_LEN + 1], ref[STR_LEN + 1], buf[STR_LEN + 1];
+    for (int round = 0; round < 1000; ++round) {
+        size_t len = (size_t)(rand() % (STR_LEN + 1));
+        randStr(orig);
+        if (round % 4 && len) {
+            static const unsigned char planted[] = {0x00, 0x09, 0x1F, 0x7F, 0x80, 0xC3, 0xFF, 0x20, 0x7E};
+            orig[rand() % len] = (char)planted[rand() % sizeof(planted)];
+        }
+        memcpy(ref, orig, sizeof(orig));
+        int refFlags = asciiCheckScalar(ref, len);
+        branchlessUpperCase2N(ref, len);
+
+        for (int i = 0; i < num; ++i) {
+            if (!supported(&tests[i])) continue;
+            memcpy(buf, orig, sizeof(orig));
+            int flags = tests[i].func(buf, len);
+            if (flags != refFlags || memcmp(buf, ref, sizeof(ref)) != 0) {
+                printf("MISMATCH: %s (len %zu, flags %d vs %d)\n", tests[i].name, len, flags, refFlags);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// === Single function measurement ===
+void test_function(struct TestCase *test, int iterations) {
+    char **list = makeList(iterations);
+    if (!list) return;
+
+    test_func_t func = test->func;
+    int flags = 0;
+    long long start = nowNs();
+    for (int i = 0; i < iterations; ++i)
+        flags |= func(list[i], STR_LEN);
+    long long end = nowNs();
+    freeList(list, iterations);
+
+    test->cycles = end - start; // in nanoseconds
+    if (flags) printf("%s: corpus flagged %d\n", test->name, flags);
+}
+
+// === Results printing ===
+void print_results(struct TestCase *tests, int num, int iterations) {
+    printf("\n=== TEST RESULTS ===\n");
+    printf("%-22s %-15s %-15s\n", "Function", "Time (nanosec)", "Time/call");
+    printf("-------------------------------------------------\n");
+
+    long long min = -1;
+    for (int i = 0; i < num; ++i)
+        if (supported(&tests[i]) && (min < 0 || tests[i].cycles < min))
+            min = tests[i].cycles;
+
+    for (int i = 0; i < num; ++i) {
+        if (!supported(&tests[i])) {
+            printf("%-22s (skipped: no avx2)\n", tests[i].name);
+            continue;
+        }
+        double per_call = (double)tests[i].cycles / iterations;
+        double rel = (double)tests[i].cycles / (min > 0 ? min : 1);
+        printf("%-22s %-15lld %-10.2f (x%.3f)\n",
+               tests[i].name,
+               tests[i].cycles,
+               per_call,
+               rel);
+    }
+    printf("\n");
+}
+
+// === main ===
+int main(void) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    srand((unsigned)time(NULL));
+
+    const int ITERATIONS = 1000;
+
+    struct TestCase tests[] = {
+        {"Two-pass scalar", twoPassScalar,       0, 0},
+        {"Fused scalar",    upperValidateScalar, 0, 0},
+        {"Two-pass SWAR",   twoPassSwar,         0, 0},
+        {"Fused SWAR",      upperValidateSwar,   0, 0},
+        {"Two-pass AVX2",   twoPassAvx2,         1, 0},
+        {"Fused AVX2",      upperValidateAvx2,   1, 0}
+    };
+    int num_tests = sizeof(tests) / sizeof(tests[0]);
+
+    printf("\nVerifying kernels...\n");
+    if (!verify(tests, num_tests)) return 1;
+
+    printf("Running tests (%d iterations)...\n", ITERATIONS);
+    for (int i = 0; i < num_tests; ++i)
+        if (supported(&tests[i]))
+            test_function(&tests[i], ITERATIONS);
+
+    print_results(tests, num_tests, ITERATIONS);
+    return 0;
+}
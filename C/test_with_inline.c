@@ -2,7 +2,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+
+#ifdef _WIN32
 #include <windows.h>
+#endif
+
+#include "branchless_inline.h"
+#include "diffcheck.h"
+#include "env.h"
+#include "tsc.h"
 
 const int STR_LEN = 2048;
 
@@ -16,23 +24,9 @@ void randStr(char* s) {
     s[STR_LEN] = '\0';
 }
 
-// === Tested functions (marked as inline) ===
-static inline void obviouseUpperCase(char *str) {
-    for (size_t i = 0; str[i] != '\0'; ++i)
-        if (str[i] >= 'a' && str[i] <= 'z')
-            str[i] -= 32;
-}
-
-static inline void branchlessUpperCase1(char *str) {
-    for (size_t i = 0; str[i] != '\0'; ++i)
-        str[i] = (str[i] * !(str[i] >= 'a' && str[i] <= 'z')) +
-                 (str[i] - 32) * (str[i] >= 'a' && str[i] <= 'z');
-}
-
-static inline void branchlessUpperCase2(char *str) {
-    for (size_t i = 0; str[i] != '\0'; ++i)
-        str[i] -= 32 * (str[i] >= 'a' && str[i] <= 'z');
-}
+// === Tested functions ===
+// The library's own kernel bodies from branchless_inline.h, called directly
+// so the compiler can inline them into the timed loops.
 
 // === Utility structures ===
 typedef void (*test_func_t)(char *);
@@ -71,9 +65,9 @@ void warmUp(const char *orig) {
 
     for (int i = 0; i < 1000; ++i) {
         memcpy(buf, orig, len + 1);
-        obviouseUpperCase(buf);
-        branchlessUpperCase1(buf);
-        branchlessUpperCase2(buf);
+        obviouseUpperCaseInline(buf);
+        branchlessUpperCase1Inline(buf);
+        branchlessUpperCase2Inline(buf);
     }
     free(buf);
 }
@@ -83,57 +77,48 @@ void test_obviouse(struct TestCase *test, int iterations) {
     char **list = makeList(iterations);
     if (!list) return;
 
-    LARGE_INTEGER start, end, freq;
-    QueryPerformanceFrequency(&freq);
-    QueryPerformanceCounter(&start);
+    long long start = nowNs();
 
     // Direct call - compiler can inline
     for (int i = 0; i < iterations; ++i)
-        obviouseUpperCase(list[i]);
+        obviouseUpperCaseInline(list[i]);
 
-    QueryPerformanceCounter(&end);
+    long long end = nowNs();
     freeList(list, iterations);
 
-    test->cycles = end.QuadPart - start.QuadPart;
-    test->cycles = (test->cycles * 1000000000LL) / freq.QuadPart;
+    test->cycles = end - start;
 }
 
 void test_branchless1(struct TestCase *test, int iterations) {
     char **list = makeList(iterations);
     if (!list) return;
 
-    LARGE_INTEGER start, end, freq;
-    QueryPerformanceFrequency(&freq);
-    QueryPerformanceCounter(&start);
+    long long start = nowNs();
 
     // Direct call - compiler can inline
     for (int i = 0; i < iterations; ++i)
-        branchlessUpperCase1(list[i]);
+        branchlessUpperCase1Inline(list[i]);
 
-    QueryPerformanceCounter(&end);
+    long long end = nowNs();
     freeList(list, iterations);
 
-    test->cycles = end.QuadPart - start.QuadPart;
-    test->cycles = (test->cycles * 1000000000LL) / freq.QuadPart;
+    test->cycles = end - start;
 }
 
 void test_branchless2(struct TestCase *test, int iterations) {
     char **list = makeList(iterations);
     if (!list) return;
 
-    LARGE_INTEGER start, end, freq;
-    QueryPerformanceFrequency(&freq);
-    QueryPerformanceCounter(&start);
+    long long start = nowNs();
 
     // Direct call - compiler can inline
     for (int i = 0; i < iterations; ++i)
-        branchlessUpperCase2(list[i]);
+        branchlessUpperCase2Inline(list[i]);
 
-    QueryPerformanceCounter(&end);
+    long long end = nowNs();
     freeList(list, iterations);
 
-    test->cycles = end.QuadPart - start.QuadPart;
-    test->cycles = (test->cycles * 1000000000LL) / freq.QuadPart;
+    test->cycles = end - start;
 }
 
 // === Results printing ===
@@ -161,9 +146,26 @@ void print_results(struct TestCase *tests, int num, int iterations) {
 
 // === main ===
 int main(void) {
+#ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
+#endif
     srand((unsigned)time(NULL));
 
+    struct BenchEnv env;
+    envStabilize(&env, -1);
+    envPrintHeader(stdout, &env);
+
+    // Same pre-timing check as test_without_inline: nothing is timed if a
+    // kernel disagrees with obviouseUpperCase.
+    struct DiffFailure fail;
+    printf("\nVerifying kernels against obviouseUpperCase...\n");
+    long checked = diffVerify((uint64_t)time(NULL), &fail);
+    if (checked < 0) {
+        diffPrintFailure(stdout, &fail);
+        return 1;
+    }
+    printf("%ld inputs, all kernels agree\n", checked);
+
     const int ITERATIONS = 1000;
 
     const char *orig = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
@@ -2,7 +2,20 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+
+#ifdef _WIN32
 #include <windows.h>
+#endif
+
+#include "branchless.h"
+#include "corpus.h"
+#include "diffcheck.h"
+#include "env.h"
+#include "histogram.h"
+#include "isolate.h"
+#include "pool.h"
+#include "roofline.h"
+#include "tsc.h"
 
 const int STR_LEN = 2048;
 
@@ -17,22 +30,8 @@ void randStr(char* s) {
 }
 
 // === Tested functions ===
-void obviouseUpperCase(char *str) {
-    for (size_t i = 0; str[i] != '\0'; ++i)
-        if (str[i] >= 'a' && str[i] <= 'z')
-            str[i] -= 32;
-}
-
-void branchlessUpperCase1(char *str) {
-    for (size_t i = 0; str[i] != '\0'; ++i)
-        str[i] = (str[i] * !(str[i] >= 'a' && str[i] <= 'z')) +
-                 (str[i] - 32) * (str[i] >= 'a' && str[i] <= 'z');
-}
-
-void branchlessUpperCase2(char *str) {
-    for (size_t i = 0; str[i] != '\0'; ++i)
-        str[i] -= 32 * (str[i] >= 'a' && str[i] <= 'z');
-}
+// obviouseUpperCase, branchlessUpperCase1 and branchlessUpperCase2 come
+// from libbranchless and are called through pointers.
 
 // === Utility structures ===
 typedef void (*test_func_t)(char *);
@@ -42,15 +41,66 @@ struct TestCase {
     long long cycles;
 };
 
+// === Corpus file ===
+// With --corpus PATH the strings come from a mapped corpus file instead
+// of randStr: generated once (same shape: STR_LEN mixed-case letters,
+// malloc's 16-byte alignment), then mapped copy-on-write by every list,
+// so building a list costs the same at any size. Its content is fixed
+// by CORPUS_SEED rather than by time(NULL).
+#define CORPUS_SEED 0x5EEDC0DEULL
+
+static const char *corpusPath = NULL;
+static struct Corpus corpus;
+static char **corpusList = NULL;
+
+static struct CorpusParams corpusParams(int count) {
+    struct CorpusParams params = {CORPUS_SEED, CORPUS_MIXED_CASE, (uint32_t)STR_LEN,
+                                  (uint32_t)STR_LEN, 16, (uint64_t)count};
+    return params;
+}
+
+static char **mapList(int count) {
+    struct CorpusParams params = corpusParams(count);
+    if (corpusOpenOrCreate(&corpus, corpusPath, &params, NULL) != 0) {
+        perror(corpusPath);
+        return NULL;
+    }
+    char **list = malloc(count * sizeof(char *));
+    if (!list) {
+        corpusClose(&corpus);
+        return NULL;
+    }
+    for (int i = 0; i < count; ++i)
+        list[i] = corpusString(&corpus, (size_t)i);
+    corpusList = list;
+    return list;
+}
+
+// === String buffers ===
+// Every list, its master copy and every repetition's list need count
+// STR_LEN + 1 buffers. With --pool they come from a BufPool that keeps
+// them between lists instead of going back and forth through malloc.
+static struct BufPool *strPool = NULL;
+
+static char *allocStr(void) {
+    return strPool ? poolAlloc(strPool) : malloc(STR_LEN + 1);
+}
+
+static void freeStr(char *s) {
+    if (strPool) poolFree(strPool, s);
+    else free(s);
+}
+
 // === Helper functions ===
 char **makeList(int count) {
+    if (corpusPath) return mapList(count);
     char **list = malloc(count * sizeof(char *));
     if (!list) return NULL;
 
     for (int i = 0; i < count; ++i) {
-        list[i] = malloc(STR_LEN + 1);
+        list[i] = allocStr();
         if (!list[i]) {
-            for (int j = 0; j < i; ++j) free(list[j]);
+            for (int j = 0; j < i; ++j) freeStr(list[j]);
             free(list);
             return NULL;
         }
@@ -60,8 +110,14 @@ char **makeList(int count) {
 }
 
 void freeList(char **list, int count) {
+    if (list == corpusList) {
+        corpusClose(&corpus);   // private pages and all
+        corpusList = NULL;
+        free(list);
+        return;
+    }
     for (int i = 0; i < count; ++i)
-        free(list[i]);
+        freeStr(list[i]);
     free(list);
 }
 
@@ -79,24 +135,252 @@ void warmUp(const char *orig) {
     free(buf);
 }
 
-// === Single function measurement ===
-void test_function(struct TestCase *test, int iterations) {
+// === Working-set warm-up ===
+// warmUp above only trains the instruction cache on a 52-byte string. The
+// corpus the timed loop reads is iterations * STR_LEN bytes (2 MB by
+// default), so without this phase its first pass pays for TLB misses,
+// cache misses and an untrained predictor inside the timed region.
+//
+// With warmPasses > 0 the corpus is first timed once as generated (the
+// cold start), then every page and cache line is touched, then the kernel
+// runs over it, restored from a pristine copy each time, until three
+// consecutive passes agree within warmTolerance or warmPasses run out.
+// The timed measurement that follows starts from that steady state.
+static int warmPasses = 0;
+static double warmTolerance = 0.02;
+
+struct WarmStats {
+    long long coldNs;     // first pass over the freshly generated corpus
+    long long steadyNs;   // best of the last three warm-up passes
+    int passes;
+    int converged;
+};
+
+char **copyList(char **list, int count) {
+    char **copy = malloc(count * sizeof(char *));
+    if (!copy) return NULL;
+    for (int i = 0; i < count; ++i) {
+        copy[i] = allocStr();
+        if (!copy[i]) {
+            freeList(copy, i);
+            return NULL;
+        }
+        memcpy(copy[i], list[i], STR_LEN + 1);
+    }
+    return copy;
+}
+
+void restoreList(char **list, char **master, int count) {
+    for (int i = 0; i < count; ++i)
+        memcpy(list[i], master[i], STR_LEN + 1);
+}
+
+// Touches one byte per cache line to make the pages resident in the TLB
+// and caches. randStr already wrote its buffers, so reading is enough.
+// --corpus strings are copy-on-write file pages: until a page is written
+// the kernel's first store to it still takes a fault and a page copy, so
+// there every touched byte is written back instead.
+void touchList(char **list, int count) {
+    if (list == corpusList) {
+        for (int i = 0; i < count; ++i)
+            for (int off = 0; off <= STR_LEN; off += 64) {
+                volatile char *p = list[i] + off;
+                *p = *p;
+            }
+        return;
+    }
+    volatile char sink = 0;
+    for (int i = 0; i < count; ++i)
+        for (int off = 0; off <= STR_LEN; off += 64)
+            sink ^= list[i][off];
+    (void)sink;
+}
+
+static long long timePass(test_func_t func, char **list, int count) {
+    long long start = nowNs();
+    for (int i = 0; i < count; ++i)
+        func(list[i]);
+    return nowNs() - start;
+}
+
+// Builds the corpus and, if enabled, warms it up. Returns it restored to
+// freshly generated content, ready for the timed run.
+char **prepareList(struct TestCase *test, int iterations, struct WarmStats *stats) {
     char **list = makeList(iterations);
+    if (!list || warmPasses <= 0) return list;
+    char **master = copyList(list, iterations);
+    if (!master) return list;
+
+    stats->coldNs = timePass(test->func, list, iterations);
+    touchList(list, iterations);
+
+    long long last[3] = {0, 0, 0};
+    stats->converged = 0;
+    for (stats->passes = 1; stats->passes <= warmPasses; ++stats->passes) {
+        restoreList(list, master, iterations);
+        last[stats->passes % 3] = timePass(test->func, list, iterations);
+        if (stats->passes < 3) continue;
+        long long lo = last[0], hi = last[0];
+        for (int k = 1; k < 3; ++k) {
+            if (last[k] < lo) lo = last[k];
+            if (last[k] > hi) hi = last[k];
+        }
+        stats->steadyNs = lo;
+        if (hi - lo <= (long long)(warmTolerance * lo)) {
+            stats->converged = 1;
+            break;
+        }
+    }
+    if (stats->passes > warmPasses) stats->passes = warmPasses;
+
+    restoreList(list, master, iterations);
+    freeList(master, iterations);
+    return list;
+}
+
+// === Single function measurement ===
+void test_function(struct TestCase *test, int iterations, struct WarmStats *warm) {
+    char **list = prepareList(test, iterations, warm);
     if (!list) return;
     test_func_t func = test->func;
 
-    LARGE_INTEGER start, end, freq;
-    QueryPerformanceFrequency(&freq);
-    QueryPerformanceCounter(&start);
+    long long start = nowNs();
 
     for (int i = 0; i < iterations; ++i)
         func(list[i]);
 
-    QueryPerformanceCounter(&end);
+    long long end = nowNs();
     freeList(list, iterations);
 
-    test->cycles = end.QuadPart - start.QuadPart;
-    test->cycles = (test->cycles * 1000000000LL) / freq.QuadPart; // in nanoseconds
+    test->cycles = end - start; // in nanoseconds
+}
+
+// === Per-call measurement ===
+// Times every call on its own with serialized rdtsc/rdtscp and subtracts
+// the cost of an empty measurement, so a slow call (first touch of a
+// page, an interrupt, a migration) lands in the tail of the histogram
+// instead of disappearing into the batch average.
+void test_function_per_call(struct TestCase *test, struct Histogram *hist, int iterations,
+                            struct WarmStats *warm) {
+    char **list = prepareList(test, iterations, warm);
+    if (!list) return;
+    test_func_t func = test->func;
+    uint64_t overhead = tscOverhead();
+
+    histInit(hist);
+    for (int i = 0; i < iterations; ++i) {
+        uint64_t t0 = tscBegin();
+        func(list[i]);
+        uint64_t t1 = tscEnd();
+        uint64_t ticks = t1 - t0;
+        histRecord(hist, ticks > overhead ? ticks - overhead : 0);
+    }
+    freeList(list, iterations);
+
+    test->cycles = (long long)(hist->sum / tscTicksPerNs()); // in nanoseconds
+}
+
+// === Isolated measurement ===
+// One forked child per (repetition, kernel). Every child seeds rand()
+// the same way, so it builds the same corpus, runs the same warm-up and
+// starts from the parent's pristine heap; nothing it faults in or warms
+// up survives into the next kernel's run.
+struct IsolatedRun {
+    struct TestCase *test;
+    const char *orig;
+    unsigned seed;
+    int iterations;
+    int perCall;
+};
+
+struct IsolatedResult {
+    long long cycles;
+    struct WarmStats warm;
+    struct Histogram hist;
+    struct PoolStats pool;   // the child's copy of strPool, if any
+};
+
+static void runIsolatedKernel(void *ctx, void *out) {
+    struct IsolatedRun *run = ctx;
+    struct IsolatedResult *result = out;
+    srand(run->seed);
+    warmUp(run->orig);
+    if (run->perCall)
+        test_function_per_call(run->test, &result->hist, run->iterations, &result->warm);
+    else
+        test_function(run->test, run->iterations, &result->warm);
+    result->cycles = run->test->cycles;
+    if (strPool) {
+        poolFlush(strPool);
+        poolStats(strPool, &result->pool);
+    }
+}
+
+// Runs `reps` rounds, each in a fresh random kernel order. Keeps the best
+// batch time per kernel in tests[i].cycles, the spread in maxNs/sumNs,
+// merges the per-call histograms of all rounds and keeps the warm-up
+// stats of the last one. With --pool, *poolTotal adds up what every
+// child did with its copy of the pool (counters past the parent's state
+// at fork; bytes held is the largest child's).
+int run_isolated(struct TestCase *tests, struct Histogram *hists, struct WarmStats *warm, int num,
+                 const char *orig, int iterations, int perCall, int reps,
+                 long long *maxNs, long long *sumNs, struct PoolStats *poolTotal) {
+    unsigned seed = (unsigned)rand();
+    int order[16];
+    static struct IsolatedResult result;
+    struct PoolStats base;
+    if (strPool) {
+        poolFlush(strPool);
+        poolStats(strPool, &base);
+        memset(poolTotal, 0, sizeof(*poolTotal));
+        poolTotal->bufSize = base.bufSize;
+    }
+
+    for (int i = 0; i < num; ++i) {
+        tests[i].cycles = -1;
+        maxNs[i] = sumNs[i] = 0;
+        histInit(&hists[i]);
+    }
+    for (int r = 0; r < reps; ++r) {
+        shuffleOrder(order, num);
+        for (int k = 0; k < num; ++k) {
+            int i = order[k];
+            struct IsolatedRun run = {&tests[i], orig, seed, iterations, perCall};
+            if (!runIsolated(runIsolatedKernel, &run, &result, sizeof(result))) {
+                printf("isolated run of %s failed\n", tests[i].name);
+                return 0;
+            }
+            if (tests[i].cycles < 0 || result.cycles < tests[i].cycles) tests[i].cycles = result.cycles;
+            if (result.cycles > maxNs[i]) maxNs[i] = result.cycles;
+            sumNs[i] += result.cycles;
+            if (perCall) histMerge(&hists[i], &result.hist);
+            warm[i] = result.warm;
+            if (strPool) {
+                poolTotal->allocs += result.pool.allocs - base.allocs;
+                poolTotal->cacheHits += result.pool.cacheHits - base.cacheHits;
+                poolTotal->sharedHits += result.pool.sharedHits - base.sharedHits;
+                poolTotal->misses += result.pool.misses - base.misses;
+                poolTotal->slabs += result.pool.slabs - base.slabs;
+                if (result.pool.bytesHeld > poolTotal->bytesHeld) poolTotal->bytesHeld = result.pool.bytesHeld;
+            }
+        }
+    }
+    return 1;
+}
+
+void print_spread(struct TestCase *tests, long long *maxNs, long long *sumNs, int num, int reps) {
+    printf("=== SPREAD OVER %d ISOLATED RUNS (randomized order, ns) ===\n", reps);
+    printf("%-20s %-15s %-15s %-15s %-10s\n", "Function", "Best", "Mean", "Worst", "Spread");
+    printf("-----------------------------------------------------------------------\n");
+    for (int i = 0; i < num; ++i) {
+        printf("%-20s %-15lld %-15.0f %-15lld %.1f%%\n",
+               tests[i].name,
+               tests[i].cycles,
+               (double)sumNs[i] / reps,
+               maxNs[i],
+               100.0 * (double)(maxNs[i] - tests[i].cycles) / (double)tests[i].cycles);
+    }
+    printf("\n");
 }
 
 // === Results printing ===
@@ -122,12 +406,168 @@ void print_results(struct TestCase *tests, int num, int iterations) {
     printf("\n");
 }
 
+void print_warmup(struct TestCase *tests, struct WarmStats *warm, int num, int iterations) {
+    printf("=== WARM-UP (ns per call, converge within %.1f%%) ===\n", warmTolerance * 100.0);
+    printf("%-20s %-12s %-12s %-12s %-10s\n", "Function", "Cold start", "Steady", "Cold cost", "Passes");
+    printf("-----------------------------------------------------------------------\n");
+    for (int i = 0; i < num; ++i) {
+        double cold = (double)warm[i].coldNs / iterations;
+        double steady = (double)warm[i].steadyNs / iterations;
+        printf("%-20s %-12.2f %-12.2f %-12.2f %d%s\n",
+               tests[i].name, cold, steady, cold - steady,
+               warm[i].passes, warm[i].converged ? "" : " (not converged)");
+    }
+    printf("\n");
+}
+
+// Every kernel reads and writes each byte once, so its traffic is
+// compared with the read-modify-write probe at the level its corpus fits
+// in; B/cycle counts string bytes against the peak-ops probe, one op
+// per byte being the least any kernel can do.
+void print_roofline(struct TestCase *tests, int num, int iterations, const struct Roofline *roof) {
+    size_t corpus = (size_t)iterations * (STR_LEN + 1);
+    int fits = rooflineLevel(roof, corpus);
+    // A probe whose buffer could not be allocated reads 0 GB/s; compare
+    // against the next level out that was measured, or report n/a.
+    int level = fits;
+    while (level < ROOF_LEVELS && !(roof->rmwGBs[level] > 0.0)) ++level;
+    rooflinePrint(stdout, roof);
+    printf("=== KERNELS AGAINST THE ROOFLINE (%zu-byte corpus, %s", corpus, rooflineLevelName(fits));
+    if (level == ROOF_LEVELS) printf(", not measured");
+    else if (level != fits) printf(", not measured: against %s", rooflineLevelName(level));
+    printf(") ===\n");
+    printf("%-20s %-10s %-10s %-12s %-12s %-10s\n", "Function", "GB/s", "B/cycle", "% of RMW BW", "% of peak", "Bound");
+    printf("-----------------------------------------------------------------------\n");
+    for (int i = 0; i < num; ++i) {
+        double bytes = (double)iterations * STR_LEN;
+        double gbs = 2.0 * bytes / (double)tests[i].cycles;
+        double perCycle = bytes / ((double)tests[i].cycles * roof->ticksPerNs);
+        char bw[16] = "n/a", ops[16] = "n/a";
+        double bwPct = -1.0;
+        if (level < ROOF_LEVELS) {
+            bwPct = 100.0 * gbs / roof->rmwGBs[level];
+            snprintf(bw, sizeof(bw), "%.1f", bwPct);
+        }
+        if (roof->peakBytesPerCycle > 0.0)
+            snprintf(ops, sizeof(ops), "%.1f", 100.0 * perCycle / roof->peakBytesPerCycle);
+        printf("%-20s %-10.2f %-10.3f %-12s %-12s %s\n",
+               tests[i].name, gbs, perCycle, bw, ops,
+               bwPct < 0.0 ? "n/a" : bwPct >= 70.0 ? "memory" : "compute");
+    }
+    printf("\n");
+}
+
+void print_latency(struct TestCase *tests, struct Histogram *hists, int num) {
+    double perNs = tscTicksPerNs();
+    printf("=== PER-CALL LATENCY (ns, rdtscp overhead %llu ticks removed) ===\n",
+           (unsigned long long)tscOverhead());
+    printf("%-20s %-10s %-10s %-10s %-10s %-10s\n", "Function", "Mean", "p50", "p99", "p99.9", "Max");
+    printf("-----------------------------------------------------------------------\n");
+    for (int i = 0; i < num; ++i) {
+        const struct Histogram *h = &hists[i];
+        printf("%-20s %-10.1f %-10.1f %-10.1f %-10.1f %-10.1f\n",
+               tests[i].name,
+               histMean(h) / perNs,
+               histPercentile(h, 50.0) / perNs,
+               histPercentile(h, 99.0) / perNs,
+               histPercentile(h, 99.9) / perNs,
+               h->max / perNs);
+    }
+    printf("\n");
+}
+
+void print_pool_stats(const struct PoolStats *st, const char *scope) {
+    double allocs = st->allocs ? (double)st->allocs : 1.0;
+    printf("=== STRING POOL (%zu-byte buffers%s) ===\n", st->bufSize, scope);
+    printf("Allocations: %llu, hit rate %.1f%% (thread cache %.1f%%, shared stack %.1f%%)\n",
+           (unsigned long long)st->allocs,
+           100.0 * (double)(st->cacheHits + st->sharedHits) / allocs,
+           100.0 * (double)st->cacheHits / allocs,
+           100.0 * (double)st->sharedHits / allocs);
+    printf("Slabs: %llu, %.1f KB held\n\n", (unsigned long long)st->slabs, st->bytesHeld / 1024.0);
+}
+
+void print_pool(struct BufPool *pool) {
+    struct PoolStats st;
+    poolFlush(pool);
+    poolStats(pool, &st);
+    print_pool_stats(&st, "");
+}
+
 // === main ===
-int main(void) {
+// Usage: test_without_inline [--per-call] [--cpu N] [--isolate R]
+//                            [--warmup P [--converge PCT]] [--roofline]
+//                            [--corpus PATH] [--pool] [--no-verify]
+//                            [iterations]
+// --per-call times each string separately and adds a latency percentile
+// table; the default times the whole batch at once. --cpu picks the CPU
+// to pin to (default: the one main starts on). --isolate runs every
+// kernel R times, each time in its own forked child and in a new random
+// order, and reports the best run plus the spread. --warmup P runs up to
+// P passes over the real corpus before timing (until they agree within
+// --converge PCT percent, default 2) and reports cold vs steady cost.
+// --roofline measures memory bandwidth and peak ops first and reports
+// each kernel as a fraction of them. --corpus PATH maps the corpus from
+// PATH, generating it there first if it is missing or of another shape.
+// --pool allocates the strings from a BufPool instead of malloc and
+// reports its hit rate and the memory it holds. Every kernel is first
+// checked against obviouseUpperCase (bench/diffcheck.h) and nothing is
+// timed if one disagrees; --no-verify skips that pass.
+int main(int argc, char **argv) {
+#ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
+#endif
+    int ITERATIONS = 1000;
+    int perCall = 0, pinCpu = -1, isolate = 0, roofline = 0, verify = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--per-call") == 0) perCall = 1;
+        else if (strcmp(argv[i], "--roofline") == 0) roofline = 1;
+        else if (strcmp(argv[i], "--no-verify") == 0) verify = 0;
+        else if (strcmp(argv[i], "--isolate") == 0 && i + 1 < argc) isolate = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) warmPasses = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--converge") == 0 && i + 1 < argc) warmTolerance = atof(argv[++i]) / 100.0;
+        else if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) pinCpu = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) corpusPath = argv[++i];
+        else if (strcmp(argv[i], "--pool") == 0 && !strPool) strPool = poolCreate(STR_LEN + 1, 0);
+        else if (atoi(argv[i]) > 0) ITERATIONS = atoi(argv[i]);
+    }
+    if (warmPasses > 0 && warmPasses < 3) warmPasses = 3;   // convergence needs three passes
     srand((unsigned)time(NULL));
 
-    const int ITERATIONS = 1000;
+    struct BenchEnv env;
+    envStabilize(&env, pinCpu);
+    envPrintHeader(stdout, &env);
+
+    if (verify) {
+        struct DiffFailure fail;
+        printf("\nVerifying kernels against obviouseUpperCase...\n");
+        long checked = diffVerify((uint64_t)time(NULL), &fail);
+        if (checked < 0) {
+            diffPrintFailure(stdout, &fail);
+            return 1;
+        }
+        printf("%ld inputs, all kernels agree\n", checked);
+    }
+
+    // Generate (if needed) before any child forks, then report what a
+    // list costs to set up from the file.
+    if (corpusPath) {
+        struct CorpusParams params = corpusParams(ITERATIONS);
+        int generated;
+        long long start = nowNs();
+        if (corpusOpenOrCreate(&corpus, corpusPath, &params, &generated) != 0) {
+            perror(corpusPath);
+            return 1;
+        }
+        long long mid = nowNs();
+        corpusClose(&corpus);
+        char **list = makeList(ITERATIONS);
+        long long end = nowNs();
+        if (!list) return 1;
+        freeList(list, ITERATIONS);
+        if (generated) printf("Corpus: generated %s in %.1f ms\n", corpusPath, (mid - start) / 1e6);
+        printf("Corpus: %d strings mapped from %s in %.1f us\n", ITERATIONS, corpusPath, (end - mid) / 1e3);
+    }
 
     const char *orig = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
     struct TestCase tests[] = {
@@ -136,14 +576,54 @@ int main(void) {
         {"Branchless 2", branchlessUpperCase2, 0}
     };
     int num_tests = sizeof(tests) / sizeof(tests[0]);
+    static struct Histogram hists[sizeof(tests) / sizeof(tests[0])];
+    struct Roofline roof;
+    if (roofline) {
+        printf("\nMeasuring roofline...\n");
+        rooflineMeasure(&roof);
+    }
+    struct WarmStats warm[sizeof(tests) / sizeof(tests[0])];
+    memset(warm, 0, sizeof(warm));
+
+    if (isolate > 0) {
+        long long maxNs[sizeof(tests) / sizeof(tests[0])], sumNs[sizeof(tests) / sizeof(tests[0])];
+        printf("\nRunning tests isolated (%d rounds x %d iterations)...\n", isolate, ITERATIONS);
+        struct PoolStats poolTotal;
+        if (!run_isolated(tests, hists, warm, num_tests, orig, ITERATIONS, perCall, isolate, maxNs, sumNs,
+                          &poolTotal))
+            return 1;
+        print_results(tests, num_tests, ITERATIONS);
+        print_spread(tests, maxNs, sumNs, num_tests, isolate);
+        if (warmPasses > 0)
+            print_warmup(tests, warm, num_tests, ITERATIONS);
+        if (roofline)
+            print_roofline(tests, num_tests, ITERATIONS, &roof);
+        if (perCall)
+            print_latency(tests, hists, num_tests);
+        if (strPool)
+            print_pool_stats(&poolTotal, ", all isolated runs; KB held: largest child");
+        return 0;
+    }
 
     printf("\nCache warming up...\n");
     warmUp(orig);
 
     printf("Running tests (%d iterations)...\n", ITERATIONS);
-    for (int i = 0; i < num_tests; ++i)
-        test_function(&tests[i], ITERATIONS);
+    for (int i = 0; i < num_tests; ++i) {
+        if (perCall)
+            test_function_per_call(&tests[i], &hists[i], ITERATIONS, &warm[i]);
+        else
+            test_function(&tests[i], ITERATIONS, &warm[i]);
+    }
 
     print_results(tests, num_tests, ITERATIONS);
+    if (warmPasses > 0)
+        print_warmup(tests, warm, num_tests, ITERATIONS);
+    if (roofline)
+        print_roofline(tests, num_tests, ITERATIONS, &roof);
+    if (perCall)
+        print_latency(tests, hists, num_tests);
+    if (strPool)
+        print_pool(strPool);
     return 0;
 }
\ No newline at end of file